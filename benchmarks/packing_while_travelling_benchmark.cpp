@@ -0,0 +1,276 @@
+#include "travellingthiefsolver/packing_while_travelling/algorithms/efficient_local_search.hpp"
+#include "travellingthiefsolver/packing_while_travelling/algorithms/sequential_value_correction.hpp"
+#include "travellingthiefsolver/packing_while_travelling/algorithms/dynamic_programming.hpp"
+#include "travellingthiefsolver/packing_while_travelling/generator.hpp"
+#include "travellingthiefsolver/packing_while_travelling/instance_builder.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <numeric>
+
+using namespace travellingthiefsolver::packing_while_travelling;
+using namespace travellingthiefsolver::packing_while_travelling::efficient_local_search_internal;
+
+namespace
+{
+
+/** Parameters of the generated instance of a given size. */
+GeneratorParameters generator_parameters(CityId number_of_cities)
+{
+    GeneratorParameters parameters;
+    parameters.number_of_cities = number_of_cities;
+    parameters.number_of_items_per_city = 5;
+    parameters.capacity_category = 5;
+    return parameters;
+}
+
+/**
+ * Instance and solution shared by the benchmarks of a given size.
+ */
+struct PwtBenchmarkData
+{
+    PwtBenchmarkData(CityId number_of_cities):
+        instance(generate_instance(generator_parameters(number_of_cities))),
+        city_states(compute_city_state_table(instance))
+    {
+        // Pick a random state for the cities in a random order while the
+        // weight is below half of the capacity.
+        std::mt19937_64 generator(0);
+        std::vector<CityId> city_ids(instance.number_of_cities());
+        std::iota(city_ids.begin(), city_ids.end(), 0);
+        std::shuffle(city_ids.begin(), city_ids.end(), generator);
+        solution_city_states = std::vector<CityStateId>(instance.number_of_cities(), 0);
+        Weight weight = 0;
+        for (CityId city_id: city_ids) {
+            std::uniform_int_distribution<CityStateId> d_state(
+                    0,
+                    city_states.number_of_states(city_id) - 1);
+            CityStateId city_state_id = d_state(generator);
+            Weight city_state_weight = city_states.total_weight(city_id, city_state_id);
+            if (weight + city_state_weight > instance.capacity() / 2)
+                continue;
+            solution_city_states[city_id] = city_state_id;
+            weight += city_state_weight;
+        }
+
+        // Draw the moves evaluated by the benchmarks.
+        std::uniform_int_distribution<CityId> d_city(1, instance.number_of_cities() - 1);
+        for (Counter move_pos = 0; move_pos < 1024; ++move_pos) {
+            CityId city_id = d_city(generator);
+            std::uniform_int_distribution<CityStateId> d_state(
+                    0,
+                    city_states.number_of_states(city_id) - 1);
+            moves.push_back({city_id, d_state(generator)});
+        }
+    }
+
+    /** Instance. */
+    Instance instance;
+
+    /** City states. */
+    CityStateTable city_states;
+
+    /** State of each city in the solution. */
+    std::vector<CityStateId> solution_city_states;
+
+    /** Moves, as pairs (city, new state). */
+    std::vector<std::pair<CityId, CityStateId>> moves;
+};
+
+const PwtBenchmarkData& benchmark_data(CityId number_of_cities)
+{
+    static std::map<CityId, std::unique_ptr<PwtBenchmarkData>> datas;
+    auto it = datas.find(number_of_cities);
+    if (it == datas.end()) {
+        it = datas.insert({
+                number_of_cities,
+                std::unique_ptr<PwtBenchmarkData>(new PwtBenchmarkData(number_of_cities))}).first;
+    }
+    return *it->second;
+}
+
+void pwt_compute_city_states(benchmark::State& state)
+{
+    const PwtBenchmarkData& data = benchmark_data(state.range(0));
+    for (auto _: state) {
+        auto city_states = compute_city_states(data.instance);
+        benchmark::DoNotOptimize(city_states);
+    }
+    state.SetItemsProcessed(state.iterations() * data.instance.number_of_items());
+}
+
+void pwt_evaluate_move(benchmark::State& state)
+{
+    const PwtBenchmarkData& data = benchmark_data(state.range(0));
+    EfficientLocalSearchSolution solution = init_solution(
+            data.instance,
+            data.city_states,
+            data.solution_city_states);
+    Counter move_pos = 0;
+    for (auto _: state) {
+        const auto& move = data.moves[move_pos];
+        Profit objective = evaluate_move(
+                data.instance,
+                data.city_states,
+                solution,
+                move.first,
+                move.second);
+        benchmark::DoNotOptimize(objective);
+        move_pos = (move_pos + 1) % data.moves.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void pwt_apply_move(benchmark::State& state)
+{
+    const PwtBenchmarkData& data = benchmark_data(state.range(0));
+    EfficientLocalSearchSolution solution = init_solution(
+            data.instance,
+            data.city_states,
+            data.solution_city_states);
+    Counter move_pos = 0;
+    for (auto _: state) {
+        // Apply the move, then restore the state of the city so that the
+        // solution stays the same from one iteration to the next.
+        const auto& move = data.moves[move_pos];
+        CityStateId city_state_id = solution.city_states[move.first];
+        apply_move(
+                data.instance,
+                data.city_states,
+                solution,
+                move.first,
+                move.second);
+        apply_move(
+                data.instance,
+                data.city_states,
+                solution,
+                move.first,
+                city_state_id);
+        benchmark::DoNotOptimize(solution.objective);
+        move_pos = (move_pos + 1) % data.moves.size();
+    }
+    state.SetItemsProcessed(2 * state.iterations());
+}
+
+void pwt_sequential_value_correction_solve(benchmark::State& state)
+{
+    const PwtBenchmarkData& data = benchmark_data(state.range(0));
+    SequentialValueCorrectionParameters parameters;
+    parameters.verbosity_level = 0;
+    parameters.intermediary_outputs_parameters.policy = IntermediaryOutputsPolicy::None;
+    Output output(data.instance);
+    AlgorithmFormatter algorithm_formatter(parameters, output);
+
+    // Same range of values of alpha as in the algorithm.
+    double alpha_max = 0;
+    const std::vector<Distance>& city_distances_to_end = data.instance.city_distances_to_end();
+    for (ItemId item_id = 0;
+            item_id < data.instance.number_of_items();
+            ++item_id) {
+        const Item& item = data.instance.item(item_id);
+        double a = item.profit / item.weight / city_distances_to_end[item.city_id];
+        alpha_max = std::max(alpha_max, a);
+    }
+    double alpha = alpha_max / 3;
+
+    for (auto _: state) {
+        Solution solution = sequential_value_correction_internal::solve(
+                data.instance,
+                algorithm_formatter,
+                alpha);
+        benchmark::DoNotOptimize(solution);
+    }
+    state.SetItemsProcessed(state.iterations() * data.instance.number_of_items());
+}
+
+/**
+ * Instance with a single item and a given capacity for the benchmarks of the
+ * rows of the dynamic programming table.
+ */
+Instance dynamic_programming_instance(Weight capacity)
+{
+    InstanceBuilder instance_builder;
+    instance_builder.add_cities(2);
+    instance_builder.set_distance(0, 1000);
+    instance_builder.set_distance(1, 1000);
+    instance_builder.add_item(1, capacity / 3 + 1, 1000);
+    instance_builder.set_capacity(capacity);
+    instance_builder.set_minimum_speed(0.1);
+    instance_builder.set_maximum_speed(1.0);
+    instance_builder.set_renting_ratio(0.1);
+    return instance_builder.build();
+}
+
+/** Previous row of the dynamic programming table. */
+std::vector<double> dynamic_programming_previous_row(Weight capacity)
+{
+    std::vector<double> beta_prev(capacity + 1);
+    for (Weight weight = 0; weight <= capacity; ++weight)
+        beta_prev[weight] = -1e-3 * weight;
+    return beta_prev;
+}
+
+void pwt_dynamic_programming_city_row(benchmark::State& state)
+{
+    Weight capacity = state.range(0);
+    Instance instance = dynamic_programming_instance(capacity);
+    std::vector<double> beta_prev = dynamic_programming_previous_row(capacity);
+    std::vector<double> beta(capacity + 1);
+    for (auto _: state) {
+        dynamic_programming_internal::update_city_row(
+                instance,
+                7,
+                1000,
+                0,
+                capacity,
+                beta_prev,
+                beta);
+        benchmark::DoNotOptimize(beta.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * (capacity + 1));
+}
+
+void pwt_dynamic_programming_item_row(benchmark::State& state)
+{
+    Weight capacity = state.range(0);
+    Instance instance = dynamic_programming_instance(capacity);
+    std::vector<double> beta_prev = dynamic_programming_previous_row(capacity);
+    std::vector<double> beta(capacity + 1);
+    for (auto _: state) {
+        dynamic_programming_internal::update_item_row(
+                instance,
+                instance.item(0),
+                1000,
+                0,
+                capacity,
+                beta_prev,
+                beta);
+        benchmark::DoNotOptimize(beta.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * (capacity + 1));
+}
+
+}
+
+BENCHMARK(pwt_compute_city_states)
+    ->RangeMultiplier(10)->Range(100, 100000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(pwt_evaluate_move)
+    ->RangeMultiplier(10)->Range(100, 100000);
+BENCHMARK(pwt_apply_move)
+    ->RangeMultiplier(10)->Range(100, 100000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(pwt_sequential_value_correction_solve)
+    ->RangeMultiplier(10)->Range(100, 100000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(pwt_dynamic_programming_city_row)
+    ->RangeMultiplier(10)->Range(1000, 1000000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(pwt_dynamic_programming_item_row)
+    ->RangeMultiplier(10)->Range(1000, 1000000)
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,213 @@
+#include "travellingthiefsolver/travelling_thief/algorithms/efficient_local_search.hpp"
+#include "travellingthiefsolver/travelling_thief/generator.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+
+using namespace travellingthiefsolver::travelling_thief;
+
+namespace
+{
+
+/** Parameters of the generated instance of a given size. */
+travellingthiefsolver::packing_while_travelling::GeneratorParameters generator_parameters(
+        CityId number_of_cities)
+{
+    travellingthiefsolver::packing_while_travelling::GeneratorParameters parameters;
+    parameters.number_of_cities = number_of_cities;
+    parameters.number_of_items_per_city = 5;
+    parameters.capacity_category = 5;
+    return parameters;
+}
+
+using Distances = travelingsalesmansolver::Distances;
+
+/**
+ * Instance, local search scheme and solution shared by the benchmarks of a
+ * given size.
+ *
+ * The tour of the solution is computed with LKH once per size; the states of
+ * the cities are drawn at random while the weight is below half of the
+ * capacity.
+ */
+struct TtpBenchmarkData
+{
+    TtpBenchmarkData(CityId number_of_cities):
+        instance(travellingthiefsolver::travelling_thief::generate_instance(
+                    generator_parameters(number_of_cities))),
+        city_states(travellingthiefsolver::packing_while_travelling::compute_city_state_table(instance)),
+        output(instance)
+    {
+        // Same distance storage as the main program.
+        if (instance.number_of_cities() <= 16000)
+            instance.distances().compute_distances_explicit();
+
+        parameters.verbosity_level = 0;
+        parameters.intermediary_outputs_parameters.policy
+            = travellingthiefsolver::packing_while_travelling::IntermediaryOutputsPolicy::None;
+        algorithm_formatter = std::unique_ptr<AlgorithmFormatter>(
+                new AlgorithmFormatter(parameters, output));
+
+        // Compute a tour. The LKH candidates are stored in the parameters so
+        // that the local search scheme doesn't compute its own initial
+        // solutions.
+        std::mt19937_64 generator(0);
+        travelingsalesmansolver::Instance tsp_instance = create_tsp_instance(instance);
+        std::vector<Solution> tsp_solutions = solve_tsp_lkh(
+                instance.distances(),
+                instance,
+                tsp_instance,
+                generator,
+                parameters,
+                parameters.lkh_candidate_file_content);
+        for (CityPos city_pos = 0;
+                city_pos < instance.number_of_cities();
+                ++city_pos) {
+            city_ids.push_back(tsp_solutions.front().city_id(city_pos));
+        }
+
+        // Draw the states of the cities.
+        city_state_ids = std::vector<CityStateId>(instance.number_of_cities(), 0);
+        Weight weight = 0;
+        std::vector<CityId> shuffled_city_ids(city_ids.begin() + 1, city_ids.end());
+        std::shuffle(shuffled_city_ids.begin(), shuffled_city_ids.end(), generator);
+        for (CityId city_id: shuffled_city_ids) {
+            std::uniform_int_distribution<CityStateId> d_state(
+                    0,
+                    city_states.number_of_states(city_id) - 1);
+            CityStateId city_state_id = d_state(generator);
+            Weight city_state_weight = city_states.total_weight(city_id, city_state_id);
+            if (weight + city_state_weight > instance.capacity() / 2)
+                continue;
+            city_state_ids[city_id] = city_state_id;
+            weight += city_state_weight;
+        }
+
+        local_scheme = std::unique_ptr<EfficientLocalScheme<Distances>>(
+                new EfficientLocalScheme<Distances>(
+                    instance,
+                    instance.distances(),
+                    city_states,
+                    parameters,
+                    output,
+                    *algorithm_formatter,
+                    generator));
+
+        // Two-opt moves are evaluated between a city and its LKH candidates,
+        // as in the local search.
+        auto lkh_candidates = travelingsalesmansolver::read_candidates(
+                parameters.lkh_candidate_file_content);
+        for (CityId city_id = 1;
+                city_id < instance.number_of_cities();
+                ++city_id) {
+            for (const auto& candidate: lkh_candidates[city_id].edges)
+                two_opt_moves.push_back({city_id, candidate.vertex_id});
+        }
+    }
+
+    /** Instance. */
+    Instance instance;
+
+    /** City states. */
+    CityStateTable city_states;
+
+    /** Parameters of the local search scheme. */
+    EfficientLocalSearchParameters parameters;
+
+    /** Output of the local search scheme. */
+    EfficientLocalSearchOutput output;
+
+    /** Algorithm formatter of the local search scheme. */
+    std::unique_ptr<AlgorithmFormatter> algorithm_formatter;
+
+    /** Cities of the solution in the order they are visited. */
+    std::vector<CityId> city_ids;
+
+    /** State of each city in the solution. */
+    std::vector<CityStateId> city_state_ids;
+
+    /** Local search scheme. */
+    std::unique_ptr<EfficientLocalScheme<Distances>> local_scheme;
+
+    /** Two-opt moves, as pairs of cities. */
+    std::vector<std::pair<CityId, CityId>> two_opt_moves;
+};
+
+TtpBenchmarkData& benchmark_data(CityId number_of_cities)
+{
+    static std::map<CityId, std::unique_ptr<TtpBenchmarkData>> datas;
+    auto it = datas.find(number_of_cities);
+    if (it == datas.end()) {
+        it = datas.insert({
+                number_of_cities,
+                std::unique_ptr<TtpBenchmarkData>(new TtpBenchmarkData(number_of_cities))}).first;
+    }
+    return *it->second;
+}
+
+EfficientLocalSearchSolution benchmark_solution(const TtpBenchmarkData& data)
+{
+    return EfficientLocalSearchSolution(
+            data.instance,
+            data.instance.distances(),
+            data.city_states,
+            data.city_ids,
+            data.city_state_ids);
+}
+
+void ttp_efficient_local_search_solution(benchmark::State& state)
+{
+    TtpBenchmarkData& data = benchmark_data(state.range(0));
+    for (auto _: state) {
+        EfficientLocalSearchSolution solution = benchmark_solution(data);
+        benchmark::DoNotOptimize(solution);
+    }
+    state.SetItemsProcessed(state.iterations() * data.instance.number_of_cities());
+}
+
+void ttp_evaluate_two_opt_move(benchmark::State& state)
+{
+    TtpBenchmarkData& data = benchmark_data(state.range(0));
+    EfficientLocalSearchSolution solution = benchmark_solution(data);
+    Counter move_pos = 0;
+    for (auto _: state) {
+        const auto& move = data.two_opt_moves[move_pos];
+        Profit objective = data.local_scheme->evaluate_two_opt_move(
+                solution,
+                move.first,
+                move.second);
+        benchmark::DoNotOptimize(objective);
+        move_pos = (move_pos + 1) % data.two_opt_moves.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void ttp_evaluate_shift_change_city_state_2_move(benchmark::State& state)
+{
+    TtpBenchmarkData& data = benchmark_data(state.range(0));
+    EfficientLocalSearchSolution solution = benchmark_solution(data);
+    CityId city_id = 1;
+    for (auto _: state) {
+        auto output = data.local_scheme->evaluate_shift_change_city_state_2_move(
+                solution,
+                city_id);
+        benchmark::DoNotOptimize(output);
+        city_id = (city_id + 1 < data.instance.number_of_cities())? city_id + 1: 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+}
+
+BENCHMARK(ttp_efficient_local_search_solution)
+    ->RangeMultiplier(10)->Range(100, 10000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(ttp_evaluate_two_opt_move)
+    ->RangeMultiplier(10)->Range(100, 10000);
+BENCHMARK(ttp_evaluate_shift_change_city_state_2_move)
+    ->RangeMultiplier(10)->Range(100, 10000)
+    ->Unit(benchmark::kMicrosecond);
@@ -2,6 +2,8 @@
 
 #include "travellingthiefsolver/packing_while_travelling/reduction.hpp"
 #include "travellingthiefsolver/packing_while_travelling/solution_builder.hpp"
+#include "travellingthiefsolver/packing_while_travelling/intermediary_outputs.hpp"
+#include "travellingthiefsolver/packing_while_travelling/profiling.hpp"
 
 #include "optimizationtools//utils//output.hpp"
 #include "optimizationtools//utils//utils.hpp"
@@ -77,6 +79,23 @@ struct Output: optimizationtools::Output
         };
     }
 
+    /**
+     * Export the scalar metrics to a JSON structure.
+     *
+     * Unlike 'to_json', the solution is not exported; this is what is stored
+     * in the intermediary outputs.
+     */
+    nlohmann::json metrics_to_json() const
+    {
+        return nlohmann::json {
+            {"Value", solution_value()},
+            {"Bound", bound},
+            {"AbsoluteOptimalityGap", absolute_optimality_gap()},
+            {"RelativeOptimalityGap", relative_optimality_gap()},
+            {"Time", time}
+        };
+    }
+
     virtual int format_width() const { return 30; }
 
     virtual void format(std::ostream& os) const
@@ -99,6 +118,9 @@ struct Parameters: optimizationtools::Parameters
     /** Callback function called when a new best solution is found. */
     NewSolutionCallback new_solution_callback = [](const Output&, const std::string&) { };
 
+    /** Parameters of the history of intermediary outputs. */
+    IntermediaryOutputsParameters intermediary_outputs_parameters;
+
     /** Reduction parameters. */
     ReductionParameters reduction_parameters;
 
@@ -112,6 +134,7 @@ struct Parameters: optimizationtools::Parameters
                 {"MaximumNumberOfRounds", reduction_parameters.maximum_number_of_rounds},
                 {"ExpensiveReduction", reduction_parameters.enable_expensive_reduction},
                 });
+        json.merge_patch({{"IntermediaryOutputs", intermediary_outputs_parameters.to_json()}});
         return json;
     }
 
@@ -127,6 +150,7 @@ struct Parameters: optimizationtools::Parameters
             << std::setw(width) << std::left << "    Max. # of rounds: " << reduction_parameters.maximum_number_of_rounds << std::endl
             << std::setw(width) << std::left << "    Expensive reduction: " << reduction_parameters.enable_expensive_reduction << std::endl
             ;
+        intermediary_outputs_parameters.format(os, width);
     }
 };
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "travellingthiefsolver/packing_while_travelling/algorithm.hpp"
+#include "travellingthiefsolver/packing_while_travelling/profiling.hpp"
 
 namespace travellingthiefsolver
 {
@@ -18,7 +19,12 @@ public:
             Output& output):
         parameters_(parameters),
         output_(output),
-        os_(parameters.create_os()) { }
+        os_(parameters.create_os()),
+        intermediary_outputs_(parameters.intermediary_outputs_parameters)
+    {
+        if (profiling::enabled)
+            profiling_start_ = profiling::snapshot();
+    }
 
     /** Print the header. */
     void start(
@@ -58,6 +64,12 @@ private:
     /** Output stream. */
     std::unique_ptr<optimizationtools::ComposeStream> os_;
 
+    /** History of intermediary outputs. */
+    IntermediaryOutputs intermediary_outputs_;
+
+    /** Measures of the profiler at the start of the algorithm. */
+    profiling::Snapshot profiling_start_;
+
 };
 
 template <typename Algorithm, typename AlgorithmParameters, typename AlgorithmOutput>
@@ -75,6 +87,9 @@ inline const AlgorithmOutput solve_reduced_instance(
     AlgorithmParameters new_parameters = parameters;
     new_parameters.reduction_parameters.reduce = false;
     new_parameters.verbosity_level = 0;
+    // The entries are added to the history of the outer formatter by the
+    // callback.
+    new_parameters.intermediary_outputs_parameters.policy = IntermediaryOutputsPolicy::None;
     new_parameters.new_solution_callback = [
         &algorithm_formatter,
         &reduction,
@@ -23,5 +23,40 @@ Output dynamic_programming(
         const Instance& instance,
         const DynamicProgrammingParameters& parameters = {});
 
+namespace dynamic_programming_internal
+{
+
+/**
+ * Compute the row of the table after the city with weight 'city_weight'.
+ *
+ * The entries from 'weight_min' to 'weight_max' of 'beta' are computed from
+ * the previous row 'beta_prev'.
+ */
+void update_city_row(
+        const Instance& instance,
+        Weight city_weight,
+        Distance distance_to_end,
+        Weight weight_min,
+        Weight weight_max,
+        const std::vector<double>& beta_prev,
+        std::vector<double>& beta);
+
+/**
+ * Compute the row of the table after an item.
+ *
+ * The entries from 'weight_min' to 'weight_max' of 'beta' are computed from
+ * the previous row 'beta_prev'.
+ */
+void update_item_row(
+        const Instance& instance,
+        const Item& item,
+        Distance distance_to_end,
+        Weight weight_min,
+        Weight weight_max,
+        const std::vector<double>& beta_prev,
+        std::vector<double>& beta);
+
+}
+
 }
 }
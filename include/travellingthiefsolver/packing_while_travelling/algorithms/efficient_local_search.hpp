@@ -1,6 +1,7 @@
 #pragma once
 
 #include "travellingthiefsolver/packing_while_travelling/algorithm.hpp"
+#include "travellingthiefsolver/packing_while_travelling/utils.hpp"
 
 namespace travellingthiefsolver
 {
@@ -12,6 +13,13 @@ struct EfficientLocalSearchParameters: Parameters
     /** Solution. */
     Solution* initial_solution = nullptr;
 
+    /**
+     * City states of the instance; computed if 'nullptr'.
+     *
+     * They are not used on the reduced instance.
+     */
+    const CityStateTable* city_states = nullptr;
+
     /**
      * Minimum relative improvement required at each iteration. If this value
      * is not reached, the algorithm stops.
@@ -19,6 +27,43 @@ struct EfficientLocalSearchParameters: Parameters
      * This is only used when the objective is > 0.
      */
     double minimum_improvement = 0.001;
+
+    /**
+     * Use best-improvement instead of first-improvement.
+     *
+     * At each iteration, all the moves are evaluated against the current
+     * solution, then the best improving move of each city is applied by
+     * decreasing gain, each of them being re-evaluated before being applied.
+     */
+    bool best_improvement = false;
+
+    /** Number of threads used to evaluate the moves in best-improvement. */
+    Counter number_of_threads = 1;
+
+
+    virtual int format_width() const override { return 26; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Parameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Minimum improvement: " << minimum_improvement << std::endl
+            << std::setw(width) << std::left << "Best improvement: " << best_improvement << std::endl
+            << std::setw(width) << std::left << "Number of threads: " << number_of_threads << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Parameters::to_json();
+        json.merge_patch({
+                {"MinimumImprovement", minimum_improvement},
+                {"BestImprovement", best_improvement},
+                {"NumberOfThreads", number_of_threads},
+                });
+        return json;
+    }
 };
 
 struct EfficientLocalSearchOutput: Output
@@ -28,12 +73,127 @@ struct EfficientLocalSearchOutput: Output
         Output(instance) { }
 
 
+    /** Number of passes over the cities. */
     Counter number_of_iterations = 0;
+
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Output::to_json();
+        json.merge_patch({
+                {"NumberOfIterations", number_of_iterations},
+                });
+        return json;
+    }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Output::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of iterations: " << number_of_iterations << std::endl
+            ;
+    }
 };
 
 EfficientLocalSearchOutput efficient_local_search(
         const Instance& instance,
         const EfficientLocalSearchParameters& parameters = {});
 
+namespace efficient_local_search_internal
+{
+
+/**
+ * Number of terms of the expansion used to evaluate the travel time of the
+ * end of the tour after a weight shift.
+ */
+constexpr Counter number_of_time_moments = 6;
+
+/**
+ * Structure for a solution of the efficient local search algorithm.
+ *
+ * Leg j, 1 <= j < n, goes from city j - 1 to city j, and leg n goes from city
+ * n - 1 back to city 0. The travel time of leg j is d_j / a_j with
+ * a_j = v_max - nu W_{j - 1}. If the weight carried on the legs after city k
+ * shifts by Delta, the travel time of these legs becomes
+ *
+ *     sum_{j > k} d_j / (a_j - nu Delta)
+ *     = sum_{m >= 0} (nu Delta)^m sum_{j > k} d_j / a_j^{m + 1}
+ *
+ * The prefix sums of d_j / a_j^{m + 1} for the first moments are stored so
+ * that a truncated version of this expansion, with a bound on the truncation
+ * error, is available in O(number_of_time_moments) for any city.
+ */
+struct EfficientLocalSearchSolution
+{
+    /** States of each city. */
+    std::vector<CityStateId> city_states;
+
+    /** Profit of the solution. */
+    Profit profit = 0;
+
+    /** Weight of the solution. */
+    Weight weight = 0;
+
+    /** Travel time of the solution. */
+    Time time = 0;
+
+    /** Cumulative weight for each city. */
+    std::vector<Weight> cumulative_weights;
+
+    /** Cumulative profit for each city. */
+    std::vector<Profit> cumulative_profits;
+
+    /** Cumulative time for each city. */
+    std::vector<Time> cumulative_times;
+
+    /**
+     * Prefix sums of d_j / a_j^{m + 1} over the legs.
+     *
+     * time_moments[j * number_of_time_moments + m] is the sum for the legs 1
+     * to j.
+     */
+    std::vector<Time> time_moments;
+
+    /** Objective value of the solution. */
+    Profit objective;
+};
+
+/**
+ * Build the solution of the efficient local search algorithm corresponding to
+ * a state for each city.
+ */
+EfficientLocalSearchSolution init_solution(
+        const Instance& instance,
+        const CityStateTable& city_states,
+        const std::vector<CityStateId>& solution_city_states);
+
+/**
+ * Evaluate the objective value of the solution after changing the state of a
+ * city.
+ *
+ * Return -infinity if the new solution is infeasible or if it is proven not
+ * to be better than the current solution. Otherwise, return the exact
+ * objective value of the new solution.
+ */
+Profit evaluate_move(
+        const Instance& instance,
+        const CityStateTable& city_states,
+        const EfficientLocalSearchSolution& solution,
+        CityId city_id,
+        CityStateId city_state_id);
+
+/**
+ * Change the state of a city.
+ */
+void apply_move(
+        const Instance& instance,
+        const CityStateTable& city_states,
+        EfficientLocalSearchSolution& solution,
+        CityId city_id,
+        CityStateId city_state_id);
+
+}
+
 }
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "travellingthiefsolver/packing_while_travelling/algorithm.hpp"
+#include "travellingthiefsolver/packing_while_travelling/algorithm_formatter.hpp"
 
 namespace travellingthiefsolver
 {
@@ -15,6 +16,21 @@ Output sequential_value_correction(
         const Instance& instance,
         const SequentialValueCorrectionParameters& parameters = {});
 
+namespace sequential_value_correction_internal
+{
+
+/**
+ * Solve the knapsack problem where the profit of each item is decreased by
+ * 'alpha' times its weight times the distance from its city to the end of
+ * the tour.
+ */
+Solution solve(
+        const Instance& instance,
+        AlgorithmFormatter& algorithm_formatter,
+        double alpha);
+
+}
+
 }
 }
 
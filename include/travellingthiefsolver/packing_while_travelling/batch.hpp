@@ -0,0 +1,157 @@
+#pragma once
+
+#include "nlohmann/json.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace travellingthiefsolver
+{
+namespace packing_while_travelling
+{
+
+/**
+ * Batch mode of the main programs.
+ *
+ * The jobs of a batch are given by a manifest in the JSON-lines format: each
+ * non-empty line is a JSON object whose keys are the long names of the
+ * command-line options of the main program and whose values are the values
+ * of these options, for example:
+ *
+ *     {"input": "a.ttp", "algorithm": "efficient-local-search", "time-limit": 10}
+ *
+ * Flags are given with the value 'true'.
+ */
+
+/** Read the jobs of a batch manifest. */
+std::vector<nlohmann::json> read_batch_manifest(const std::string& manifest_path);
+
+/** Convert a job of a batch manifest to command-line arguments. */
+std::vector<std::string> batch_job_arguments(const nlohmann::json& job);
+
+/**
+ * Run the jobs of a batch.
+ *
+ * 'number_of_threads' workers take the jobs in the order of the manifest and
+ * call 'run_job' on them. The result of each job is written to 'os' as soon
+ * as the job is done, on a single line, with the position of the job in the
+ * manifest in its "Id" field. If 'run_job' throws, the message of the
+ * exception is written in an "Error" field instead.
+ */
+void run_batch(
+        const std::vector<nlohmann::json>& jobs,
+        int64_t number_of_threads,
+        std::ostream& os,
+        const std::function<nlohmann::json(const nlohmann::json&)>& run_job);
+
+/**
+ * Cache of the objects shared between the jobs of a batch, such as the
+ * instances or the distances.
+ *
+ * An object is computed by the first job which requests it; the other jobs
+ * requesting it meanwhile wait for it instead of computing it again. Only the
+ * 'maximum_number_of_entries' most recently used objects are kept; the jobs
+ * holding an evicted object keep it alive until they are done.
+ */
+template <typename Value>
+class BatchCache
+{
+
+public:
+
+    /** Constructor. */
+    BatchCache(int64_t maximum_number_of_entries):
+        maximum_number_of_entries_(maximum_number_of_entries) { }
+
+    /** Get an object, computing it if it is not in the cache. */
+    std::shared_ptr<const Value> get(
+            const std::string& key,
+            const std::function<std::shared_ptr<const Value>()>& compute)
+    {
+        std::promise<std::shared_ptr<const Value>> promise;
+        std::shared_future<std::shared_ptr<const Value>> future;
+        bool owner = false;
+        int64_t creation = -1;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            clock_++;
+            auto it = entries_.find(key);
+            if (it != entries_.end()) {
+                it->second.last_use = clock_;
+                future = it->second.value;
+            } else {
+                future = promise.get_future().share();
+                entries_[key] = {future, clock_, clock_};
+                evict();
+                owner = true;
+                creation = clock_;
+            }
+        }
+        if (!owner)
+            return future.get();
+
+        try {
+            promise.set_value(compute());
+        } catch (...) {
+            {
+                // Don't keep the failure in the cache.
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = entries_.find(key);
+                if (it != entries_.end() && it->second.creation == creation)
+                    entries_.erase(it);
+            }
+            promise.set_exception(std::current_exception());
+        }
+        return future.get();
+    }
+
+private:
+
+    /** Entry of the cache. */
+    struct Entry
+    {
+        /** Object. */
+        std::shared_future<std::shared_ptr<const Value>> value;
+
+        /** Time of the last use. */
+        int64_t last_use;
+
+        /** Time of the creation of the entry. */
+        int64_t creation;
+    };
+
+    /** Remove the least recently used entries beyond the maximum number. */
+    void evict()
+    {
+        while ((int64_t)entries_.size() > maximum_number_of_entries_) {
+            auto it_lru = entries_.begin();
+            for (auto it = entries_.begin(); it != entries_.end(); ++it)
+                if (it->second.last_use < it_lru->second.last_use)
+                    it_lru = it;
+            entries_.erase(it_lru);
+        }
+    }
+
+    /** Maximum number of entries. */
+    int64_t maximum_number_of_entries_;
+
+    /** Mutex protecting the entries. */
+    std::mutex mutex_;
+
+    /** Entries. */
+    std::map<std::string, Entry> entries_;
+
+    /** Number of requests so far, used as a clock for the last uses. */
+    int64_t clock_ = 0;
+
+};
+
+}
+}
@@ -0,0 +1,298 @@
+#pragma once
+
+#include "travellingthiefsolver/packing_while_travelling/mapped_file.hpp"
+#include "travellingthiefsolver/packing_while_travelling/instance.hpp"
+
+#include "optimizationtools/utils/utils.hpp"
+
+#include <fstream>
+#include <memory>
+
+namespace travellingthiefsolver
+{
+namespace packing_while_travelling
+{
+
+/**
+ * Version of the binary instance format written by 'write_binary_instance'.
+ */
+constexpr uint32_t binary_instance_version = 1;
+
+/**
+ * Problem of a binary instance.
+ */
+enum class BinaryInstanceProblem: uint32_t
+{
+    TravellingThief = 1,
+    ThiefOrienteering = 2,
+    PackingWhileTravelling = 3,
+    TravellingWhilePacking = 4,
+};
+
+/**
+ * Coordinates of the cities with the TSPLIB edge weight type used to compute
+ * the distances from them.
+ *
+ * They are kept by the instances read from a file with coordinates, so that
+ * the instances, and the instances derived from them, can be written in the
+ * binary format without an explicit distance matrix.
+ */
+struct CityCoordinates
+{
+    /** TSPLIB edge weight type, for example 'CEIL_2D'. */
+    std::string edge_weight_type;
+
+    /** x-coordinates of the cities. */
+    std::vector<double> xs;
+
+    /** y-coordinates of the cities. */
+    std::vector<double> ys;
+};
+
+/**
+ * Content of a binary instance, as given to 'write_binary_instance'.
+ *
+ * Arrays which are not used by a problem are left empty.
+ */
+struct BinaryInstanceData
+{
+    /** Problem. */
+    BinaryInstanceProblem problem = BinaryInstanceProblem::TravellingThief;
+
+    /** Number of cities. */
+    CityId number_of_cities = 0;
+
+    /** Capacity of the knapsack. */
+    Weight capacity = -1;
+
+    /** Minimum speed. */
+    double minimum_speed = -1;
+
+    /** Maximum speed. */
+    double maximum_speed = -1;
+
+    /** Renting ratio. */
+    double renting_ratio = 1.0;
+
+    /** Time limit. */
+    Time time_limit = -1;
+
+    /** Coordinates of the cities. */
+    std::shared_ptr<const CityCoordinates> coordinates;
+
+    /**
+     * Explicit distance matrix, row by row; only used if there are no
+     * coordinates.
+     */
+    std::vector<Distance> distance_matrix;
+
+    /** Distance from each city to the next one. */
+    std::vector<Distance> city_distances;
+
+    /** Weights of the cities. */
+    std::vector<Weight> city_weights;
+
+    /** Cities of the items. */
+    std::vector<CityId> item_city_ids;
+
+    /** Weights of the items. */
+    std::vector<Weight> item_weights;
+
+    /** Profits of the items. */
+    std::vector<Profit> item_profits;
+};
+
+/**
+ * Write an instance in the binary format.
+ *
+ * The file starts with a fixed-size header (magic string, version, byte
+ * order mark, problem, scalars and the offsets of the arrays) followed by
+ * the arrays, each aligned on 8 bytes. The items are stored as separate
+ * arrays of cities, weights and profits, and the items of each city are
+ * indexed by CSR offsets.
+ */
+void write_binary_instance(
+        const std::string& instance_path,
+        const BinaryInstanceData& data);
+
+/**
+ * Compute the explicit distance matrix of an instance without coordinates.
+ */
+template <typename Distances>
+std::vector<Distance> compute_distance_matrix(
+        const Distances& distances,
+        CityId number_of_cities)
+{
+    std::vector<Distance> distance_matrix(number_of_cities * number_of_cities);
+    for (CityId city_id_1 = 0;
+            city_id_1 < number_of_cities;
+            ++city_id_1) {
+        for (CityId city_id_2 = 0;
+                city_id_2 < number_of_cities;
+                ++city_id_2) {
+            distance_matrix[city_id_1 * number_of_cities + city_id_2]
+                = distances.distance(city_id_1, city_id_2);
+        }
+    }
+    return distance_matrix;
+}
+
+/**
+ * Instance file in the binary format.
+ *
+ * The file is memory-mapped and the arrays are accessed in place; the
+ * pointers remain valid as long as this object is alive. Absent arrays are
+ * returned as 'nullptr'.
+ *
+ * A packing while travelling instance read from this file shares its
+ * ownership and views the item index of the cities in place. The other
+ * arrays are copied by the instance builders.
+ */
+class BinaryInstanceFile
+{
+
+public:
+
+    /** Header of the file. */
+    struct Header;
+
+    /**
+     * Constructor.
+     *
+     * Throw if the file is not a binary instance file of a supported version.
+     */
+    BinaryInstanceFile(const std::string& instance_path);
+
+    /** Get the problem. */
+    BinaryInstanceProblem problem() const;
+
+    /** Get the number of cities. */
+    CityId number_of_cities() const;
+
+    /** Get the number of items. */
+    ItemId number_of_items() const;
+
+    /** Get the capacity of the knapsack. */
+    Weight capacity() const;
+
+    /** Get the minimum speed. */
+    double minimum_speed() const;
+
+    /** Get the maximum speed. */
+    double maximum_speed() const;
+
+    /** Get the renting ratio. */
+    double renting_ratio() const;
+
+    /** Get the time limit. */
+    Time time_limit() const;
+
+    /** Get the TSPLIB edge weight type; empty without coordinates. */
+    std::string edge_weight_type() const;
+
+    /** Get the x-coordinates of the cities. */
+    const double* xs() const { return array<double>(0); }
+
+    /** Get the y-coordinates of the cities. */
+    const double* ys() const { return array<double>(1); }
+
+    /** Get the explicit distance matrix. */
+    const Distance* distance_matrix() const { return array<Distance>(2); }
+
+    /** Get the distance from each city to the next one. */
+    const Distance* city_distances() const { return array<Distance>(3); }
+
+    /** Get the weights of the cities. */
+    const Weight* city_weights() const { return array<Weight>(4); }
+
+    /** Get the cities of the items. */
+    const CityId* item_city_ids() const { return array<CityId>(5); }
+
+    /** Get the weights of the items. */
+    const Weight* item_weights() const { return array<Weight>(6); }
+
+    /** Get the profits of the items. */
+    const Profit* item_profits() const { return array<Profit>(7); }
+
+    /** Get the CSR offsets of the items of the cities. */
+    const ItemId* city_item_offsets() const { return array<ItemId>(8); }
+
+    /** Get the items of the cities, indexed by 'city_item_offsets'. */
+    const ItemId* city_item_ids() const { return array<ItemId>(9); }
+
+    /** Get the coordinates of the cities, or 'nullptr' if absent. */
+    std::shared_ptr<const CityCoordinates> coordinates() const;
+
+private:
+
+    /** Get an array from its index in the header. */
+    template <typename T>
+    const T* array(int array_id) const
+    {
+        uint64_t offset = offsets_[array_id];
+        return (offset == 0)? nullptr: reinterpret_cast<const T*>(mapped_file_.begin() + offset);
+    }
+
+    /** Mapped file. */
+    MappedFile mapped_file_;
+
+    /** Header. */
+    const Header* header_ = nullptr;
+
+    /** Offsets of the arrays. */
+    const uint64_t* offsets_ = nullptr;
+
+};
+
+/**
+ * Set the distances of a TSPLIB distances builder from the coordinates or
+ * from the explicit distance matrix of a binary instance file.
+ */
+template <typename DistancesBuilder>
+void set_distances(
+        const BinaryInstanceFile& file,
+        DistancesBuilder& distances_builder)
+{
+    CityId number_of_cities = file.number_of_cities();
+    distances_builder.set_number_of_vertices(number_of_cities);
+    std::string edge_weight_type = (file.xs() != nullptr)?
+        file.edge_weight_type():
+        "EXPLICIT";
+    if (!edge_weight_type.empty()) {
+        // The TSPLIB reader only reads from the stream for sections, so the
+        // header line can be passed with an unopened stream.
+        std::ifstream no_file;
+        std::string tmp = "EDGE_WEIGHT_TYPE: " + edge_weight_type;
+        std::vector<std::string> line = optimizationtools::split(tmp);
+        if (!distances_builder.read_tsplib(no_file, tmp, line)) {
+            throw std::invalid_argument(
+                    "Unsupported edge weight type \"" + edge_weight_type + "\".");
+        }
+    }
+    if (file.xs() != nullptr) {
+        const double* xs = file.xs();
+        const double* ys = file.ys();
+        for (CityId city_id = 0;
+                city_id < number_of_cities;
+                ++city_id) {
+            distances_builder.set_coordinates(city_id, xs[city_id], ys[city_id]);
+        }
+    } else if (file.distance_matrix() != nullptr) {
+        const Distance* distance_matrix = file.distance_matrix();
+        for (CityId city_id_1 = 0;
+                city_id_1 < number_of_cities;
+                ++city_id_1) {
+            for (CityId city_id_2 = 0;
+                    city_id_2 < number_of_cities;
+                    ++city_id_2) {
+                distances_builder.set_distance(
+                        city_id_1,
+                        city_id_2,
+                        distance_matrix[city_id_1 * number_of_cities + city_id_2]);
+            }
+        }
+    }
+}
+
+}
+}
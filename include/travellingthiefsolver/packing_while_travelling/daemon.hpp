@@ -0,0 +1,50 @@
+#pragma once
+
+#include "nlohmann/json.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace travellingthiefsolver
+{
+namespace packing_while_travelling
+{
+
+/**
+ * Daemon mode of the main programs.
+ *
+ * The daemon listens on a Unix domain socket. Each message, in both
+ * directions, is a JSON object preceded by its length in bytes as a 4-byte
+ * big-endian unsigned integer. A client sends requests on a connection and
+ * receives one response per request, in the order of the requests.
+ *
+ * The requests of all the connections are processed one at a time, in their
+ * order of arrival; the pending requests wait in the socket buffers. Thus,
+ * each request can use all the threads of the machine, and the state kept
+ * warm by the daemon between the requests is never accessed concurrently.
+ * The connections are read without blocking, so a client sending a message
+ * slowly, or only part of it, doesn't delay the others; a client which
+ * doesn't read a response within 10 seconds is disconnected.
+ *
+ * A file already at the path of the socket is replaced only if it is a
+ * socket, for example one left by a previous daemon.
+ *
+ * The request '{"command": "shutdown"}' stops the daemon. If the handler of
+ * a request throws, the response contains the message of the exception in
+ * its "Error" field.
+ *
+ * Unix domain sockets are not available on Windows, where 'run_daemon'
+ * throws.
+ */
+
+/** Maximum length of a message of the daemon. */
+constexpr uint32_t daemon_maximum_message_length = 1 << 30;
+
+/** Run a daemon listening on 'socket_path' until it receives a shutdown request. */
+void run_daemon(
+        const std::string& socket_path,
+        const std::function<nlohmann::json(const nlohmann::json&)>& handle_request);
+
+}
+}
@@ -0,0 +1,326 @@
+#pragma once
+
+#include "travellingthiefsolver/packing_while_travelling/instance.hpp"
+#include "travellingthiefsolver/packing_while_travelling/binary_instance.hpp"
+
+#include "optimizationtools/utils/utils.hpp"
+
+#include <fstream>
+#include <memory>
+#include <random>
+
+namespace travellingthiefsolver
+{
+namespace packing_while_travelling
+{
+
+/**
+ * Synthetic instance generator.
+ *
+ * The instances follow the scheme of the benchmark of Polyakovskiy et al.
+ * (2014): the cities are points of the plane with 'CEIL_2D' distances, each
+ * city but the first one contains the same number of items, and the capacity
+ * of the knapsack is a fraction of the total weight of the items. The
+ * coordinates and the items are drawn from the distributions below.
+ *
+ * The generated instances only depend on the parameters, including the seed:
+ * the random numbers are drawn from 'std::mt19937_64', whose output is fixed
+ * by the standard, and not from the distributions of the standard library,
+ * whose output depends on the implementation.
+ *
+ * The generator only stores arrays of size linear in the number of cities and
+ * items, so instances with 10^6 cities can be generated.
+ */
+
+/** Side of the square containing the cities. */
+constexpr int64_t generator_square_side = 1000000;
+
+/**
+ * Distribution of the coordinates of the cities.
+ */
+enum class CoordinatesDistribution
+{
+    /** Uniformly distributed in the square. */
+    Uniform,
+
+    /**
+     * Normally distributed around 'number_of_cities / 10' centers uniformly
+     * distributed in the square, as in the clustered instances of the DIMACS
+     * TSP challenge.
+     */
+    Clustered,
+
+    /**
+     * Nodes of a regular grid with about half of the nodes empty, as in the
+     * drilling instances of TSPLIB ('pcb', 'pla', 'fnl'...).
+     */
+    TsplibLike,
+};
+
+inline std::string to_string(CoordinatesDistribution coordinates_distribution)
+{
+    switch (coordinates_distribution) {
+    case CoordinatesDistribution::Uniform:
+        return "uniform";
+    case CoordinatesDistribution::Clustered:
+        return "clustered";
+    case CoordinatesDistribution::TsplibLike:
+        return "tsplib-like";
+    }
+    return "";
+}
+
+inline std::ostream& operator<<(
+        std::ostream& os,
+        CoordinatesDistribution coordinates_distribution)
+{
+    os << to_string(coordinates_distribution);
+    return os;
+}
+
+inline std::istream& operator>>(
+        std::istream& is,
+        CoordinatesDistribution& coordinates_distribution)
+{
+    std::string s;
+    is >> s;
+    if (s == "uniform") {
+        coordinates_distribution = CoordinatesDistribution::Uniform;
+    } else if (s == "clustered") {
+        coordinates_distribution = CoordinatesDistribution::Clustered;
+    } else if (s == "tsplib-like") {
+        coordinates_distribution = CoordinatesDistribution::TsplibLike;
+    } else {
+        is.setstate(std::ios_base::failbit);
+    }
+    return is;
+}
+
+/**
+ * Correlation between the weights and the profits of the items, as in the
+ * benchmark of Polyakovskiy et al. (2014).
+ */
+enum class ItemsCorrelation
+{
+    /** Weights and profits uniformly distributed in [1, 1000]. */
+    Uncorrelated,
+
+    /**
+     * Weights uniformly distributed in [1, 1000] and profits equal to the
+     * weights plus 100.
+     */
+    BoundedStronglyCorrelated,
+
+    /**
+     * Weights uniformly distributed in [1000, 1010] and profits uniformly
+     * distributed in [1, 1000].
+     */
+    UncorrelatedSimilarWeights,
+};
+
+inline std::string to_string(ItemsCorrelation items_correlation)
+{
+    switch (items_correlation) {
+    case ItemsCorrelation::Uncorrelated:
+        return "uncorrelated";
+    case ItemsCorrelation::BoundedStronglyCorrelated:
+        return "bounded-strongly-correlated";
+    case ItemsCorrelation::UncorrelatedSimilarWeights:
+        return "uncorrelated-similar-weights";
+    }
+    return "";
+}
+
+inline std::ostream& operator<<(
+        std::ostream& os,
+        ItemsCorrelation items_correlation)
+{
+    os << to_string(items_correlation);
+    return os;
+}
+
+inline std::istream& operator>>(
+        std::istream& is,
+        ItemsCorrelation& items_correlation)
+{
+    std::string s;
+    is >> s;
+    if (s == "uncorrelated") {
+        items_correlation = ItemsCorrelation::Uncorrelated;
+    } else if (s == "bounded-strongly-correlated") {
+        items_correlation = ItemsCorrelation::BoundedStronglyCorrelated;
+    } else if (s == "uncorrelated-similar-weights") {
+        items_correlation = ItemsCorrelation::UncorrelatedSimilarWeights;
+    } else {
+        is.setstate(std::ios_base::failbit);
+    }
+    return is;
+}
+
+/**
+ * Parameters of the generator.
+ */
+struct GeneratorParameters
+{
+    /** Number of cities. */
+    CityId number_of_cities = 100;
+
+    /** Distribution of the coordinates of the cities. */
+    CoordinatesDistribution coordinates_distribution = CoordinatesDistribution::Uniform;
+
+    /** Number of items of each city but the first one. */
+    ItemId number_of_items_per_city = 1;
+
+    /** Correlation between the weights and the profits of the items. */
+    ItemsCorrelation items_correlation = ItemsCorrelation::Uncorrelated;
+
+    /**
+     * Capacity category, between 1 and 10; the capacity is
+     * 'capacity_category / 11' times the total weight of the items.
+     */
+    Counter capacity_category = 1;
+
+    /** Minimum speed. */
+    double minimum_speed = 0.1;
+
+    /** Maximum speed. */
+    double maximum_speed = 1.0;
+
+    /**
+     * Time limit of the thief orienteering instances, as a multiple of the
+     * time of the reference tour at maximum speed.
+     */
+    double time_limit_factor = 1.0;
+
+    /** Seed. */
+    Seed seed = 0;
+};
+
+/**
+ * Random number generator whose output only depends on the seed.
+ */
+class GeneratorRandom
+{
+
+public:
+
+    /** Constructor. */
+    explicit GeneratorRandom(Seed seed): generator_(seed) { }
+
+    /** Draw an integer uniformly distributed in [minimum, maximum]. */
+    int64_t integer(
+            int64_t minimum,
+            int64_t maximum);
+
+    /** Draw a real number uniformly distributed in [0, 1). */
+    double real();
+
+    /**
+     * Draw a real number approximately following the standard normal
+     * distribution.
+     *
+     * It is the sum of 12 uniform numbers minus 6, so that it doesn't depend
+     * on the implementation of the mathematical functions.
+     */
+    double normal();
+
+private:
+
+    /** Generator. */
+    std::mt19937_64 generator_;
+
+};
+
+/**
+ * Data common to the generated instances of all the problems.
+ */
+struct GeneratedData
+{
+    /** Coordinates of the cities. */
+    std::shared_ptr<CityCoordinates> coordinates;
+
+    /** Cities of the items. */
+    std::vector<CityId> item_city_ids;
+
+    /** Weights of the items. */
+    std::vector<Weight> item_weights;
+
+    /** Profits of the items. */
+    std::vector<Profit> item_profits;
+
+    /** Capacity of the knapsack. */
+    Weight capacity = 0;
+
+    /**
+     * Reference tour, starting at city 0.
+     *
+     * It is the boustrophedon tour through vertical strips of the square,
+     * computed in O(n log n); it is about 30% longer than an optimal tour on
+     * large uniform instances.
+     */
+    std::vector<CityId> tour;
+
+    /** Length of the reference tour. */
+    Distance tour_length = 0;
+
+    /** Items selected by the greedy solution of the knapsack problem. */
+    std::vector<uint8_t> knapsack_items;
+
+    /** Profit of the greedy solution of the knapsack problem. */
+    Profit knapsack_profit = 0;
+
+    /**
+     * Renting ratio such that the renting cost of the reference tour at
+     * maximum speed is equal to the profit of the greedy solution of the
+     * knapsack problem.
+     */
+    double renting_ratio = 0;
+
+    /** Time of the reference tour at maximum speed times the time limit factor. */
+    Time time_limit = 0;
+};
+
+/** Compute the 'CEIL_2D' distance between two cities. */
+Distance generator_distance(
+        const CityCoordinates& coordinates,
+        CityId city_id_1,
+        CityId city_id_2);
+
+/** Generate the data common to all the problems. */
+GeneratedData generate_data(const GeneratorParameters& parameters);
+
+/**
+ * Generate a packing while travelling instance.
+ *
+ * The tour of the instance is the reference tour.
+ */
+Instance generate_instance(const GeneratorParameters& parameters);
+
+/**
+ * Set the distances of a TSPLIB distances builder from generated coordinates.
+ */
+template <typename DistancesBuilder>
+void set_distances(
+        const CityCoordinates& coordinates,
+        DistancesBuilder& distances_builder)
+{
+    CityId number_of_cities = coordinates.xs.size();
+    distances_builder.set_number_of_vertices(number_of_cities);
+    // The TSPLIB reader only reads from the stream for sections, so the
+    // header line can be passed with an unopened stream.
+    std::ifstream no_file;
+    std::string tmp = "EDGE_WEIGHT_TYPE: " + coordinates.edge_weight_type;
+    std::vector<std::string> line = optimizationtools::split(tmp);
+    distances_builder.read_tsplib(no_file, tmp, line);
+    for (CityId city_id = 0;
+            city_id < number_of_cities;
+            ++city_id) {
+        distances_builder.set_coordinates(
+                city_id,
+                coordinates.xs[city_id],
+                coordinates.ys[city_id]);
+    }
+}
+
+}
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -35,6 +36,26 @@ struct Item
     Profit profit;
 };
 
+/**
+ * Structure for a range of item ids stored contiguously.
+ */
+struct ItemIdRange
+{
+    /** Pointer to the first item. */
+    const ItemId* first;
+
+    /** Pointer past the last item. */
+    const ItemId* last;
+
+    inline const ItemId* begin() const { return first; }
+
+    inline const ItemId* end() const { return last; }
+
+    inline ItemId size() const { return last - first; }
+
+    inline ItemId operator[](ItemId pos) const { return first[pos]; }
+};
+
 /**
  * Structure for a city.
  */
@@ -50,9 +71,6 @@ struct City
      */
     Weight weight = 0;
 
-    /** Items available at the city. */
-    std::vector<ItemId> item_ids;
-
     /*
      * Computed attributes
      */
@@ -85,6 +103,36 @@ public:
     /** Get a city. */
     inline const City& city(CityId city_id) const { return cities_[city_id]; }
 
+    /*
+     * Dense city arrays
+     *
+     * The attributes of the cities are also stored field by field, so that
+     * the algorithms which scan the tour only read the data they need.
+     */
+
+    /** Get the distance from the previous city of each city. */
+    inline const std::vector<Distance>& city_distances() const { return city_distances_; }
+
+    /** Get the default weight of each city. */
+    inline const std::vector<Weight>& city_weights() const { return city_weights_; }
+
+    /** Get the distance from the first city of each city. */
+    inline const std::vector<Distance>& city_distances_from_start() const { return city_distances_from_start_; }
+
+    /** Get the distance to the last city of each city. */
+    inline const std::vector<Distance>& city_distances_to_end() const { return city_distances_to_end_; }
+
+    /** Get the city weight from the first city of each city. */
+    inline const std::vector<Weight>& city_weights_from_start() const { return city_weights_from_start_; }
+
+    /** Get the items of a city. */
+    inline ItemIdRange city_item_ids(CityId city_id) const
+    {
+        return {
+            city_item_ids_ + city_item_offsets_[city_id],
+            city_item_ids_ + city_item_offsets_[city_id + 1]};
+    }
+
     /** Get the speed for a given weight. */
     inline double speed(
             Weight weight) const;
@@ -137,6 +185,10 @@ public:
     void write(
             const std::string& instance_path) const;
 
+    /** Write the instance to a file in the binary format. */
+    void write_binary(
+            const std::string& instance_path) const;
+
 private:
 
     /*
@@ -171,6 +223,36 @@ private:
     /** Cities. */
     std::vector<City> cities_;
 
+    /** Distance from the previous city of each city. */
+    std::vector<Distance> city_distances_;
+
+    /** Default weight of each city. */
+    std::vector<Weight> city_weights_;
+
+    /** Distance from the first city of each city. */
+    std::vector<Distance> city_distances_from_start_;
+
+    /** Distance to the last city of each city. */
+    std::vector<Distance> city_distances_to_end_;
+
+    /** City weight from the first city of each city. */
+    std::vector<Weight> city_weights_from_start_;
+
+    /**
+     * Owner of the arrays of the items of the cities.
+     *
+     * For an instance read from a binary file, it is the mapped file and the
+     * arrays point into it. The arrays are never modified, so the copies of
+     * the instance share them.
+     */
+    std::shared_ptr<const void> city_item_arrays_owner_;
+
+    /** For each city, position of its first item in city_item_ids_. */
+    const ItemId* city_item_offsets_ = nullptr;
+
+    /** Items of the cities, sorted by city. */
+    const ItemId* city_item_ids_ = nullptr;
+
     /** Minimum speed. */
     double speed_min_ = -1;
 
@@ -216,7 +298,7 @@ inline Time Instance::duration(
         CityId city_id,
         Weight weight) const
 {
-    return (double)city(city_id).distance / speed(weight);
+    return (double)city_distances_[city_id] / speed(weight);
 }
 
 }
@@ -7,6 +7,8 @@ namespace travellingthiefsolver
 namespace packing_while_travelling
 {
 
+class BinaryInstanceFile;
+
 class InstanceBuilder
 {
 
@@ -86,6 +88,9 @@ private:
     /** Compute weight_from_start for each city. */
     void compute_weight_from_start();
 
+    /** Fill the dense city arrays and the item index of the cities. */
+    void compute_city_arrays();
+
     /*
      * Read input file
      */
@@ -93,6 +98,17 @@ private:
     /** Read an instance from a file in 'polyakovskiy2014' format. */
     void read_polyakovskiy2014(std::ifstream& file);
 
+    /**
+     * Read an instance from a file in 'polyakovskiy2014' format with the
+     * memory-mapped reader.
+     *
+     * Return 'false' if the file is not supported by this reader.
+     */
+    bool read_polyakovskiy2014(const std::string& instance_path);
+
+    /** Read an instance from a file in the binary format. */
+    void read_binary(const std::string& instance_path);
+
     /*
      * Private attributes
      */
@@ -100,6 +116,13 @@ private:
     /** Instance. */
     Instance instance_;
 
+    /**
+     * Binary file the instance has been read from, if it hasn't been modified
+     * since; the item index of the cities of the instance then points into
+     * it.
+     */
+    std::shared_ptr<const BinaryInstanceFile> binary_file_;
+
 };
 
 }
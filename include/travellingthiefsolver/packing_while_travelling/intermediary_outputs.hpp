@@ -0,0 +1,191 @@
+#pragma once
+
+#include "nlohmann/json.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace travellingthiefsolver
+{
+namespace packing_while_travelling
+{
+
+/**
+ * Policy for the history of intermediary outputs of an algorithm.
+ */
+enum class IntermediaryOutputsPolicy
+{
+    /** Keep all the entries. */
+    All,
+
+    /** Keep the last entries. */
+    Last,
+
+    /**
+     * Keep one entry, the last one, per time interval; the bounds of the
+     * intervals grow geometrically.
+     */
+    LogSpaced,
+
+    /** Write the entries to a JSON-lines file instead of keeping them. */
+    Stream,
+
+    /** Don't keep any entry. */
+    None,
+};
+
+inline std::string to_string(IntermediaryOutputsPolicy policy)
+{
+    switch (policy) {
+    case IntermediaryOutputsPolicy::All:
+        return "all";
+    case IntermediaryOutputsPolicy::Last:
+        return "last";
+    case IntermediaryOutputsPolicy::LogSpaced:
+        return "log-spaced";
+    case IntermediaryOutputsPolicy::Stream:
+        return "stream";
+    case IntermediaryOutputsPolicy::None:
+        return "none";
+    }
+    return "";
+}
+
+inline std::ostream& operator<<(
+        std::ostream& os,
+        IntermediaryOutputsPolicy policy)
+{
+    os << to_string(policy);
+    return os;
+}
+
+inline std::istream& operator>>(
+        std::istream& is,
+        IntermediaryOutputsPolicy& policy)
+{
+    std::string s;
+    is >> s;
+    if (s == "all") {
+        policy = IntermediaryOutputsPolicy::All;
+    } else if (s == "last") {
+        policy = IntermediaryOutputsPolicy::Last;
+    } else if (s == "log-spaced") {
+        policy = IntermediaryOutputsPolicy::LogSpaced;
+    } else if (s == "stream") {
+        policy = IntermediaryOutputsPolicy::Stream;
+    } else if (s == "none") {
+        policy = IntermediaryOutputsPolicy::None;
+    } else {
+        is.setstate(std::ios_base::failbit);
+    }
+    return is;
+}
+
+/**
+ * Parameters of the history of intermediary outputs.
+ */
+struct IntermediaryOutputsParameters
+{
+    /** Policy. */
+    IntermediaryOutputsPolicy policy = IntermediaryOutputsPolicy::All;
+
+    /** Number of entries kept with policy 'Last'. */
+    int64_t maximum_number_of_entries = 1000;
+
+    /**
+     * Ratio between the bounds of two consecutive time intervals with policy
+     * 'LogSpaced'.
+     *
+     * The first interval ends at 1 millisecond.
+     */
+    double log_base = 2.0;
+
+    /** Path of the JSON-lines file with policy 'Stream'. */
+    std::string path = "";
+
+
+    nlohmann::json to_json() const
+    {
+        nlohmann::json json = {{"Policy", to_string(policy)}};
+        if (policy == IntermediaryOutputsPolicy::Last)
+            json["MaximumNumberOfEntries"] = maximum_number_of_entries;
+        if (policy == IntermediaryOutputsPolicy::LogSpaced)
+            json["LogBase"] = log_base;
+        if (policy == IntermediaryOutputsPolicy::Stream)
+            json["Path"] = path;
+        return json;
+    }
+
+    void format(
+            std::ostream& os,
+            int width) const;
+
+    /**
+     * Check the parameters.
+     *
+     * With policy 'Stream', throw if the path is empty or if the file can't
+     * be opened for writing, so that the error is reported before the
+     * algorithm starts.
+     */
+    void check() const;
+};
+
+/**
+ * History of the intermediary outputs of an algorithm.
+ *
+ * The entries are stored in the "IntermediaryOutputs" array of the JSON
+ * output of the algorithm, or written to a JSON-lines file, according to the
+ * policy.
+ */
+class IntermediaryOutputs
+{
+
+public:
+
+    /** Constructor. */
+    IntermediaryOutputs(const IntermediaryOutputsParameters& parameters):
+        parameters_(parameters) { }
+
+    /**
+     * Add an entry.
+     *
+     * 'time' is the time of the entry, used by policy 'LogSpaced'.
+     */
+    void add(
+            nlohmann::json& json,
+            nlohmann::json&& entry,
+            double time);
+
+    /**
+     * Write the entries kept with policy 'Last' in the JSON output.
+     *
+     * They are kept in a queue until then, so that dropping the oldest entry
+     * doesn't shift the other ones.
+     */
+    void write(nlohmann::json& json) const;
+
+private:
+
+    /** Get the time interval of an entry with policy 'LogSpaced'. */
+    int64_t interval(double time) const;
+
+    /** Parameters. */
+    const IntermediaryOutputsParameters& parameters_;
+
+    /** Entries kept with policy 'Last', from the oldest one. */
+    std::deque<nlohmann::json> last_entries_;
+
+    /** Time interval of the last entry with policy 'LogSpaced'. */
+    int64_t last_interval_ = -1;
+
+    /** JSON-lines file with policy 'Stream'. */
+    std::unique_ptr<std::ofstream> file_;
+
+};
+
+}
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "travellingthiefsolver/packing_while_travelling/utils.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace travellingthiefsolver
+{
+namespace packing_while_travelling
+{
+
+/**
+ * Iterative beam search driving the branching scheme of a tree search
+ * algorithm.
+ *
+ * Beams of growing width are run until a beam is not truncated, which means
+ * that the search has been completed, or until 'needs_to_end' returns true.
+ * The nodes of a level are ranked with the guide of the branching scheme and
+ * at most 'width' of them are kept, so that the memory used is bounded by the
+ * width of the beam.
+ *
+ * The nodes of the branching scheme must contain the fields
+ * 'last_visited_city_id' and 'last_visited_city_state_id'. The branching
+ * scheme must provide a method 'reset(nodes)', called at the start of each
+ * level, which may drop everything it stores about the nodes created so far
+ * except the given ones. The paths of the nodes are kept by this function.
+ *
+ * 'new_solution_callback' is called at the end of each beam during which the
+ * incumbent has been improved, with the incumbent, its path (except the first
+ * city) and the width of the beam.
+ *
+ * Return 'true' iff the search has been completed.
+ */
+template <typename BranchingScheme>
+bool iterative_beam_search(
+        const BranchingScheme& branching_scheme,
+        Counter minimum_size_of_the_queue,
+        Counter maximum_size_of_the_queue,
+        double growth_factor,
+        const std::function<bool()>& needs_to_end,
+        const std::function<void(
+            const std::shared_ptr<typename BranchingScheme::Node>&,
+            const std::vector<std::pair<CityId, CityStateId>>&,
+            Counter)>& new_solution_callback);
+
+}
+}
+
+template <typename BranchingScheme>
+bool travellingthiefsolver::packing_while_travelling::iterative_beam_search(
+        const BranchingScheme& branching_scheme,
+        Counter minimum_size_of_the_queue,
+        Counter maximum_size_of_the_queue,
+        double growth_factor,
+        const std::function<bool()>& needs_to_end,
+        const std::function<void(
+            const std::shared_ptr<typename BranchingScheme::Node>&,
+            const std::vector<std::pair<CityId, CityStateId>>&,
+            Counter)>& new_solution_callback)
+{
+    using NodePtr = std::shared_ptr<typename BranchingScheme::Node>;
+
+    /**
+     * Structure recording how a node kept in a level has been reached.
+     */
+    struct PathElement
+    {
+        /** Position of the parent in the previous level; -1 for the root. */
+        Counter parent_pos;
+
+        /** Last visited city. */
+        CityId city_id;
+
+        /** State of the last visited city. */
+        CityStateId city_state_id;
+    };
+
+    // Get the path of a node from the path elements of the levels.
+    auto path = [](
+            const std::vector<std::vector<PathElement>>& path_elements,
+            Counter level,
+            Counter pos)
+    {
+        std::vector<std::pair<CityId, CityStateId>> cities;
+        for (; level > 0; --level) {
+            const PathElement& path_element = path_elements[level][pos];
+            cities.push_back({path_element.city_id, path_element.city_state_id});
+            pos = path_element.parent_pos;
+        }
+        std::reverse(cities.begin(), cities.end());
+        return cities;
+    };
+
+    // The front of the heap of the next level is its worst node.
+    auto heap_comparator = [&branching_scheme](
+            const std::pair<NodePtr, Counter>& node_1,
+            const std::pair<NodePtr, Counter>& node_2)
+    {
+        return branching_scheme(node_1.first, node_2.first);
+    };
+
+    // As in the tree search algorithms, the root is the first incumbent; the
+    // 'better' method of the branching scheme decides which nodes correspond
+    // to feasible solutions.
+    NodePtr incumbent = branching_scheme.root();
+    std::vector<std::pair<CityId, CityStateId>> incumbent_path;
+    for (Counter width = minimum_size_of_the_queue;;) {
+        bool truncated = false;
+        bool improved = false;
+
+        std::vector<std::vector<PathElement>> path_elements = {{{-1, 0, -1}}};
+        std::vector<NodePtr> nodes = {branching_scheme.root()};
+        std::vector<std::pair<NodePtr, Counter>> next_nodes;
+        for (Counter level = 0; !nodes.empty(); ++level) {
+            if (needs_to_end())
+                break;
+            branching_scheme.reset(nodes);
+
+            next_nodes.clear();
+            for (Counter pos = 0; pos < (Counter)nodes.size(); ++pos) {
+                const NodePtr& node = nodes[pos];
+                while (!branching_scheme.infertile(node)) {
+                    if (branching_scheme.bound(node, incumbent))
+                        break;
+                    NodePtr child = branching_scheme.next_child(node);
+                    if (child == nullptr)
+                        continue;
+
+                    if (branching_scheme.better(child, incumbent)) {
+                        incumbent = child;
+                        incumbent_path = path(path_elements, level, pos);
+                        incumbent_path.push_back({
+                                child->last_visited_city_id,
+                                child->last_visited_city_state_id});
+                        improved = true;
+                    }
+
+                    if (branching_scheme.leaf(child)
+                            || branching_scheme.bound(child, incumbent)) {
+                        continue;
+                    }
+
+                    // Add the child to the next level.
+                    if ((Counter)next_nodes.size() < width) {
+                        next_nodes.push_back({child, pos});
+                        std::push_heap(next_nodes.begin(), next_nodes.end(), heap_comparator);
+                    } else {
+                        truncated = true;
+                        if (branching_scheme(child, next_nodes.front().first)) {
+                            std::pop_heap(next_nodes.begin(), next_nodes.end(), heap_comparator);
+                            next_nodes.back() = {child, pos};
+                            std::push_heap(next_nodes.begin(), next_nodes.end(), heap_comparator);
+                        }
+                    }
+                }
+            }
+
+            // Move to the next level.
+            nodes.clear();
+            path_elements.push_back({});
+            for (const auto& p: next_nodes) {
+                nodes.push_back(p.first);
+                path_elements.back().push_back({
+                        p.second,
+                        p.first->last_visited_city_id,
+                        p.first->last_visited_city_state_id});
+            }
+        }
+
+        if (improved)
+            new_solution_callback(incumbent, incumbent_path, width);
+        if (needs_to_end())
+            return false;
+        if (!truncated)
+            return true;
+
+        // Increase the width of the beam.
+        if (width >= maximum_size_of_the_queue)
+            return false;
+        width = (std::min)(
+                maximum_size_of_the_queue,
+                (std::max)(width + 1, (Counter)(width * growth_factor)));
+    }
+}
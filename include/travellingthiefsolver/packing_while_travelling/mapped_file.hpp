@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace travellingthiefsolver
+{
+namespace packing_while_travelling
+{
+
+/**
+ * Read-only memory mapping of a whole file.
+ */
+class MappedFile
+{
+
+public:
+
+    /** Constructor. */
+    MappedFile(const std::string& path);
+
+    /** Destructor. */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /** Get a pointer to the first character of the file. */
+    const char* begin() const { return data_; }
+
+    /** Get a pointer past the last character of the file. */
+    const char* end() const { return data_ + size_; }
+
+    /** Get the size of the file. */
+    std::size_t size() const { return size_; }
+
+private:
+
+    /** Content of the file. */
+    const char* data_ = nullptr;
+
+    /** Size of the file. */
+    std::size_t size_ = 0;
+
+#ifdef _WIN32
+    /** Handle of the file. */
+    void* file_ = nullptr;
+
+    /** Handle of the mapping. */
+    void* mapping_ = nullptr;
+#else
+    /** File descriptor. */
+    int file_descriptor_ = -1;
+#endif
+
+};
+
+}
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace travellingthiefsolver
+{
+namespace packing_while_travelling
+{
+
+/**
+ * Memory pool for blocks of a few different sizes.
+ *
+ * Blocks are carved from large chunks. Freed blocks are kept in a free list
+ * per size and reused; the chunks are only returned to the system when the
+ * pool is destroyed.
+ *
+ * By default, the pool is not thread-safe. If it is built synchronized, its
+ * accesses are protected by a mutex so that it can be shared between
+ * threads.
+ */
+class MemoryPool
+{
+
+public:
+
+    /** Constructor. */
+    MemoryPool(
+            std::size_t chunk_size = (1 << 20),
+            bool synchronized = false):
+        chunk_size_(chunk_size),
+        mutex_((synchronized)? new std::mutex(): nullptr) { }
+
+    /** Allocate a block. */
+    inline void* allocate(std::size_t size)
+    {
+        std::unique_lock<std::mutex> lock;
+        if (mutex_ != nullptr)
+            lock = std::unique_lock<std::mutex>(*mutex_);
+        size = block_size(size);
+        SizeClass& size_class = this->size_class(size);
+        if (size_class.free_blocks != nullptr) {
+            FreeBlock* block = size_class.free_blocks;
+            size_class.free_blocks = block->next;
+            return block;
+        }
+        if (chunk_remaining_size_ < size) {
+            std::size_t chunk_size = (std::max)(chunk_size_, size);
+            chunks_.push_back(std::unique_ptr<char[]>(new char[chunk_size]));
+            chunk_current_ = chunks_.back().get();
+            chunk_remaining_size_ = chunk_size;
+            number_of_bytes_ += chunk_size;
+        }
+        void* block = chunk_current_;
+        chunk_current_ += size;
+        chunk_remaining_size_ -= size;
+        return block;
+    }
+
+    /** Return a block to the pool. */
+    inline void deallocate(void* pointer, std::size_t size)
+    {
+        std::unique_lock<std::mutex> lock;
+        if (mutex_ != nullptr)
+            lock = std::unique_lock<std::mutex>(*mutex_);
+        SizeClass& size_class = this->size_class(block_size(size));
+        FreeBlock* block = static_cast<FreeBlock*>(pointer);
+        block->next = size_class.free_blocks;
+        size_class.free_blocks = block;
+    }
+
+    /** Get the number of bytes reserved by the pool. */
+    inline std::size_t number_of_bytes() const { return number_of_bytes_; }
+
+private:
+
+    /** Structure for a free block. */
+    struct FreeBlock
+    {
+        /** Next free block. */
+        FreeBlock* next;
+    };
+
+    /** Structure for the free blocks of a given size. */
+    struct SizeClass
+    {
+        /** Size of the blocks. */
+        std::size_t size;
+
+        /** First free block. */
+        FreeBlock* free_blocks = nullptr;
+    };
+
+    /** Round a size up to the alignment of the blocks. */
+    static inline std::size_t block_size(std::size_t size)
+    {
+        const std::size_t alignment = alignof(std::max_align_t);
+        size = (std::max)(size, sizeof(FreeBlock));
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    /** Get the free blocks of a given size. */
+    inline SizeClass& size_class(std::size_t size)
+    {
+        for (SizeClass& size_class: size_classes_)
+            if (size_class.size == size)
+                return size_class;
+        size_classes_.push_back(SizeClass());
+        size_classes_.back().size = size;
+        return size_classes_.back();
+    }
+
+    /** Size of the chunks. */
+    std::size_t chunk_size_;
+
+    /** Chunks. */
+    std::vector<std::unique_ptr<char[]>> chunks_;
+
+    /** Current position in the last chunk. */
+    char* chunk_current_ = nullptr;
+
+    /** Remaining size in the last chunk. */
+    std::size_t chunk_remaining_size_ = 0;
+
+    /** Free blocks of each size. */
+    std::vector<SizeClass> size_classes_;
+
+    /** Number of bytes reserved. */
+    std::size_t number_of_bytes_ = 0;
+
+    /** Mutex; 'nullptr' if the pool is not synchronized. */
+    std::unique_ptr<std::mutex> mutex_;
+
+};
+
+/**
+ * Allocator using a memory pool for single objects.
+ *
+ * The allocator shares the ownership of the pool, so that the pool outlives
+ * all the objects allocated from it.
+ */
+template <typename T>
+class PoolAllocator
+{
+
+public:
+
+    using value_type = T;
+
+    /** Constructor. */
+    PoolAllocator(const std::shared_ptr<MemoryPool>& pool):
+        pool_(pool) { }
+
+    /** Constructor from an allocator of another type. */
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& allocator):
+        pool_(allocator.pool()) { }
+
+    /** Allocate objects. */
+    inline T* allocate(std::size_t n)
+    {
+        if (n != 1)
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        return static_cast<T*>(pool_->allocate(sizeof(T)));
+    }
+
+    /** Deallocate objects. */
+    inline void deallocate(T* pointer, std::size_t n)
+    {
+        if (n != 1) {
+            ::operator delete(pointer);
+            return;
+        }
+        pool_->deallocate(pointer, sizeof(T));
+    }
+
+    /** Get the pool. */
+    inline const std::shared_ptr<MemoryPool>& pool() const { return pool_; }
+
+    template <typename U>
+    inline bool operator==(const PoolAllocator<U>& allocator) const { return pool_ == allocator.pool(); }
+
+    template <typename U>
+    inline bool operator!=(const PoolAllocator<U>& allocator) const { return pool_ != allocator.pool(); }
+
+private:
+
+    /** Pool. */
+    std::shared_ptr<MemoryPool> pool_;
+
+};
+
+}
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "travellingthiefsolver/packing_while_travelling/instance.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace travellingthiefsolver
+{
+namespace packing_while_travelling
+{
+
+/**
+ * Parallel multi-start local search with an elite pool.
+ *
+ * Each thread works on its own copy of 'local_scheme' and its own random
+ * generator, seeded from 'generator'; the local scheme must therefore only
+ * share read-only data between copies. Threads repeatedly:
+ * - build a new initial solution during the first 'elite_pool_size' local
+ *   searches;
+ * - otherwise, with probability 'crossover_probability', cross two random
+ *   elite solutions over, or else apply a random perturbation to a random
+ *   elite solution;
+ * - run the local search on the result and insert it into the elite pool.
+ *
+ * The elite pool keeps the 'elite_pool_size' best solutions with pairwise
+ * different global costs.
+ *
+ * 'new_solution_callback' is called, one thread at a time, each time the best
+ * solution of the pool is improved, with the new best solution and the number
+ * of the local search which found it.
+ *
+ * The search stops when 'needs_to_end' returns true or after
+ * 'maximum_number_of_iterations' local searches if it is non-negative.
+ *
+ * Return the number of local searches performed.
+ */
+template <typename LocalScheme>
+Counter multi_start_local_search(
+        const LocalScheme& local_scheme,
+        std::mt19937_64& generator,
+        Counter number_of_threads,
+        Counter elite_pool_size,
+        double crossover_probability,
+        Counter maximum_number_of_iterations,
+        const std::function<bool()>& needs_to_end,
+        const std::function<void(
+            const typename LocalScheme::Solution&,
+            Counter)>& new_solution_callback);
+
+}
+}
+
+template <typename LocalScheme>
+travellingthiefsolver::packing_while_travelling::Counter travellingthiefsolver::packing_while_travelling::multi_start_local_search(
+        const LocalScheme& local_scheme,
+        std::mt19937_64& generator,
+        Counter number_of_threads,
+        Counter elite_pool_size,
+        double crossover_probability,
+        Counter maximum_number_of_iterations,
+        const std::function<bool()>& needs_to_end,
+        const std::function<void(
+            const typename LocalScheme::Solution&,
+            Counter)>& new_solution_callback)
+{
+    using Solution = typename LocalScheme::Solution;
+    using GlobalCost = decltype(std::declval<LocalScheme&>().global_cost(std::declval<const Solution&>()));
+
+    if (number_of_threads < 1)
+        number_of_threads = 1;
+    if (elite_pool_size < 1)
+        elite_pool_size = 1;
+
+    // Elite pool, sorted by increasing global cost.
+    std::vector<std::pair<GlobalCost, Solution>> elite_pool;
+    std::mutex elite_pool_mutex;
+    std::atomic<Counter> iteration_next(0);
+
+    // Insert a solution in the elite pool.
+    auto insert = [&elite_pool, &elite_pool_mutex, elite_pool_size, &new_solution_callback](
+            const GlobalCost& global_cost,
+            const Solution& solution,
+            Counter iteration)
+    {
+        std::lock_guard<std::mutex> lock(elite_pool_mutex);
+        auto it = std::lower_bound(
+                elite_pool.begin(),
+                elite_pool.end(),
+                global_cost,
+                [](const std::pair<GlobalCost, Solution>& p, const GlobalCost& c) { return p.first < c; });
+        if (it != elite_pool.end() && it->first == global_cost)
+            return;
+        // Removing the worst solution invalidates 'it'.
+        auto pos = it - elite_pool.begin();
+        if ((Counter)elite_pool.size() >= elite_pool_size) {
+            if (it == elite_pool.end())
+                return;
+            elite_pool.pop_back();
+        }
+        bool improved = (pos == 0);
+        elite_pool.insert(elite_pool.begin() + pos, {global_cost, solution});
+        if (improved)
+            new_solution_callback(solution, iteration);
+    };
+
+    auto worker = [&](
+            std::mt19937_64::result_type seed)
+    {
+        LocalScheme local_scheme_thread(local_scheme);
+        std::mt19937_64 generator_thread(seed);
+        std::uniform_real_distribution<double> d_crossover(0, 1);
+        for (;;) {
+            if (needs_to_end())
+                break;
+            Counter iteration = iteration_next.fetch_add(1);
+            if (maximum_number_of_iterations >= 0
+                    && iteration >= maximum_number_of_iterations) {
+                break;
+            }
+
+            // Select the parents.
+            std::vector<Solution> parents;
+            {
+                std::lock_guard<std::mutex> lock(elite_pool_mutex);
+                Counter size = elite_pool.size();
+                if (size >= 1 && iteration >= elite_pool_size) {
+                    std::uniform_int_distribution<Counter> d_parent_1(0, size - 1);
+                    Counter pos_1 = d_parent_1(generator_thread);
+                    parents.push_back(elite_pool[pos_1].second);
+                    if (size >= 2
+                            && d_crossover(generator_thread) < crossover_probability) {
+                        std::uniform_int_distribution<Counter> d_parent_2(0, size - 2);
+                        Counter pos_2 = d_parent_2(generator_thread);
+                        if (pos_2 >= pos_1)
+                            pos_2++;
+                        parents.push_back(elite_pool[pos_2].second);
+                    }
+                }
+            }
+
+            // Generate and improve the new solution.
+            Solution solution = (parents.empty())?
+                local_scheme_thread.initial_solution(iteration, generator_thread):
+                parents[0];
+            if (parents.size() == 2) {
+                solution = local_scheme_thread.crossover(
+                        parents[0],
+                        parents[1],
+                        generator_thread);
+                local_scheme_thread.local_search(solution, generator_thread);
+            } else if (parents.size() == 1) {
+                auto perturbations = local_scheme_thread.perturbations(
+                        solution,
+                        generator_thread);
+                if (perturbations.empty()) {
+                    solution = local_scheme_thread.initial_solution(
+                            iteration,
+                            generator_thread);
+                    local_scheme_thread.local_search(solution, generator_thread);
+                } else {
+                    std::uniform_int_distribution<Counter> d_perturbation(
+                            0, perturbations.size() - 1);
+                    const auto& perturbation = perturbations[d_perturbation(generator_thread)];
+                    local_scheme_thread.apply_perturbation(
+                            solution,
+                            perturbation,
+                            generator_thread);
+                    local_scheme_thread.local_search(
+                            solution,
+                            generator_thread,
+                            perturbation);
+                }
+            } else {
+                local_scheme_thread.local_search(solution, generator_thread);
+            }
+            insert(local_scheme_thread.global_cost(solution), solution, iteration);
+        }
+    };
+
+    // Each thread gets its own random stream.
+    std::vector<std::mt19937_64::result_type> seeds(number_of_threads);
+    for (Counter thread_id = 0; thread_id < number_of_threads; ++thread_id)
+        seeds[thread_id] = generator();
+    std::vector<std::thread> threads;
+    for (Counter thread_id = 1; thread_id < number_of_threads; ++thread_id)
+        threads.push_back(std::thread(worker, seeds[thread_id]));
+    worker(seeds[0]);
+    for (std::thread& thread: threads)
+        thread.join();
+
+    Counter number_of_iterations = iteration_next;
+    if (maximum_number_of_iterations >= 0
+            && number_of_iterations > maximum_number_of_iterations) {
+        number_of_iterations = maximum_number_of_iterations;
+    }
+    return number_of_iterations;
+}
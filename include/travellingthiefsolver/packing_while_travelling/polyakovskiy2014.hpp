@@ -0,0 +1,92 @@
+#pragma once
+
+#include "travellingthiefsolver/packing_while_travelling/instance.hpp"
+
+namespace travellingthiefsolver
+{
+namespace packing_while_travelling
+{
+
+/**
+ * Content of a file in 'polyakovskiy2014' format.
+ *
+ * The same format, with small variations, is used by the four problems:
+ * - 'NODE_COORD_SECTION' (travelling thief, thief orienteering and
+ *   travelling while packing) contains the coordinates of the cities;
+ * - 'EDGE_WEIGHT_SECTION' without 'EDGE_WEIGHT_TYPE' (packing while
+ *   travelling) contains the distance from each city to the next one;
+ * - 'WEIGHTS SECTION' (travelling while packing) contains the weight of each
+ *   city;
+ * - 'ITEMS SECTION' contains the items.
+ */
+struct Polyakovskiy2014File
+{
+    /** Number of cities, from the 'DIMENSION' entry. */
+    CityId number_of_cities = -1;
+
+    /** Number of items, from the 'NUMBER OF ITEMS' entry. */
+    ItemId number_of_items = -1;
+
+    /** Capacity of the knapsack. */
+    Weight capacity = -1;
+
+    /** Time limit, from the 'MAX TIME' entry. */
+    Time time_limit = -1;
+
+    /** Minimum speed. */
+    double minimum_speed = -1;
+
+    /** Maximum speed. */
+    double maximum_speed = -1;
+
+    /** Renting ratio. */
+    double renting_ratio = 1.0;
+
+    /**
+     * Header lines which are not specific to the format, for example
+     * 'EDGE_WEIGHT_TYPE'; they are meant to be passed to a TSPLIB reader.
+     */
+    std::vector<std::string> tsplib_lines;
+
+    /** Value of the 'EDGE_WEIGHT_TYPE' entry; empty if absent. */
+    std::string edge_weight_type;
+
+    /** x-coordinates of the cities. */
+    std::vector<double> xs;
+
+    /** y-coordinates of the cities. */
+    std::vector<double> ys;
+
+    /** Distance from each city to the next one. */
+    std::vector<Distance> city_distances;
+
+    /** Weights of the cities. */
+    std::vector<Weight> city_weights;
+
+    /** Cities of the items. */
+    std::vector<CityId> item_city_ids;
+
+    /** Weights of the items. */
+    std::vector<Weight> item_weights;
+
+    /** Profits of the items. */
+    std::vector<Profit> item_profits;
+};
+
+/**
+ * Read a file in 'polyakovskiy2014' format.
+ *
+ * The file is memory-mapped and read in a single pass; numbers are parsed
+ * in place and the arrays are reserved from the 'DIMENSION' and
+ * 'NUMBER OF ITEMS' entries.
+ *
+ * Return 'false' if the file contains a section which is not supported by
+ * this reader, for example an explicit distance matrix; the caller should
+ * then fall back to a stream-based reader.
+ */
+bool read_polyakovskiy2014(
+        const std::string& instance_path,
+        Polyakovskiy2014File& file);
+
+}
+}
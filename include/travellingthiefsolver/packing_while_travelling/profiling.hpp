@@ -0,0 +1,177 @@
+#pragma once
+
+#include "nlohmann/json.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace travellingthiefsolver
+{
+namespace packing_while_travelling
+{
+namespace profiling
+{
+
+/**
+ * Registry of timers and counters used to profile the algorithms.
+ *
+ * Each thread accumulates its measures in its own thread-local slots, with
+ * relaxed atomic loads and stores only, so the hot path takes no lock. The
+ * slots of the threads are summed when a snapshot is taken; the slots of the
+ * threads which have ended are kept in a global total.
+ *
+ * The instrumentation is enabled by the 'TRAVELLINGTHIEFSOLVER_PROFILING'
+ * preprocessor definition, set by the CMake option of the same name; without
+ * it, the macros below expand to nothing.
+ */
+
+#ifdef TRAVELLINGTHIEFSOLVER_PROFILING
+constexpr bool enabled = true;
+#else
+constexpr bool enabled = false;
+#endif
+
+/** Maximum number of timers and counters. */
+constexpr int maximum_number_of_entries = 256;
+
+/**
+ * Get the id of a timer or counter from its name, registering it at the
+ * first call.
+ *
+ * Return -1 if there are already 'maximum_number_of_entries' entries; the
+ * measures of this entry are then ignored.
+ */
+int register_entry(const char* name);
+
+/**
+ * Slots of a thread.
+ */
+struct ThreadEntries
+{
+    /** Constructor; register the slots of the thread. */
+    ThreadEntries();
+
+    /** Destructor; move the measures to the global total. */
+    ~ThreadEntries();
+
+    /** Accumulated time of each entry, in nanoseconds. */
+    std::atomic<int64_t> times[maximum_number_of_entries];
+
+    /** Number of calls or count of each entry. */
+    std::atomic<int64_t> counts[maximum_number_of_entries];
+
+    /** Add a measure; only called by the owning thread. */
+    inline void add(
+            int entry_id,
+            int64_t time,
+            int64_t count)
+    {
+        if (entry_id < 0)
+            return;
+        times[entry_id].store(
+                times[entry_id].load(std::memory_order_relaxed) + time,
+                std::memory_order_relaxed);
+        counts[entry_id].store(
+                counts[entry_id].load(std::memory_order_relaxed) + count,
+                std::memory_order_relaxed);
+    }
+};
+
+/** Get the slots of the current thread. */
+inline ThreadEntries& thread_entries()
+{
+    thread_local ThreadEntries entries;
+    return entries;
+}
+
+/**
+ * Timer measuring the time spent in a scope.
+ */
+class ScopedTimer
+{
+
+public:
+
+    /** Constructor. */
+    explicit ScopedTimer(int entry_id):
+        entry_id_(entry_id),
+        start_(std::chrono::steady_clock::now()) { }
+
+    /** Destructor. */
+    ~ScopedTimer()
+    {
+        auto end = std::chrono::steady_clock::now();
+        thread_entries().add(
+                entry_id_,
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_).count(),
+                1);
+    }
+
+private:
+
+    /** Id of the entry. */
+    int entry_id_;
+
+    /** Start time. */
+    std::chrono::steady_clock::time_point start_;
+
+};
+
+/**
+ * Totals of all the entries at a given time.
+ */
+struct Snapshot
+{
+    /** Accumulated time of each entry, in nanoseconds. */
+    std::vector<int64_t> times;
+
+    /** Count of each entry. */
+    std::vector<int64_t> counts;
+};
+
+/** Take a snapshot of the totals over all the threads. */
+Snapshot snapshot();
+
+/**
+ * Export the measures accumulated since a snapshot to a JSON structure.
+ *
+ * Entries without measures are omitted. Measures of other algorithms running
+ * concurrently in the same process are included.
+ */
+nlohmann::json to_json(const Snapshot& start);
+
+}
+}
+}
+
+#define TRAVELLINGTHIEFSOLVER_PROFILING_CONCAT_(a, b) a##b
+#define TRAVELLINGTHIEFSOLVER_PROFILING_CONCAT(a, b) TRAVELLINGTHIEFSOLVER_PROFILING_CONCAT_(a, b)
+
+#ifdef TRAVELLINGTHIEFSOLVER_PROFILING
+
+/** Measure the time spent until the end of the current scope. */
+#define PROFILING_SCOPE(name) \
+    static const int TRAVELLINGTHIEFSOLVER_PROFILING_CONCAT(profiling_entry_id_, __LINE__) \
+        = ::travellingthiefsolver::packing_while_travelling::profiling::register_entry(name); \
+    ::travellingthiefsolver::packing_while_travelling::profiling::ScopedTimer \
+        TRAVELLINGTHIEFSOLVER_PROFILING_CONCAT(profiling_timer_, __LINE__)( \
+                TRAVELLINGTHIEFSOLVER_PROFILING_CONCAT(profiling_entry_id_, __LINE__))
+
+/** Increment a counter. */
+#define PROFILING_COUNT(name, value) \
+    do { \
+        static const int profiling_entry_id \
+            = ::travellingthiefsolver::packing_while_travelling::profiling::register_entry(name); \
+        ::travellingthiefsolver::packing_while_travelling::profiling::thread_entries().add( \
+                profiling_entry_id, 0, (value)); \
+    } while (false)
+
+#else
+
+#define PROFILING_SCOPE(name)
+#define PROFILING_COUNT(name, value) do { (void)sizeof(value); } while (false)
+
+#endif
@@ -61,6 +61,10 @@ public:
     void write(
             const std::string& certificate_path) const;
 
+    /** Write the solution to a stream. */
+    void write(
+            std::ostream& os) const;
+
     /** Export solution characteristics to a JSON structure. */
     nlohmann::json to_json() const;
 
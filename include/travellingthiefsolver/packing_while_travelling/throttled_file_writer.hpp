@@ -0,0 +1,172 @@
+#pragma once
+
+#include "nlohmann/json.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace travellingthiefsolver
+{
+namespace packing_while_travelling
+{
+
+/**
+ * Writer of output files in a background thread.
+ *
+ * The caller submits a function building the files each time their contents
+ * change; the background thread builds and writes them at most once per
+ * minimum interval while the algorithm continues. Submissions made before
+ * the previous one has been written replace it, so that only the latest
+ * contents are built and written, but they are never dropped: they are
+ * written once the interval since the previous write has elapsed.
+ *
+ * The building function runs in the background thread, so it must only use
+ * data it owns, for example a copy of the solution.
+ *
+ * Each file is first written to a temporary file which is then renamed, so
+ * that a reader never sees a partially written file.
+ */
+class ThrottledFileWriter
+{
+
+public:
+
+    /** Content of a file to write. */
+    struct File
+    {
+        /** Path of the file. */
+        std::string path;
+
+        /** Content of the file. */
+        std::string content;
+    };
+
+    /** Function building the files to write. */
+    using FilesBuilder = std::function<std::vector<File>()>;
+
+    /** Constructor. */
+    ThrottledFileWriter(double minimum_interval);
+
+    /** Destructor; write the pending files and stop the thread. */
+    ~ThrottledFileWriter();
+
+    /** Submit a function building the files to write. */
+    void submit(FilesBuilder build_files);
+
+    /**
+     * Write the submitted files without waiting for the end of the minimum
+     * interval, and wait until they have been written.
+     */
+    void flush();
+
+private:
+
+    /** Main function of the background thread. */
+    void run();
+
+    /** Minimum interval between two writes, in seconds. */
+    double minimum_interval_;
+
+    /** Time of the last write. */
+    std::chrono::steady_clock::time_point last_write_time_;
+
+    /** 'true' iff files have been written. */
+    bool has_written_ = false;
+
+    /** Function building the files waiting to be written. */
+    FilesBuilder pending_files_builder_;
+
+    /** 'true' iff 'pending_files_builder_' hasn't been called yet. */
+    bool has_pending_files_ = false;
+
+    /** 'true' iff the background thread is writing files. */
+    bool writing_ = false;
+
+    /** Number of calls to 'flush' waiting for the files to be written. */
+    int number_of_flushes_ = 0;
+
+    /** 'true' iff the background thread must stop. */
+    bool stop_ = false;
+
+    /** Mutex. */
+    mutable std::mutex mutex_;
+
+    /** Condition variable. */
+    std::condition_variable condition_;
+
+    /** Background thread. */
+    std::thread thread_;
+
+};
+
+/**
+ * Create a new solution callback writing the JSON output and the certificate
+ * through a throttled file writer.
+ *
+ * The callback only copies the solution, the scalar metrics and the
+ * parameters; the files are built in the background thread of the writer.
+ * Thus, the intermediate JSON output contains the parameters and the output,
+ * but not the history of the intermediary outputs, which is only written at
+ * the end.
+ *
+ * The writer is owned by the callback: the pending files are written when
+ * the last copy of the callback is destroyed.
+ */
+template <typename Output>
+std::function<void(const Output&, const std::string&)> throttled_new_solution_callback(
+        const std::string& json_output_path,
+        const std::string& certificate_path,
+        double minimum_interval)
+{
+    auto writer = std::make_shared<ThrottledFileWriter>(minimum_interval);
+    return [
+        writer,
+        json_output_path,
+        certificate_path](
+                const Output& output,
+                const std::string&)
+    {
+        using Solution = typename std::decay<decltype(output.solution)>::type;
+        auto solution = std::make_shared<const Solution>(output.solution);
+        nlohmann::json metrics = output.metrics_to_json();
+        auto parameters_it = output.json.find("Parameters");
+        nlohmann::json parameters = (parameters_it != output.json.end())?
+            *parameters_it: nlohmann::json::object();
+        writer->submit([
+                json_output_path,
+                certificate_path,
+                solution,
+                metrics,
+                parameters]()
+        {
+            std::vector<ThrottledFileWriter::File> files;
+            if (!json_output_path.empty()) {
+                nlohmann::json json_output = {
+                    {"Parameters", parameters},
+                    {"Output", metrics}};
+                json_output["Output"]["Solution"] = solution->to_json();
+                std::ostringstream json;
+                json << std::setw(4) << json_output << std::endl;
+                files.push_back({json_output_path, json.str()});
+            }
+            if (!certificate_path.empty()) {
+                std::ostringstream certificate;
+                solution->write(certificate);
+                files.push_back({certificate_path, certificate.str()});
+            }
+            return files;
+        });
+    };
+}
+
+}
+}
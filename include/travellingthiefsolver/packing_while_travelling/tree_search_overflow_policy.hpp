@@ -0,0 +1,72 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+namespace travellingthiefsolver
+{
+namespace packing_while_travelling
+{
+
+/**
+ * Policy applied when a tree search reaches its node or memory budget.
+ */
+enum class TreeSearchOverflowPolicy
+{
+    /** Stop the search and keep the best solution found. */
+    Stop,
+
+    /**
+     * Stop the best-first search and continue with an iterative beam search
+     * whose queue fits in the budget.
+     */
+    IterativeBeamSearch,
+
+    /**
+     * Drop the worst half of the queue and continue; the search is not exact
+     * anymore.
+     */
+    PurgeQueue,
+};
+
+inline std::string to_string(TreeSearchOverflowPolicy overflow_policy)
+{
+    switch (overflow_policy) {
+    case TreeSearchOverflowPolicy::Stop:
+        return "stop";
+    case TreeSearchOverflowPolicy::IterativeBeamSearch:
+        return "iterative-beam-search";
+    case TreeSearchOverflowPolicy::PurgeQueue:
+        return "purge-queue";
+    }
+    return "";
+}
+
+inline std::ostream& operator<<(
+        std::ostream& os,
+        TreeSearchOverflowPolicy overflow_policy)
+{
+    os << to_string(overflow_policy);
+    return os;
+}
+
+inline std::istream& operator>>(
+        std::istream& is,
+        TreeSearchOverflowPolicy& overflow_policy)
+{
+    std::string s;
+    is >> s;
+    if (s == "stop") {
+        overflow_policy = TreeSearchOverflowPolicy::Stop;
+    } else if (s == "iterative-beam-search") {
+        overflow_policy = TreeSearchOverflowPolicy::IterativeBeamSearch;
+    } else if (s == "purge-queue") {
+        overflow_policy = TreeSearchOverflowPolicy::PurgeQueue;
+    } else {
+        is.setstate(std::ios_base::failbit);
+    }
+    return is;
+}
+
+}
+}
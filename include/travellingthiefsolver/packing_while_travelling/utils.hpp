@@ -1,6 +1,14 @@
 #pragma once
 
 #include "travellingthiefsolver/packing_while_travelling/instance.hpp"
+#include "travellingthiefsolver/packing_while_travelling/profiling.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
 
 namespace travellingthiefsolver
 {
@@ -33,8 +41,190 @@ struct CityState
     }
 };
 
+/**
+ * Class storing the states of all cities in flat arrays.
+ *
+ * The states of city j are stored contiguously at positions
+ * city_offsets_[j], ..., city_offsets_[j + 1] - 1, and the items of the state
+ * at position k are stored in the item pool at positions item_offsets_[k],
+ * ..., item_offsets_[k + 1] - 1.
+ *
+ * Weights and profits are stored in separate arrays so that the evaluation of
+ * the moves only reads dense numerical data.
+ */
+class CityStateTable
+{
+
+public:
+
+    /**
+     * Structure for the weight and the profit of a city state.
+     */
+    struct State
+    {
+        /** Weight of the state. */
+        Weight total_weight;
+
+        /** Profit of the state. */
+        Profit total_profit;
+    };
+
+    /*
+     * Constructors and destructor
+     */
+
+    /** Create an empty table. */
+    CityStateTable() { }
+
+    /** Create a table from the states of each city. */
+    inline CityStateTable(
+            const std::vector<std::vector<CityState>>& city_states);
+
+    /*
+     * Getters
+     */
+
+    /** Get the number of cities. */
+    inline CityId number_of_cities() const { return city_offsets_.size() - 1; }
+
+    /** Get the number of states of a city. */
+    inline CityStateId number_of_states(CityId city_id) const
+    {
+        return city_offsets_[city_id + 1] - city_offsets_[city_id];
+    }
+
+    /** Get the total weight of a city state. */
+    inline Weight total_weight(
+            CityId city_id,
+            CityStateId city_state_id) const
+    {
+        return total_weights_[city_offsets_[city_id] + city_state_id];
+    }
+
+    /** Get the total profit of a city state. */
+    inline Profit total_profit(
+            CityId city_id,
+            CityStateId city_state_id) const
+    {
+        return total_profits_[city_offsets_[city_id] + city_state_id];
+    }
+
+    /** Get the weight and the profit of a city state. */
+    inline State state(
+            CityId city_id,
+            CityStateId city_state_id) const
+    {
+        CityStateId pos = city_offsets_[city_id] + city_state_id;
+        return {total_weights_[pos], total_profits_[pos]};
+    }
+
+    /**
+     * Get the total weight of the last state of a city.
+     *
+     * The last state is the heaviest and the most profitable one.
+     */
+    inline Weight maximum_total_weight(CityId city_id) const
+    {
+        return total_weights_[city_offsets_[city_id + 1] - 1];
+    }
+
+    /**
+     * Get the total profit of the last state of a city.
+     *
+     * The last state is the heaviest and the most profitable one.
+     */
+    inline Profit maximum_total_profit(CityId city_id) const
+    {
+        return total_profits_[city_offsets_[city_id + 1] - 1];
+    }
+
+    /** Get the number of items of a city state. */
+    inline ItemId number_of_items(
+            CityId city_id,
+            CityStateId city_state_id) const
+    {
+        CityStateId pos = city_offsets_[city_id] + city_state_id;
+        return item_offsets_[pos + 1] - item_offsets_[pos];
+    }
+
+    /** Get the items of a city state. */
+    inline ItemIdRange item_ids(
+            CityId city_id,
+            CityStateId city_state_id) const
+    {
+        CityStateId pos = city_offsets_[city_id] + city_state_id;
+        return {
+            item_ids_.data() + item_offsets_[pos],
+            item_ids_.data() + item_offsets_[pos + 1]};
+    }
+
+private:
+
+    /*
+     * Private attributes
+     */
+
+    /** For each city, position of its first state. */
+    std::vector<CityStateId> city_offsets_ = {0};
+
+    /** Total weight of each state. */
+    std::vector<Weight> total_weights_;
+
+    /** Total profit of each state. */
+    std::vector<Profit> total_profits_;
+
+    /** For each state, position of its first item in the item pool. */
+    std::vector<ItemId> item_offsets_ = {0};
+
+    /** Item pool. */
+    std::vector<ItemId> item_ids_;
+
+};
+
+/**
+ * Compute the states of a city, that is, the Pareto front of the subsets of
+ * its items in the (weight, profit) space.
+ */
 template <typename Instance>
-std::vector<std::vector<CityState>> compute_city_states(const Instance& instance);
+std::vector<CityState> compute_states_of_city(
+        const Instance& instance,
+        CityId city_id);
+
+/**
+ * Call 'function(city_id)' for each city in
+ * ['city_id_first', 'city_id_last').
+ *
+ * If 'number_of_threads' is greater than 1, the cities are distributed among
+ * the threads in small chunks since their processing time may vary a lot.
+ * Each city is processed by a single thread. An exception thrown by
+ * 'function' stops all the threads and is rethrown once they have been
+ * joined.
+ */
+template <typename Function>
+void for_each_city(
+        CityId city_id_first,
+        CityId city_id_last,
+        Counter number_of_threads,
+        const Function& function);
+
+/**
+ * Compute the states of all cities.
+ *
+ * The cities are independent and are distributed among the threads by
+ * 'for_each_city'. The result doesn't depend on the number of threads.
+ */
+template <typename Instance>
+std::vector<std::vector<CityState>> compute_city_states(
+        const Instance& instance,
+        Counter number_of_threads = 1);
+
+/**
+ * Compute the states of all cities and store them in a table.
+ */
+template <typename Instance>
+CityStateTable compute_city_state_table(
+        const Instance& instance,
+        Counter number_of_threads = 1);
 
 template <typename Instance, typename Solution>
 std::vector<CityStateId> solution2states(
@@ -42,57 +232,176 @@ std::vector<CityStateId> solution2states(
         const std::vector<std::vector<CityState>>& city_states,
         const Solution& solution);
 
+template <typename Instance, typename Solution>
+std::vector<CityStateId> solution2states(
+        const Instance& instance,
+        const CityStateTable& city_states,
+        const Solution& solution);
+
+}
 }
+
+inline travellingthiefsolver::packing_while_travelling::CityStateTable::CityStateTable(
+        const std::vector<std::vector<CityState>>& city_states)
+{
+    CityStateId number_of_states = 0;
+    ItemId number_of_items = 0;
+    for (const std::vector<CityState>& states: city_states) {
+        number_of_states += states.size();
+        for (const CityState& city_state: states)
+            number_of_items += city_state.item_ids.size();
+    }
+
+    city_offsets_.reserve(city_states.size() + 1);
+    total_weights_.reserve(number_of_states);
+    total_profits_.reserve(number_of_states);
+    item_offsets_.reserve(number_of_states + 1);
+    item_ids_.reserve(number_of_items);
+    for (const std::vector<CityState>& states: city_states) {
+        for (const CityState& city_state: states) {
+            total_weights_.push_back(city_state.total_weight);
+            total_profits_.push_back(city_state.total_profit);
+            item_ids_.insert(
+                    item_ids_.end(),
+                    city_state.item_ids.begin(),
+                    city_state.item_ids.end());
+            item_offsets_.push_back(item_ids_.size());
+        }
+        city_offsets_.push_back(total_weights_.size());
+    }
+}
+
+template <typename Function>
+void travellingthiefsolver::packing_while_travelling::for_each_city(
+        CityId city_id_first,
+        CityId city_id_last,
+        Counter number_of_threads,
+        const Function& function)
+{
+    if (number_of_threads > city_id_last - city_id_first)
+        number_of_threads = city_id_last - city_id_first;
+
+    if (number_of_threads <= 1) {
+        for (CityId city_id = city_id_first; city_id < city_id_last; ++city_id)
+            function(city_id);
+        return;
+    }
+
+    // Each thread takes the next chunk of cities until all of them have been
+    // processed. A failed thread moves the next chunk past the last city so
+    // that the other threads stop.
+    const CityId chunk_size = 16;
+    std::atomic<CityId> city_id_next(city_id_first);
+    std::mutex exception_mutex;
+    std::exception_ptr exception = nullptr;
+    auto worker = [
+        city_id_last,
+        &function,
+        &city_id_next,
+        &exception_mutex,
+        &exception,
+        chunk_size]()
+    {
+        try {
+            for (;;) {
+                CityId city_id_start = city_id_next.fetch_add(chunk_size);
+                if (city_id_start >= city_id_last)
+                    break;
+                CityId city_id_end = std::min(
+                        city_id_start + chunk_size,
+                        city_id_last);
+                for (CityId city_id = city_id_start;
+                        city_id < city_id_end;
+                        ++city_id) {
+                    function(city_id);
+                }
+            }
+        } catch (...) {
+            city_id_next = city_id_last;
+            std::lock_guard<std::mutex> lock(exception_mutex);
+            if (exception == nullptr)
+                exception = std::current_exception();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (Counter thread_id = 1; thread_id < number_of_threads; ++thread_id)
+        threads.push_back(std::thread(worker));
+    worker();
+    for (std::thread& thread: threads)
+        thread.join();
+
+    if (exception != nullptr)
+        std::rethrow_exception(exception);
 }
 
 template <typename Instance>
-std::vector<std::vector<travellingthiefsolver::packing_while_travelling::CityState>> travellingthiefsolver::packing_while_travelling::compute_city_states(
-        const Instance &instance)
+travellingthiefsolver::packing_while_travelling::CityStateTable travellingthiefsolver::packing_while_travelling::compute_city_state_table(
+        const Instance& instance,
+        Counter number_of_threads)
 {
-    std::vector<std::vector<CityState>> states(instance.number_of_cities());
+    return CityStateTable(compute_city_states(instance, number_of_threads));
+}
 
-    for (CityId city_id = 0; city_id < instance.number_of_cities(); ++city_id) {
-        const auto& city = instance.city(city_id);
-        std::vector<ItemId> items_to_take;
-        std::vector<CityState> l0;
-        l0.emplace_back(CityState());
-        for (ItemId item_id: city.item_ids) {
-            const auto& item = instance.item(item_id);
-            std::vector<CityState> l;
-            std::vector<CityState>::iterator it = l0.begin();
-            std::vector<CityState>::iterator it1 = l0.begin();
-            while (it != l0.end() || it1 != l0.end()) {
-                if (it1 != l0.end() && (it == l0.end() || it->total_weight > it1->total_weight + item.weight)) {
-                    CityState s1 = *it1;
-                    s1.item_ids.push_back(item_id);
-                    s1.total_profit += item.profit;
-                    s1.total_weight += item.weight;
-                    if (s1.total_weight > instance.capacity()) {
-                        break;
-                    }
-                    if (l.empty() || s1.total_profit > l.back().total_profit) {
-                        if (!l.empty() && s1.total_weight == l.back().total_weight) {
-                            l.back() = s1;
-                        } else {
-                            l.push_back(s1);
-                        }
+template <typename Instance>
+std::vector<travellingthiefsolver::packing_while_travelling::CityState> travellingthiefsolver::packing_while_travelling::compute_states_of_city(
+        const Instance& instance,
+        CityId city_id)
+{
+    std::vector<CityState> l0;
+    l0.emplace_back(CityState());
+    for (ItemId item_id: instance.city_item_ids(city_id)) {
+        const auto& item = instance.item(item_id);
+        std::vector<CityState> l;
+        std::vector<CityState>::iterator it = l0.begin();
+        std::vector<CityState>::iterator it1 = l0.begin();
+        while (it != l0.end() || it1 != l0.end()) {
+            if (it1 != l0.end() && (it == l0.end() || it->total_weight > it1->total_weight + item.weight)) {
+                CityState s1 = *it1;
+                s1.item_ids.push_back(item_id);
+                s1.total_profit += item.profit;
+                s1.total_weight += item.weight;
+                if (s1.total_weight > instance.capacity()) {
+                    break;
+                }
+                if (l.empty() || s1.total_profit > l.back().total_profit) {
+                    if (!l.empty() && s1.total_weight == l.back().total_weight) {
+                        l.back() = s1;
+                    } else {
+                        l.push_back(s1);
                     }
-                    ++it1;
-                } else {
-                    if (l.empty() || it->total_profit > l.back().total_profit) {
-                        if (!l.empty() && it->total_weight == l.back().total_weight) {
-                            l.back() = *it;
-                        } else {
-                            l.push_back(*it);
-                        }
+                }
+                ++it1;
+            } else {
+                if (l.empty() || it->total_profit > l.back().total_profit) {
+                    if (!l.empty() && it->total_weight == l.back().total_weight) {
+                        l.back() = *it;
+                    } else {
+                        l.push_back(*it);
                     }
-                    ++it;
                 }
+                ++it;
             }
-            l0 = std::move(l);
         }
-        states[city_id] = std::move(l0);
+        l0 = std::move(l);
     }
+    return l0;
+}
+
+template <typename Instance>
+std::vector<std::vector<travellingthiefsolver::packing_while_travelling::CityState>> travellingthiefsolver::packing_while_travelling::compute_city_states(
+        const Instance &instance,
+        Counter number_of_threads)
+{
+    PROFILING_SCOPE("ComputeCityStates");
+    std::vector<std::vector<CityState>> states(instance.number_of_cities());
+    for_each_city(
+            0,
+            instance.number_of_cities(),
+            number_of_threads,
+            [&instance, &states](CityId city_id)
+            {
+                states[city_id] = compute_states_of_city(instance, city_id);
+            });
     return states;
 }
 
@@ -129,3 +438,36 @@ std::vector<travellingthiefsolver::packing_while_travelling::CityStateId> travel
     }
     return solution_city_states;
 }
+
+template <typename Instance, typename Solution>
+std::vector<travellingthiefsolver::packing_while_travelling::CityStateId> travellingthiefsolver::packing_while_travelling::solution2states(
+        const Instance& instance,
+        const CityStateTable& city_states,
+        const Solution& solution)
+{
+    std::vector<Weight> weights(instance.number_of_cities(), 0);
+    std::vector<Profit> profits(instance.number_of_cities(), 0);
+    for (ItemId item_id = 0; item_id < instance.number_of_items(); ++item_id) {
+        if (solution.contains(item_id)) {
+            const auto& item = instance.item(item_id);
+            weights[item.city_id] += item.weight;
+            profits[item.city_id] += item.profit;
+        }
+    }
+
+    std::vector<CityStateId> solution_city_states(instance.number_of_cities(), 0);
+    for (CityId city_id = 1;
+            city_id < instance.number_of_cities();
+            ++city_id) {
+        for (CityStateId city_state_id = 0;
+                city_state_id < city_states.number_of_states(city_id);
+                ++city_state_id) {
+            if (city_states.total_weight(city_id, city_state_id) <= weights[city_id]
+                    && city_states.total_profit(city_id, city_state_id) >= profits[city_id]) {
+                solution_city_states[city_id] = city_state_id;
+                break;
+            }
+        }
+    }
+    return solution_city_states;
+}
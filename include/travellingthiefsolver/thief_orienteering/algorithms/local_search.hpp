@@ -5,6 +5,7 @@
 #include "travellingthiefsolver/thief_orienteering/algorithm_formatter.hpp"
 
 #include "travellingthiefsolver/packing_while_travelling/utils.hpp"
+#include "travellingthiefsolver/packing_while_travelling/multi_start_local_search.hpp"
 
 #include "localsearchsolver/sequencing.hpp"
 #include "localsearchsolver/best_first_local_search.hpp"
@@ -66,6 +67,93 @@ const Output local_search(
         const Instance& instance,
         const LocalSearchParameters& parameters = {});
 
+struct MultiStartLocalSearchParameters: Parameters
+{
+    /** Number of threads. */
+    Counter number_of_threads = 1;
+
+    /** Size of the elite pool. */
+    Counter elite_pool_size = 16;
+
+    /** Maximum number of local searches. */
+    Counter maximum_number_of_iterations = -1;
+
+
+    virtual int format_width() const override { return 31; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Parameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of threads: " << number_of_threads << std::endl
+            << std::setw(width) << std::left << "Elite pool size: " << elite_pool_size << std::endl
+            << std::setw(width) << std::left << "Maximum number of iterations: " << maximum_number_of_iterations << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Parameters::to_json();
+        json.merge_patch({
+                {"NumberOfThreads", number_of_threads},
+                {"ElitePoolSize", elite_pool_size},
+                {"MaximumNumberOfIterations", maximum_number_of_iterations},
+                });
+        return json;
+    }
+};
+
+struct MultiStartLocalSearchOutput: Output
+{
+    template <typename Distances>
+    MultiStartLocalSearchOutput(
+            const Distances& distances,
+            const Instance& instance):
+        Output(distances, instance) { }
+
+
+    /** Number of local searches performed. */
+    Counter number_of_iterations = 0;
+
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Output::to_json();
+        json.merge_patch({
+                {"NumberOfIterations", number_of_iterations},
+                });
+        return json;
+    }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Output::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of iterations: " << number_of_iterations << std::endl
+            ;
+    }
+};
+
+/**
+ * Parallel multi-start local search for the thief orienteering problem.
+ *
+ * The threads share the sequencing scheme and an elite pool; new starts
+ * are built from random initial solutions or by perturbing elite solutions.
+ */
+const MultiStartLocalSearchOutput multi_start_local_search(
+        const Instance& instance,
+        std::mt19937_64& generator,
+        const MultiStartLocalSearchParameters& parameters = {});
+
+template <typename Distances>
+const MultiStartLocalSearchOutput multi_start_local_search(
+        const Distances& distances,
+        const Instance& instance,
+        std::mt19937_64& generator,
+        const MultiStartLocalSearchParameters& parameters = {});
+
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
@@ -124,7 +212,7 @@ public:
     SequencingScheme(
             const Instance& instance,
             const Distances& distances,
-            const std::vector<std::vector<travellingthiefsolver::packing_while_travelling::CityState>>& city_states):
+            const travellingthiefsolver::packing_while_travelling::CityStateTable& city_states):
         instance_(instance),
         distances_(distances),
         city_states_(city_states)
@@ -143,7 +231,7 @@ public:
     inline localsearchsolver::sequencing::Mode number_of_modes(
             localsearchsolver::sequencing::ElementId element_id) const
     {
-        return city_states_[element_id + 1].size();
+        return city_states_.number_of_states(element_id + 1);
     }
 
     inline SequenceData empty_sequence_data(
@@ -184,11 +272,11 @@ public:
                 element_id + 1,
                 sequence_data.weight);
         // Update weight
-        sequence_data.weight += city_states_[element_id + 1][mode].total_weight;
+        sequence_data.weight += city_states_.total_weight(element_id + 1, mode);
         // Update profit
-        sequence_data.profit += city_states_[element_id + 1][mode].total_profit;
+        sequence_data.profit += city_states_.total_profit(element_id + 1, mode);
         // Update remaining_profit.
-        sequence_data.remaining_profit -= city_states_[element_id + 1].back().total_profit;
+        sequence_data.remaining_profit -= city_states_.maximum_total_profit(element_id + 1);
         // Update time_full.
         sequence_data.time_full = sequence_data.time
             + instance_.duration(
@@ -209,7 +297,7 @@ private:
     const Distances& distances_;
 
     /** City states. */
-    const std::vector<std::vector<travellingthiefsolver::packing_while_travelling::CityState>>& city_states_;
+    const travellingthiefsolver::packing_while_travelling::CityStateTable& city_states_;
 
     Profit total_profit_ = 0;
 
@@ -226,7 +314,9 @@ const Output local_search(
     algorithm_formatter.start("Local search");
     algorithm_formatter.print_header();
 
-    auto city_states = packing_while_travelling::compute_city_states<Instance>(instance);
+    auto city_states = packing_while_travelling::compute_city_state_table<Instance>(
+            instance,
+            parameters.number_of_threads);
 
     //for (CityId city_id = 0; city_id < instance.number_of_cities(); ++city_id) {
     //    std::cout << "city_id " << city_id << std::endl;
@@ -261,7 +351,7 @@ const Output local_search(
             for (auto se: lss_output.solution_pool.best().sequences[0].elements) {
                 CityId city_id = se.element_id + 1;
                 solution.add_city(distances, city_id);
-                for (ItemId item_id: city_states[city_id][se.mode].item_ids) {
+                for (ItemId item_id: city_states.item_ids(city_id, se.mode)) {
                     solution.add_item(distances, item_id);
                 }
             }
@@ -285,7 +375,7 @@ const Output local_search(
             for (auto se: solution.sequences[0].elements) {
                 CityId city_id = se.element_id + 1;
                 sol.add_city(city_id);
-                for (ItemId item_id: city_states[city_id][se.mode].item_ids) {
+                for (ItemId item_id: city_states.item_ids(city_id, se.mode)) {
                     sol.add_item(item_id);
                 }
             }
@@ -299,5 +389,57 @@ const Output local_search(
     return output;
 }
 
+template <typename Distances>
+const MultiStartLocalSearchOutput multi_start_local_search(
+        const Distances& distances,
+        const Instance& instance,
+        std::mt19937_64& generator,
+        const MultiStartLocalSearchParameters& parameters)
+{
+    MultiStartLocalSearchOutput output(distances, instance);
+    AlgorithmFormatter algorithm_formatter(parameters, output);
+    algorithm_formatter.start("Multi-start local search");
+    algorithm_formatter.print_header();
+
+    auto city_states = packing_while_travelling::compute_city_state_table<Instance>(
+            instance,
+            parameters.number_of_threads);
+
+    // The sequencing scheme only reads the instance and the city states; it
+    // is shared by the local schemes of the threads.
+    using LocalScheme = localsearchsolver::sequencing::LocalScheme<SequencingScheme<Distances>>;
+    SequencingScheme<Distances> sequencing_scheme(instance, distances, city_states);
+    localsearchsolver::sequencing::Parameters sequencing_parameters
+        = sequencing_scheme.sequencing_parameters();
+    LocalScheme local_scheme(sequencing_scheme, sequencing_parameters);
+
+    output.number_of_iterations = packing_while_travelling::multi_start_local_search(
+            local_scheme,
+            generator,
+            parameters.number_of_threads,
+            parameters.elite_pool_size,
+            0.0,
+            parameters.maximum_number_of_iterations,
+            [&parameters]() { return parameters.timer.needs_to_end(); },
+            [&instance, &distances, &city_states, &algorithm_formatter](
+                const typename LocalScheme::Solution& ls_solution,
+                Counter iteration)
+            {
+                Solution solution(distances, instance);
+                for (auto se: ls_solution.sequences[0].elements) {
+                    CityId city_id = se.element_id + 1;
+                    solution.add_city(distances, city_id);
+                    for (ItemId item_id: city_states.item_ids(city_id, se.mode))
+                        solution.add_item(distances, item_id);
+                }
+                std::stringstream ss;
+                ss << "iteration " << iteration;
+                algorithm_formatter.update_solution(solution, ss.str());
+            });
+
+    algorithm_formatter.end();
+    return output;
+}
+
 }
 }
@@ -3,14 +3,158 @@
 #include "travellingthiefsolver/thief_orienteering/solution.hpp"
 
 #include "travellingthiefsolver/thief_orienteering/algorithm_formatter.hpp"
+#include "travellingthiefsolver/packing_while_travelling/iterative_beam_search.hpp"
+#include "travellingthiefsolver/packing_while_travelling/memory_pool.hpp"
+#include "travellingthiefsolver/packing_while_travelling/tree_search_overflow_policy.hpp"
 
 #include "treesearchsolver/best_first_search.hpp"
 
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <set>
+#include <unordered_map>
+
 namespace travellingthiefsolver
 {
 namespace thief_orienteering
 {
 
+struct TreeSearchParameters: Parameters
+{
+    /**
+     * Maximum number of nodes.
+     *
+     * Since the path elements of all the nodes created are kept, it bounds
+     * the number of nodes created.
+     */
+    Counter maximum_number_of_nodes = -1;
+
+    /**
+     * Maximum number of bytes used by the search, estimated from the size of
+     * the nodes.
+     */
+    Counter maximum_number_of_bytes = -1;
+
+    /**
+     * Policy applied when the budget is reached.
+     *
+     * Since purging the queue doesn't reduce the number of nodes created, the
+     * 'PurgeQueue' policy behaves as the 'IterativeBeamSearch' policy.
+     */
+    packing_while_travelling::TreeSearchOverflowPolicy overflow_policy
+        = packing_while_travelling::TreeSearchOverflowPolicy::Stop;
+
+
+    virtual int format_width() const override { return 25; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Parameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Maximum number of nodes: " << maximum_number_of_nodes << std::endl
+            << std::setw(width) << std::left << "Maximum number of bytes: " << maximum_number_of_bytes << std::endl
+            << std::setw(width) << std::left << "Overflow policy: " << overflow_policy << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Parameters::to_json();
+        json.merge_patch({
+                {"MaximumNumberOfNodes", maximum_number_of_nodes},
+                {"MaximumNumberOfBytes", maximum_number_of_bytes},
+                {"OverflowPolicy", packing_while_travelling::to_string(overflow_policy)},
+                });
+        return json;
+    }
+};
+
+struct TreeSearchOutput: Output
+{
+    template <typename Distances>
+    TreeSearchOutput(
+            const Distances& distances,
+            const Instance& instance):
+        Output(distances, instance) { }
+
+
+    /** Number of nodes created. */
+    Counter number_of_nodes = 0;
+
+    /** Maximum number of nodes alive. */
+    Counter peak_number_of_nodes = 0;
+
+    /** Maximum estimated number of bytes used by the search. */
+    Counter peak_number_of_bytes = 0;
+
+    /** 'true' iff the budget has been reached. */
+    bool overflow = false;
+
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Output::to_json();
+        json.merge_patch({
+                {"NumberOfNodes", number_of_nodes},
+                {"PeakNumberOfNodes", peak_number_of_nodes},
+                {"PeakNumberOfBytes", peak_number_of_bytes},
+                {"Overflow", overflow},
+                });
+        return json;
+    }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Output::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of nodes: " << number_of_nodes << std::endl
+            << std::setw(width) << std::left << "Peak number of nodes: " << peak_number_of_nodes << std::endl
+            << std::setw(width) << std::left << "Peak number of bytes: " << peak_number_of_bytes << std::endl
+            << std::setw(width) << std::left << "Overflow: " << overflow << std::endl
+            ;
+    }
+};
+
+struct IterativeBeamSearchParameters: Parameters
+{
+    /** Minimum size of the queue. */
+    Counter minimum_size_of_the_queue = 1;
+
+    /** Maximum size of the queue. */
+    Counter maximum_size_of_the_queue = 100000000;
+
+    /** Growth factor of the size of the queue. */
+    double growth_factor = 2;
+
+
+    virtual int format_width() const override { return 27; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Parameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Minimum size of the queue: " << minimum_size_of_the_queue << std::endl
+            << std::setw(width) << std::left << "Maximum size of the queue: " << maximum_size_of_the_queue << std::endl
+            << std::setw(width) << std::left << "Growth factor: " << growth_factor << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Parameters::to_json();
+        json.merge_patch({
+                {"MinimumSizeOfTheQueue", minimum_size_of_the_queue},
+                {"MaximumSizeOfTheQueue", maximum_size_of_the_queue},
+                {"GrowthFactor", growth_factor},
+                });
+        return json;
+    }
+};
+
 /**
  * Tree search algorithm (dynamic programming) for the thief orienteering
  * problem..
@@ -19,15 +163,34 @@ namespace thief_orienteering
  * - "Exact Approaches for the Travelling Thief Problem" (Wu et al., 2017)
  *   https://doi.org/10.1007/978-3-319-68759-9_10
  */
-const Output tree_search(
+const TreeSearchOutput tree_search(
         const Instance& instance,
-        const Parameters& parameters = {});
+        const TreeSearchParameters& parameters = {});
 
 template <typename Distances>
-const Output tree_search(
+const TreeSearchOutput tree_search(
         const Distances& distances,
         const Instance& instance,
-        const Parameters& parameters = {});
+        const TreeSearchParameters& parameters = {});
+
+/**
+ * Iterative beam search algorithm for the thief orienteering problem.
+ *
+ * It uses the same branching scheme as the tree search algorithm, but only
+ * keeps the best nodes of each level according to the guide. The width of
+ * the beam grows from a beam to the next one, so that it provides good
+ * solutions quickly with a bounded memory usage, and it stops once a beam is
+ * not truncated.
+ */
+const Output iterative_beam_search(
+        const Instance& instance,
+        const IterativeBeamSearchParameters& parameters = {});
+
+template <typename Distances>
+const Output iterative_beam_search(
+        const Distances& distances,
+        const Instance& instance,
+        const IterativeBeamSearchParameters& parameters = {});
 
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
@@ -39,17 +202,20 @@ class BranchingScheme
 
 public:
 
+    /** Type of the words of the visited cities bitset. */
+    using Word = uint64_t;
+
+    /**
+     * Structure for a node.
+     *
+     * Nodes are allocated from a memory pool. The bitset of the visited
+     * cities is stored right after the node, in the same block.
+     */
     struct Node
     {
         /** Id of the node. */
         treesearchsolver::NodeId node_id = -1;
 
-        /** Parent of the node. */
-        std::shared_ptr<Node> parent = nullptr;
-
-        /** Visited cities. */
-        std::vector<bool> visited_cities;
-
         /** Last visited city. */
         CityId last_visited_city_id = -1;
 
@@ -100,6 +266,43 @@ public:
 
         /** State of the city of the next child. */
         CityStateId next_child_city_state_id = 0;
+
+        /** Get the visited cities bitset. */
+        inline Word* visited_cities() { return reinterpret_cast<Word*>(this + 1); }
+
+        /** Get the visited cities bitset. */
+        inline const Word* visited_cities() const { return reinterpret_cast<const Word*>(this + 1); }
+
+        /** Check if a city has been visited. */
+        inline bool visited(CityId city_id) const
+        {
+            return (visited_cities()[city_id / 64] >> (city_id % 64)) & 1;
+        }
+
+        /** Mark a city as visited. */
+        inline void visit(CityId city_id)
+        {
+            visited_cities()[city_id / 64] |= ((Word)1 << (city_id % 64));
+        }
+    };
+
+    /**
+     * Structure storing the last visited city of a node and the id of its
+     * parent.
+     *
+     * They are kept for all the nodes created so that the path of a node can
+     * be retrieved without keeping its ancestors alive.
+     */
+    struct PathElement
+    {
+        /** Id of the parent node. */
+        treesearchsolver::NodeId parent_node_id;
+
+        /** Last visited city. */
+        int32_t city_id;
+
+        /** State of the last visited city. */
+        int32_t city_state_id;
     };
 
     struct Parameters
@@ -109,24 +312,44 @@ public:
     BranchingScheme(
             const Instance& instance,
             const Distances& distances,
-            const std::vector<std::vector<travellingthiefsolver::packing_while_travelling::CityState>>& city_states,
+            const travellingthiefsolver::packing_while_travelling::CityStateTable& city_states,
             const Parameters& parameters):
         instance_(instance),
         distances_(distances),
         city_states_(city_states),
         parameters_(parameters),
-        closest_city_distances_(instance_.number_of_cities(), std::numeric_limits<Distance>::max())
+        closest_city_distances_(instance_.number_of_cities(), std::numeric_limits<Distance>::max()),
+        distances_to_end_(instance_.number_of_cities()),
+        sorted_item_ids_(instance_.number_of_items()),
+        reachable_cities_(instance_.number_of_cities()),
+        number_of_words_((instance_.number_of_cities() + 63) / 64),
+        node_size_(sizeof(Node) + number_of_words_ * sizeof(Word)),
+        node_pool_(new travellingthiefsolver::packing_while_travelling::MemoryPool()),
+        node_counter_(new NodeCounter())
     {
         for (CityId city_id = 0;
                 city_id < instance_.number_of_cities();
                 ++city_id) {
-            Profit profit = city_states_[city_id].back().total_profit;
-            Weight weight = city_states_[city_id].back().total_weight;
-            double eff = profit / weight;
-            if (best_efficiency_ < eff)
-                best_efficiency_ = eff;
+            distances_to_end_[city_id] = distances_.distance(
+                    city_id,
+                    instance_.number_of_cities() - 1);
         }
 
+        // Sort items by decreasing efficiency for the knapsack bound.
+        std::iota(sorted_item_ids_.begin(), sorted_item_ids_.end(), 0);
+        std::sort(
+                sorted_item_ids_.begin(),
+                sorted_item_ids_.end(),
+                [this](
+                    ItemId item_id_1,
+                    ItemId item_id_2) -> bool
+                {
+                    const Item& item_1 = instance_.item(item_id_1);
+                    const Item& item_2 = instance_.item(item_id_2);
+                    return item_1.profit * item_2.weight
+                        > item_2.profit * item_1.weight;
+                });
+
         for (CityId city_id_1 = 0;
                 city_id_1 < instance_.number_of_cities();
                 ++city_id_1) {
@@ -144,10 +367,9 @@ public:
 
     inline const std::shared_ptr<Node> root() const
     {
-        auto r = std::shared_ptr<Node>(new BranchingScheme::Node());
-        r->visited_cities.resize(instance_.number_of_cities(), false);
-        r->visited_cities[0] = true;
-        r->visited_cities[instance_.number_of_cities() - 1] = true;
+        auto r = create_node();
+        r->visit(0);
+        r->visit(instance_.number_of_cities() - 1);
         r->number_of_cities = 2;
         r->last_visited_city_id = 0;
         r->remaining_profit = 0;
@@ -155,8 +377,8 @@ public:
         for (CityId city_id = 0;
                 city_id < instance_.number_of_cities();
                 ++city_id) {
-            Profit profit = city_states_[city_id].back().total_profit;
-            Weight weight = city_states_[city_id].back().total_weight;
+            Profit profit = city_states_.maximum_total_profit(city_id);
+            Weight weight = city_states_.maximum_total_weight(city_id);
             r->remaining_profit += profit;
             r->remaining_weight += weight;
         }
@@ -168,6 +390,7 @@ public:
         }
         r->node_id = node_id_cur_;
         node_id_cur_++;
+        path_elements_.push_back({-1, 0, -1});
         return r;
     }
 
@@ -176,6 +399,7 @@ public:
     {
         assert(!infertile(parent));
         assert(!leaf(parent));
+        PROFILING_COUNT("ThopTreeSearchChildren", 1);
         //std::cout << "parent id " << parent->node_id
         //    << " next_child_city_id " << parent->next_child_city_id
         //    << " next_child_city_state_id " << parent->next_child_city_state_id
@@ -188,18 +412,18 @@ public:
         // Update parent
         parent->next_child_city_state_id++;
         if (parent->next_child_city_state_id
-                == (CityStateId)city_states_[parent->next_child_city_id].size()) {
+                == city_states_.number_of_states(parent->next_child_city_id)) {
             parent->next_child_city_id++;
             parent->next_child_city_state_id = 0;
         }
 
         // Check if the next city has already been visited.
-        if (parent->visited_cities[city_id_next])
+        if (parent->visited(city_id_next))
             return nullptr;
 
         // Check capacity.
         Weight weight = parent->weight
-            + city_states_[city_id_next][city_state_id_next].total_weight;
+            + city_states_.total_weight(city_id_next, city_state_id_next);
         if (weight > instance_.capacity())
             return nullptr;
 
@@ -209,56 +433,91 @@ public:
                 parent->last_visited_city_id,
                 city_id_next,
                 parent->weight);
-        Time t_end = instance_.duration(
-                distances_,
-                city_id_next,
-                instance().number_of_cities() - 1,
-                weight);
+        Time t_end = distances_to_end_[city_id_next] / instance_.speed(weight);
         if (parent->time + t + t_end > instance().time_limit())
             return nullptr;
 
         // Compute new child.
-        auto child = std::shared_ptr<Node>(new BranchingScheme::Node());
+        auto child = create_node();
         child->node_id = node_id_cur_;
         node_id_cur_++;
-        child->parent = parent;
-        child->visited_cities = parent->visited_cities;
-        child->visited_cities[city_id_next] = true;
+        path_elements_.push_back({
+                parent->node_id,
+                (int32_t)city_id_next,
+                (int32_t)city_state_id_next});
+        std::copy(
+                parent->visited_cities(),
+                parent->visited_cities() + number_of_words_,
+                child->visited_cities());
+        child->visit(city_id_next);
         child->last_visited_city_id = city_id_next;
         child->last_visited_city_state_id = city_state_id_next;
         child->number_of_cities = parent->number_of_cities + 1;
         child->number_of_items = parent->number_of_items
-            + city_states_[city_id_next][city_state_id_next].item_ids.size();
+            + city_states_.number_of_items(city_id_next, city_state_id_next);
         Distance d = distances_.distance(
                 parent->last_visited_city_id,
                 city_id_next);
         child->distance = parent->distance + d;
         child->time = parent->time + t;
         child->profit = parent->profit
-            + city_states_[city_id_next][city_state_id_next].total_profit;
+            + city_states_.total_profit(city_id_next, city_state_id_next);
         child->weight = parent->weight
-            + city_states_[city_id_next][city_state_id_next].total_weight;
+            + city_states_.total_weight(city_id_next, city_state_id_next);
         child->minimum_remaining_distance = parent->minimum_remaining_distance
             - closest_city_distances_[city_id_next];
         child->remaining_profit = parent->remaining_profit
-            - city_states_[city_id_next].back().total_profit;
+            - city_states_.maximum_total_profit(city_id_next);
         child->remaining_weight = parent->remaining_weight
-            - city_states_[city_id_next].back().total_weight;
-        Time d_end = distances_.distance(
-                city_id_next,
-                instance_.number_of_cities() - 1);
-        child->distance_full = child->distance + d_end;
+            - city_states_.maximum_total_weight(city_id_next);
+        child->distance_full = child->distance + distances_to_end_[city_id_next];
         child->time_full = child->time + t_end;
-        Weight remaining_capacity = instance_.capacity() - child->weight;
-        Profit profit_bound = child->profit + std::min(
+        child->bound = child->profit + std::min(
                 child->remaining_profit,
-                best_efficiency_ * remaining_capacity);
-        child->bound = profit_bound;
+                knapsack_bound(*child));
         child->guide = -child->bound;
         //std::cout << "child id " << child->node_id << std::endl;
         return child;
     }
 
+    /**
+     * Compute an upper bound on the profit of the items which can still be
+     * collected from a node.
+     *
+     * It is the fractional knapsack bound restricted to the items of the
+     * unvisited cities which can be visited before reaching the end city
+     * within the remaining time. Since the speed only decreases when items
+     * are collected, a city c is reachable only if
+     * (d(last, c) + d(c, end)) / speed(weight) <= time_limit - time.
+     */
+    inline Profit knapsack_bound(const Node& node) const
+    {
+        double speed = instance_.speed(node.weight);
+        double remaining_distance = (instance_.time_limit() - node.time) * speed;
+        for (CityId city_id = 0;
+                city_id < instance_.number_of_cities();
+                ++city_id) {
+            reachable_cities_[city_id] = (!node.visited(city_id)
+                    && distances_.distance(node.last_visited_city_id, city_id)
+                    + distances_to_end_[city_id] <= remaining_distance);
+        }
+
+        Weight remaining_capacity = instance_.capacity() - node.weight;
+        Profit profit_bound = 0;
+        for (ItemId item_id: sorted_item_ids_) {
+            const Item& item = instance_.item(item_id);
+            if (!reachable_cities_[item.city_id])
+                continue;
+            if (item.weight > remaining_capacity) {
+                profit_bound += item.profit * remaining_capacity / item.weight;
+                break;
+            }
+            profit_bound += item.profit;
+            remaining_capacity -= item.weight;
+        }
+        return profit_bound;
+    }
+
     inline bool infertile(
             const std::shared_ptr<Node>& node) const
     {
@@ -324,7 +583,10 @@ public:
 
     struct NodeHasher
     {
-        std::hash<std::vector<bool>> hasher_cities;
+        /** Number of words of the visited cities bitsets. */
+        CityId number_of_words;
+
+        std::hash<Word> hasher_word;
         std::hash<CityId> hasher_city;
 
         inline bool operator()(
@@ -333,7 +595,10 @@ public:
         {
             if (node_1->last_visited_city_id != node_2->last_visited_city_id)
                 return false;
-            if (node_1->visited_cities != node_2->visited_cities)
+            if (!std::equal(
+                        node_1->visited_cities(),
+                        node_1->visited_cities() + number_of_words,
+                        node_2->visited_cities()))
                 return false;
             return true;
         }
@@ -342,12 +607,13 @@ public:
                 const std::shared_ptr<Node>& node) const
         {
             size_t hash = hasher_city(node->last_visited_city_id);
-            optimizationtools::hash_combine(hash, hasher_cities(node->visited_cities));
+            for (CityId word_pos = 0; word_pos < number_of_words; ++word_pos)
+                optimizationtools::hash_combine(hash, hasher_word(node->visited_cities()[word_pos]));
             return hash;
         }
     };
 
-    inline NodeHasher node_hasher() const { return NodeHasher(); }
+    inline NodeHasher node_hasher() const { return NodeHasher{number_of_words_}; }
 
     inline bool dominates(
             const std::shared_ptr<Node>& node_1,
@@ -379,37 +645,152 @@ public:
             std::ostream& os,
             const std::shared_ptr<Node>& node) const
     {
-        os << "node_id " << node->node_id << std::endl;
-        for (auto node_tmp = node;
-                node_tmp->parent != nullptr;
-                node_tmp = node_tmp->parent) {
-            os << "node_tmp"
-                << " n " << node_tmp->number_of_cities
-                << " m " << node_tmp->number_of_items
-                << " d " << node_tmp->distance
-                << " d_full " << node_tmp->distance_full
-                << " t " << node_tmp->time
-                << " t_full " << node_tmp->time_full
-                << " w " << node_tmp->weight
-                << " p " << node_tmp->profit
-                << " guide " << node_tmp->guide
-                << " j " << node_tmp->last_visited_city_id
-                << " p1 " << node_tmp->next_child_city_id
-                << " p2 " << node_tmp->next_child_city_state_id
+        os << "node_id " << node->node_id
+            << " n " << node->number_of_cities
+            << " m " << node->number_of_items
+            << " d " << node->distance
+            << " d_full " << node->distance_full
+            << " t " << node->time
+            << " t_full " << node->time_full
+            << " w " << node->weight
+            << " p " << node->profit
+            << " guide " << node->guide
+            << std::endl;
+        for (auto city: path(node)) {
+            os << "j " << city.first
+                << " s " << city.second
                 << std::endl;
         }
         return os;
     }
 
+    /**
+     * Get the cities visited by a node, except the first one, with their
+     * states.
+     */
+    std::vector<std::pair<CityId, CityStateId>> path(
+            const std::shared_ptr<Node>& node) const
+    {
+        std::vector<std::pair<CityId, CityStateId>> cities;
+        for (treesearchsolver::NodeId node_id = node->node_id;
+                path_elements_[node_id].parent_node_id != -1;
+                node_id = path_elements_[node_id].parent_node_id) {
+            cities.push_back({
+                    path_elements_[node_id].city_id,
+                    path_elements_[node_id].city_state_id});
+        }
+        std::reverse(cities.begin(), cities.end());
+        return cities;
+    }
+
     inline void write(
             const std::shared_ptr<Node>&,
             std::string) const
     {
     }
 
+    /**
+     * Drop the path elements of the nodes created so far, except for the
+     * given nodes.
+     *
+     * The given nodes are renumbered and their paths are cut: 'path' only
+     * returns the cities visited after the reset. This is used by the
+     * iterative beam search at each level.
+     */
+    void reset(const std::vector<std::shared_ptr<Node>>& nodes) const
+    {
+        path_elements_.clear();
+        for (treesearchsolver::NodeId node_id = 0;
+                node_id < (treesearchsolver::NodeId)nodes.size();
+                ++node_id) {
+            const std::shared_ptr<Node>& node = nodes[node_id];
+            node->node_id = node_id;
+            path_elements_.push_back({
+                    -1,
+                    (int32_t)node->last_visited_city_id,
+                    (int32_t)node->last_visited_city_state_id});
+        }
+        node_id_cur_ = nodes.size();
+    }
+
+    /**
+     * Get an estimation of the number of bytes of a node created by the
+     * best-first search, including its path element, its control block and
+     * the entries pointing to it in the queue and in the dominance set of the
+     * search.
+     */
+    inline std::size_t node_number_of_bytes() const
+    {
+        return node_size_ + sizeof(PathElement) + 8 * sizeof(void*);
+    }
+
+    /** Get the size of a path element. */
+    inline std::size_t path_element_number_of_bytes() const
+    {
+        return sizeof(PathElement);
+    }
+
+    /** Get the maximum number of nodes alive at the same time so far. */
+    inline Counter peak_number_of_nodes() const
+    {
+        return node_counter_->peak_number_of_nodes;
+    }
+
 
 private:
 
+    /**
+     * Structure counting the nodes alive.
+     */
+    struct NodeCounter
+    {
+        /** Number of nodes alive. */
+        Counter number_of_nodes = 0;
+
+        /** Maximum number of nodes alive. */
+        Counter peak_number_of_nodes = 0;
+    };
+
+    /**
+     * Deleter of the nodes, returning their block to the memory pool.
+     */
+    struct NodeDeleter
+    {
+        /** Memory pool. */
+        std::shared_ptr<travellingthiefsolver::packing_while_travelling::MemoryPool> pool;
+
+        /** Counter of the nodes alive. */
+        std::shared_ptr<NodeCounter> counter;
+
+        /** Size of the block of a node. */
+        std::size_t node_size;
+
+        inline void operator()(Node* node) const
+        {
+            node->~Node();
+            pool->deallocate(node, node_size);
+            counter->number_of_nodes--;
+        }
+    };
+
+    /** Create a node with no visited city. */
+    inline std::shared_ptr<Node> create_node() const
+    {
+        Node* node = new (node_pool_->allocate(node_size_)) Node();
+        std::fill(
+                node->visited_cities(),
+                node->visited_cities() + number_of_words_,
+                0);
+        node_counter_->number_of_nodes++;
+        node_counter_->peak_number_of_nodes = (std::max)(
+                node_counter_->peak_number_of_nodes,
+                node_counter_->number_of_nodes);
+        return std::shared_ptr<Node>(
+                node,
+                NodeDeleter{node_pool_, node_counter_, node_size_},
+                travellingthiefsolver::packing_while_travelling::PoolAllocator<Node>(node_pool_));
+    }
+
     /** Instance. */
     const Instance& instance_;
 
@@ -417,69 +798,323 @@ private:
     const Distances& distances_;
 
     /** City states. */
-    const std::vector<std::vector<travellingthiefsolver::packing_while_travelling::CityState>>& city_states_;
+    const travellingthiefsolver::packing_while_travelling::CityStateTable& city_states_;
 
     /** Parameters. */
     Parameters parameters_;
 
-    double best_efficiency_ = 0;
-
     std::vector<Distance> closest_city_distances_;
 
+    /** Distances from each city to the end city. */
+    std::vector<Distance> distances_to_end_;
+
+    /** Items sorted by decreasing efficiency. */
+    std::vector<ItemId> sorted_item_ids_;
+
+    /** Scratch vector of the cities reachable from a node. */
+    mutable std::vector<uint8_t> reachable_cities_;
+
+    /** Number of words of the visited cities bitsets. */
+    CityId number_of_words_;
+
+    /** Size of the block of a node, including its visited cities bitset. */
+    std::size_t node_size_;
+
+    /** Memory pool of the nodes. */
+    std::shared_ptr<travellingthiefsolver::packing_while_travelling::MemoryPool> node_pool_;
+
+    /** Counter of the nodes alive. */
+    std::shared_ptr<NodeCounter> node_counter_;
+
+    /** Path elements, indexed by node id. */
+    mutable std::vector<PathElement> path_elements_;
+
     /** Current node id. */
     mutable treesearchsolver::NodeId node_id_cur_ = 0;
 
 };
 
+/**
+ * Best-first search.
+ *
+ * The open nodes are stored in a set ordered by the guide. A node which
+ * has the same last visited city and the same visited cities as a stored
+ * node is compared with it; it is dropped if it is dominated, and the
+ * stored nodes it dominates are dropped from the set.
+ *
+ * The search stops when the set is empty, when 'needs_to_end' returns true
+ * before a node is expanded, or when a child is generated once
+ * 'maximum_number_of_nodes' nodes have been created. The number of nodes
+ * created is written in 'number_of_nodes'.
+ *
+ * Return 'true' iff the search has been stopped by the number of nodes, that
+ * is, iff it needs more nodes than the budget.
+ */
+template <typename Distances>
+bool best_first_search(
+        const BranchingScheme<Distances>& branching_scheme,
+        Counter maximum_number_of_nodes,
+        const std::function<bool()>& needs_to_end,
+        Counter& number_of_nodes,
+        const std::function<void(const std::shared_ptr<typename BranchingScheme<Distances>::Node>&, Counter)>& new_solution_callback)
+{
+    using NodePtr = std::shared_ptr<typename BranchingScheme<Distances>::Node>;
+    using NodeHasher = typename BranchingScheme<Distances>::NodeHasher;
+
+    auto comparator = [&branching_scheme](
+            const NodePtr& node_1,
+            const NodePtr& node_2)
+    {
+        return branching_scheme(node_1, node_2);
+    };
+    std::set<NodePtr, decltype(comparator)> queue(comparator);
+    NodeHasher node_hasher = branching_scheme.node_hasher();
+    std::unordered_map<NodePtr, std::vector<NodePtr>, NodeHasher, NodeHasher> history(
+            0,
+            node_hasher,
+            node_hasher);
+
+    // As in the iterative beam search, the root is the first incumbent.
+    NodePtr root = branching_scheme.root();
+    NodePtr incumbent = root;
+    queue.insert(root);
+    number_of_nodes = 1;
+    while (!queue.empty()) {
+        if (needs_to_end())
+            return false;
+
+        NodePtr node = *queue.begin();
+        queue.erase(queue.begin());
+
+        // Expand the node completely.
+        while (!branching_scheme.infertile(node)) {
+            if (branching_scheme.bound(node, incumbent))
+                break;
+            NodePtr child = branching_scheme.next_child(node);
+            if (child == nullptr)
+                continue;
+            // The budget is checked once a child has been generated, so that
+            // a search needing exactly the budget is not reported as stopped.
+            // The extra child is dropped.
+            if (maximum_number_of_nodes >= 0
+                    && number_of_nodes >= maximum_number_of_nodes) {
+                return true;
+            }
+            number_of_nodes++;
+
+            if (branching_scheme.better(child, incumbent)) {
+                incumbent = child;
+                new_solution_callback(incumbent, number_of_nodes);
+            }
+
+            if (branching_scheme.leaf(child)
+                    || branching_scheme.bound(child, incumbent)) {
+                continue;
+            }
+
+            // Check the dominances.
+            if (branching_scheme.comparable(child)) {
+                std::vector<NodePtr>& nodes = history[child];
+                bool dominated = false;
+                for (const NodePtr& node_2: nodes) {
+                    if (branching_scheme.dominates(node_2, child)) {
+                        dominated = true;
+                        break;
+                    }
+                }
+                if (dominated)
+                    continue;
+                for (auto it = nodes.begin(); it != nodes.end();) {
+                    if (branching_scheme.dominates(child, *it)) {
+                        queue.erase(*it);
+                        *it = nodes.back();
+                        nodes.pop_back();
+                    } else {
+                        ++it;
+                    }
+                }
+                nodes.push_back(child);
+            }
+
+            queue.insert(child);
+        }
+    }
+    return false;
+}
+
 template <typename Distances>
-const Output tree_search(
+const TreeSearchOutput tree_search(
         const Distances& distances,
         const Instance& instance,
-        const Parameters& parameters)
+        const TreeSearchParameters& parameters)
 {
-    Output output(distances, instance);
+    TreeSearchOutput output(distances, instance);
     AlgorithmFormatter algorithm_formatter(parameters, output);
     algorithm_formatter.start("Tree search");
     algorithm_formatter.print_header();
+    PROFILING_SCOPE("ThopTreeSearch");
 
-    auto city_states = packing_while_travelling::compute_city_states<Instance>(instance);
+    auto city_states = packing_while_travelling::compute_city_state_table<Instance>(instance);
     typename BranchingScheme<Distances>::Parameters bs_parameters;
     BranchingScheme<Distances> branching_scheme(instance, distances, city_states, bs_parameters);
-    treesearchsolver::BestFirstSearchParameters<BranchingScheme<Distances>> bfs_parameters;
-    bfs_parameters.verbosity_level = 0;
-    bfs_parameters.timer = parameters.timer;
-    bfs_parameters.new_solution_callback
-        = [&instance, &distances, &city_states, &algorithm_formatter](
-                const treesearchsolver::Output<BranchingScheme<Distances>>& ts_output)
-        {
-            const auto& bfs_output = static_cast<const treesearchsolver::BestFirstSearchOutput<BranchingScheme<Distances>>&>(ts_output);
-            Solution solution(distances, instance);
-            auto node = bfs_output.solution_pool.best();
-            std::vector<std::shared_ptr<typename BranchingScheme<Distances>::Node>> ancestors;
-            for (auto node_tmp = node;
-                    node_tmp->parent != nullptr;
-                    node_tmp = node_tmp->parent) {
-                ancestors.push_back(node_tmp);
+    // Budget.
+    Counter maximum_number_of_nodes = parameters.maximum_number_of_nodes;
+    if (parameters.maximum_number_of_bytes >= 0) {
+        Counter m = parameters.maximum_number_of_bytes
+            / branching_scheme.node_number_of_bytes();
+        maximum_number_of_nodes = (maximum_number_of_nodes >= 0)?
+            (std::min)(maximum_number_of_nodes, m): m;
+    }
+
+    auto new_solution_callback = [&instance, &distances, &city_states, &branching_scheme, &algorithm_formatter](
+            const std::shared_ptr<typename BranchingScheme<Distances>::Node>& node,
+            Counter number_of_nodes)
+    {
+        Solution solution(distances, instance);
+        for (auto city: branching_scheme.path(node)) {
+            CityId city_id = city.first;
+            CityStateId city_state_id = city.second;
+            solution.add_city(distances, city_id);
+            for (ItemId item_id: city_states.item_ids(city_id, city_state_id)) {
+                solution.add_item(distances, item_id);
             }
-            std::reverse(ancestors.begin(), ancestors.end());
-            for (auto node_tmp: ancestors) {
-                CityId city_id = node_tmp->last_visited_city_id;
-                CityStateId city_state_id = node_tmp->last_visited_city_state_id;
-                solution.add_city(distances, city_id);
-                for (ItemId item_id: city_states[city_id][city_state_id].item_ids) {
-                    solution.add_item(distances, item_id);
+        }
+        std::stringstream ss;
+        ss << "node " << number_of_nodes;
+        algorithm_formatter.update_solution(solution, ss.str());
+    };
+    output.overflow = best_first_search(
+            branching_scheme,
+            maximum_number_of_nodes,
+            [&parameters]() { return parameters.timer.needs_to_end(); },
+            output.number_of_nodes,
+            new_solution_callback);
+
+    // The path elements of all the nodes created are kept until the end of
+    // the search.
+    output.peak_number_of_nodes = branching_scheme.peak_number_of_nodes();
+    output.peak_number_of_bytes = output.number_of_nodes
+        * branching_scheme.path_element_number_of_bytes()
+        + output.peak_number_of_nodes
+        * (branching_scheme.node_number_of_bytes()
+                - branching_scheme.path_element_number_of_bytes());
+
+    if (output.overflow
+            && parameters.overflow_policy
+            != packing_while_travelling::TreeSearchOverflowPolicy::Stop) {
+        // A level of the beam keeps the nodes of the level and of the next
+        // level, and the path elements of the children of the nodes of the
+        // level.
+        Counter number_of_states = 0;
+        for (CityId city_id = 0;
+                city_id < instance.number_of_cities();
+                ++city_id) {
+            number_of_states += city_states.number_of_states(city_id);
+        }
+        Counter maximum_size_of_the_queue = std::numeric_limits<Counter>::max();
+        if (parameters.maximum_number_of_nodes >= 0) {
+            maximum_size_of_the_queue = (std::min)(
+                    maximum_size_of_the_queue,
+                    parameters.maximum_number_of_nodes / 2);
+        }
+        if (parameters.maximum_number_of_bytes >= 0) {
+            Counter number_of_bytes_per_node
+                = 2 * branching_scheme.node_number_of_bytes()
+                + number_of_states * branching_scheme.path_element_number_of_bytes();
+            maximum_size_of_the_queue = (std::min)(
+                    maximum_size_of_the_queue,
+                    parameters.maximum_number_of_bytes / number_of_bytes_per_node);
+        }
+        maximum_size_of_the_queue = (std::max)((Counter)1, maximum_size_of_the_queue);
+
+        bool completed = packing_while_travelling::iterative_beam_search(
+                branching_scheme,
+                1,
+                maximum_size_of_the_queue,
+                2,
+                [&parameters]() { return parameters.timer.needs_to_end(); },
+                [&instance, &distances, &city_states, &algorithm_formatter](
+                    const std::shared_ptr<typename BranchingScheme<Distances>::Node>&,
+                    const std::vector<std::pair<CityId, CityStateId>>& path,
+                    Counter width)
+                {
+                    Solution solution(distances, instance);
+                    for (auto city: path) {
+                        CityId city_id = city.first;
+                        CityStateId city_state_id = city.second;
+                        solution.add_city(distances, city_id);
+                        for (ItemId item_id: city_states.item_ids(city_id, city_state_id)) {
+                            solution.add_item(distances, item_id);
+                        }
+                    }
+                    std::stringstream ss;
+                    ss << "queue size " << width;
+                    algorithm_formatter.update_solution(solution, ss.str());
+                });
+        output.peak_number_of_nodes = branching_scheme.peak_number_of_nodes();
+        output.peak_number_of_bytes = (std::max)(
+                output.peak_number_of_bytes,
+                2 * maximum_size_of_the_queue * (Counter)branching_scheme.node_number_of_bytes());
+
+        if (completed) {
+            algorithm_formatter.update_bound(
+                    output.solution.item_profit(),
+                    "iterative beam search completed");
+        }
+    } else if (!output.overflow && !parameters.timer.needs_to_end()) {
+        algorithm_formatter.update_bound(
+                output.solution.item_profit(),
+                "tree search completed");
+    }
+
+    algorithm_formatter.end();
+    return output;
+}
+
+template <typename Distances>
+const Output iterative_beam_search(
+        const Distances& distances,
+        const Instance& instance,
+        const IterativeBeamSearchParameters& parameters)
+{
+    Output output(distances, instance);
+    AlgorithmFormatter algorithm_formatter(parameters, output);
+    algorithm_formatter.start("Iterative beam search");
+    algorithm_formatter.print_header();
+    PROFILING_SCOPE("ThopIterativeBeamSearch");
+
+    auto city_states = packing_while_travelling::compute_city_state_table<Instance>(instance);
+    typename BranchingScheme<Distances>::Parameters bs_parameters;
+    BranchingScheme<Distances> branching_scheme(instance, distances, city_states, bs_parameters);
+    bool completed = packing_while_travelling::iterative_beam_search(
+            branching_scheme,
+            parameters.minimum_size_of_the_queue,
+            parameters.maximum_size_of_the_queue,
+            parameters.growth_factor,
+            [&parameters]() { return parameters.timer.needs_to_end(); },
+            [&instance, &distances, &city_states, &algorithm_formatter](
+                const std::shared_ptr<typename BranchingScheme<Distances>::Node>&,
+                const std::vector<std::pair<CityId, CityStateId>>& path,
+                Counter width)
+            {
+                Solution solution(distances, instance);
+                for (auto city: path) {
+                    CityId city_id = city.first;
+                    CityStateId city_state_id = city.second;
+                    solution.add_city(distances, city_id);
+                    for (ItemId item_id: city_states.item_ids(city_id, city_state_id)) {
+                        solution.add_item(distances, item_id);
+                    }
                 }
-            }
-            std::stringstream ss;
-            ss << "node " << bfs_output.number_of_nodes;
-            algorithm_formatter.update_solution(solution, ss.str());
-        };
-    treesearchsolver::best_first_search(branching_scheme, bfs_parameters);
+                std::stringstream ss;
+                ss << "queue size " << width;
+                algorithm_formatter.update_solution(solution, ss.str());
+            });
 
-    if (!parameters.timer.needs_to_end()) {
+    if (completed) {
         algorithm_formatter.update_bound(
                 output.solution.item_profit(),
-                "tree search completed");
+                "iterative beam search completed");
     }
 
     algorithm_formatter.end();
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "travellingthiefsolver/thief_orienteering/instance.hpp"
+#include "travellingthiefsolver/packing_while_travelling/generator.hpp"
+
+namespace travellingthiefsolver
+{
+namespace thief_orienteering
+{
+
+/**
+ * Generate a thief orienteering instance.
+ *
+ * The time limit is the time of the reference tour at maximum speed times the
+ * time limit factor.
+ */
+Instance generate_instance(
+        const packing_while_travelling::GeneratorParameters& parameters);
+
+}
+}
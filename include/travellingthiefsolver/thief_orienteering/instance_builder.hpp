@@ -30,6 +30,13 @@ public:
         instance_.distances_ = distances;
     }
 
+    /** Set the coordinates of the cities the distances are computed from. */
+    inline void set_coordinates(
+            const std::shared_ptr<const packing_while_travelling::CityCoordinates>& coordinates)
+    {
+        instance_.coordinates_ = coordinates;
+    }
+
     /** Set the minimum speed. */
     void set_minimum_speed(double minimum_speed) { instance_.speed_min_ = minimum_speed; }
 
@@ -68,6 +75,17 @@ private:
     /** Read an instance from a file in 'polyakovskiy2014' format. */
     void read_polyakovskiy2014(std::ifstream& file);
 
+    /**
+     * Read an instance from a file in 'polyakovskiy2014' format with the
+     * memory-mapped reader.
+     *
+     * Return 'false' if the file is not supported by this reader.
+     */
+    bool read_polyakovskiy2014(const std::string& instance_path);
+
+    /** Read an instance from a file in the binary format. */
+    void read_binary(const std::string& instance_path);
+
     /*
      * Private attributes
      */
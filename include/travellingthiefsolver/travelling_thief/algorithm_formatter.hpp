@@ -1,6 +1,7 @@
 #pragma once
 
 #include "travellingthiefsolver/travelling_thief/solution.hpp"
+#include "travellingthiefsolver/packing_while_travelling/profiling.hpp"
 
 namespace travellingthiefsolver
 {
@@ -18,7 +19,12 @@ public:
             Output& output):
         parameters_(parameters),
         output_(output),
-        os_(parameters.create_os()) { }
+        os_(parameters.create_os()),
+        intermediary_outputs_(parameters.intermediary_outputs_parameters)
+    {
+        if (packing_while_travelling::profiling::enabled)
+            profiling_start_ = packing_while_travelling::profiling::snapshot();
+    }
 
     /** Print the header. */
     void start(
@@ -55,6 +61,12 @@ private:
     /** Output stream. */
     std::unique_ptr<optimizationtools::ComposeStream> os_;
 
+    /** History of intermediary outputs. */
+    packing_while_travelling::IntermediaryOutputs intermediary_outputs_;
+
+    /** Measures of the profiler at the start of the algorithm. */
+    packing_while_travelling::profiling::Snapshot profiling_start_;
+
 };
 
 }
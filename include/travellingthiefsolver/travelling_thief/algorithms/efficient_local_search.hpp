@@ -28,6 +28,14 @@ struct EfficientLocalSearchParameters: Parameters
     /** LKH candidate file content. */
     std::string lkh_candidate_file_content;
 
+    /**
+     * City states of the instance; computed if 'nullptr'.
+     *
+     * They only depend on the items and on the capacity, so they can be
+     * reused between instances differing by their renting ratio.
+     */
+    const packing_while_travelling::CityStateTable* city_states = nullptr;
+
     /** Enable change-city-state neighborhood. */
     int neighborhood_change_city_state = -1;
 
@@ -48,6 +56,30 @@ struct EfficientLocalSearchParameters: Parameters
 
     /** Enable change-two-city-states neighborhood. */
     int neighborhood_change_two_city_states = 0;
+
+    /** Number of threads used to compute the city states. */
+    Counter number_of_threads = 1;
+
+
+    virtual int format_width() const override { return 31; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Parameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of threads: " << number_of_threads << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Parameters::to_json();
+        json.merge_patch({
+                {"NumberOfThreads", number_of_threads},
+                });
+        return json;
+    }
 };
 
 struct EfficientLocalSearchOutput: Output
@@ -74,6 +106,35 @@ struct EfficientLocalSearchOutput: Output
     Counter number_of_shift_change_city_state_improvements = 0;
 
     Counter number_of_change_two_city_states_improvements = 0;
+
+    /**
+     * LKH candidate file content, to be passed to the next runs on the same
+     * cities.
+     */
+    std::string lkh_candidate_file_content;
+
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Output::to_json();
+        json.merge_patch({
+                {"NumberOfLocalSearchCalls", number_of_local_search_calls},
+                {"NumberOfIterations", number_of_iterations},
+                {"NumberOfImprovements", number_of_improvements},
+                });
+        return json;
+    }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Output::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of local search calls: " << number_of_local_search_calls << std::endl
+            << std::setw(width) << std::left << "Number of iterations: " << number_of_iterations << std::endl
+            << std::setw(width) << std::left << "Number of improvements: " << number_of_improvements << std::endl
+            ;
+    }
 };
 
 const EfficientLocalSearchOutput efficient_local_search(
@@ -104,7 +165,7 @@ const EfficientLocalSearchOutput efficient_genetic_local_search(
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 
-using CityState = travellingthiefsolver::packing_while_travelling::CityState;
+using CityStateTable = travellingthiefsolver::packing_while_travelling::CityStateTable;
 using CityStateId = travellingthiefsolver::packing_while_travelling::CityStateId;
 
 struct EfficientLocalSearchSolutionCity
@@ -150,7 +211,7 @@ public:
     EfficientLocalSearchSolution(
             const Instance& instance,
             const Distances& distances,
-            const std::vector<std::vector<CityState>>& city_states,
+            const CityStateTable& city_states,
             const std::vector<CityId>& city_ids,
             const std::vector<CityStateId>& city_state_ids);
 
@@ -162,7 +223,7 @@ public:
     inline const Instance& instance() const { return *instance_; }
 
     /** Get city states. */
-    inline const std::vector<std::vector<CityState>>& city_states() const { return *city_states_; }
+    inline const CityStateTable& city_states() const { return *city_states_; }
 
     /** Get the number of visited cities. */
     CityId number_of_cities() const { return visits_.size(); }
@@ -215,7 +276,7 @@ public:
             CityId city_id = visit(city_pos).city_id;
             CityStateId city_state_id = city(city_id).city_state_id;
             solution.add_city(distances, city_id);
-            for (ItemId item_id: city_states()[city_id][city_state_id].item_ids)
+            for (ItemId item_id: city_states().item_ids(city_id, city_state_id))
                 solution.add_item(distances, item_id);
         }
         return solution;
@@ -232,7 +293,7 @@ private:
     const Instance* instance_;
 
     /** City states. */
-    const std::vector<std::vector<CityState>>* city_states_;
+    const CityStateTable* city_states_;
 
     /** Visits in the order they are performed. */
     std::vector<EfficientLocalSearchSolutionVisit> visits_;
@@ -261,7 +322,7 @@ template <typename Distances>
 EfficientLocalSearchSolution::EfficientLocalSearchSolution(
         const Instance& instance,
         const Distances& distances,
-        const std::vector<std::vector<CityState>>& city_states,
+        const CityStateTable& city_states,
         const std::vector<CityId>& city_ids,
         const std::vector<CityStateId>& city_state_ids):
     instance_(&instance),
@@ -278,16 +339,16 @@ EfficientLocalSearchSolution::EfficientLocalSearchSolution(
             ++city_pos) {
         CityId city_id = city_ids[city_pos];
         CityStateId city_state_id = city_state_ids[city_id];
-        if (city_state_id >= (CityStateId)city_states[city_id].size()) {
+        if (city_state_id >= city_states.number_of_states(city_id)) {
             std::cout << "city_pos " << city_pos
                 << " city_id " << city_id
                 << " city_state_id " << city_state_id
-                << " / " << city_states[city_id].size()
+                << " / " << city_states.number_of_states(city_id)
                 << std::endl;
             throw std::runtime_error(
-                    "city_state_id >= (CityStateId)city_states[city_id].size()");
+                    "city_state_id >= city_states.number_of_states(city_id)");
         }
-        const CityState& city_state = city_states[city_id][city_state_id];
+        const CityStateTable::State city_state = city_states.state(city_id, city_state_id);
 
         const EfficientLocalSearchSolutionVisit& visit_prev = this->visit(city_pos - 1);
 
@@ -387,7 +448,7 @@ public:
     EfficientLocalScheme(
             const Instance& instance,
             const Distances& distances,
-            const std::vector<std::vector<CityState>>& city_states,
+            const CityStateTable& city_states,
             const EfficientLocalSearchParameters& parameters,
             EfficientLocalSearchOutput& output,
             AlgorithmFormatter& algorithm_formatter,
@@ -578,12 +639,6 @@ public:
     {
     }
 
-private:
-
-    /*
-     * Manipulate solutions.
-     */
-
     /*
      * Evaluate moves.
      */
@@ -660,6 +715,12 @@ private:
             const EfficientLocalSearchSolution& solution,
             CityId city_id_1);
 
+private:
+
+    /*
+     * Manipulate solutions.
+     */
+
     /*
      * Private attributes.
      */
@@ -671,7 +732,7 @@ private:
     const Distances& distances_;
 
     /** City states. */
-    const std::vector<std::vector<CityState>>& city_states_;
+    const CityStateTable& city_states_;
 
     /** TSP instance. */
     travelingsalesmansolver::Instance tsp_instance_;
@@ -703,7 +764,7 @@ template <typename Distances>
 EfficientLocalScheme<Distances>::EfficientLocalScheme(
         const Instance& instance,
         const Distances& distances,
-        const std::vector<std::vector<CityState>>& city_states,
+        const CityStateTable& city_states,
         const EfficientLocalSearchParameters& parameters,
         EfficientLocalSearchOutput& output,
         AlgorithmFormatter& algorithm_formatter,
@@ -720,6 +781,7 @@ EfficientLocalScheme<Distances>::EfficientLocalScheme(
     if (parameters.lkh_candidate_file_content.empty())
         generate_initial_solutions(generator);
     lkh_candidates_ = travelingsalesmansolver::read_candidates(lkh_candidate_file_content_);
+    output_.lkh_candidate_file_content = lkh_candidate_file_content_;
 
     // Generate moves.
     // Change city state.
@@ -730,7 +792,7 @@ EfficientLocalScheme<Distances>::EfficientLocalScheme(
                 city_id < instance.number_of_cities();
                 ++city_id) {
             for (CityStateId city_state_id = 0;
-                    city_state_id < (CityStateId)city_states[city_id].size();
+                    city_state_id < city_states.number_of_states(city_id);
                     ++city_state_id) {
                 Move move;
                 move.type = MoveType::ChangeCityState;
@@ -793,7 +855,7 @@ EfficientLocalScheme<Distances>::EfficientLocalScheme(
                 city_id < instance.number_of_cities();
                 ++city_id) {
             for (CityStateId city_state_id = 0;
-                    city_state_id < (CityId)city_states[city_id].size();
+                    city_state_id < city_states.number_of_states(city_id);
                     ++city_state_id) {
                 Move move;
                 move.type = MoveType::ShiftChangeCityState;
@@ -838,6 +900,7 @@ void EfficientLocalScheme<Distances>::local_search(
         std::mt19937_64& generator,
         Perturbation)
 {
+    PROFILING_SCOPE("TtpEfficientLocalSearch");
     //std::cout << "local_search..." << std::endl;
     std::vector<CityId> city_ids;
     std::vector<CityStateId> city_state_ids(instance_.number_of_cities(), -1);
@@ -864,6 +927,16 @@ void EfficientLocalScheme<Distances>::local_search(
 
         Counter number_of_improvements = 0;
 
+        // The evaluations are counted in local variables and added to the
+        // profiling counters once per pass rather than on each evaluation.
+        Counter number_of_change_city_state_evaluations = 0;
+        Counter number_of_two_opt_evaluations = 0;
+        Counter number_of_two_opt_change_city_states_evaluations = 0;
+        Counter number_of_shift_evaluations = 0;
+        Counter number_of_shift_change_city_state_evaluations = 0;
+        Counter number_of_shift_change_city_state_2_evaluations = 0;
+        Counter number_of_change_two_city_states_evaluations = 0;
+
         for (std::vector<Move>& moves: moves_) {
 
             // Shuffle moves.
@@ -873,6 +946,7 @@ void EfficientLocalScheme<Distances>::local_search(
 
                 if (move.type == MoveType::ChangeCityState) {
 
+                    number_of_change_city_state_evaluations++;
                     auto output = evaluate_change_city_state_move(
                             solution,
                             move.city_id,
@@ -911,6 +985,7 @@ void EfficientLocalScheme<Distances>::local_search(
 
                 } else if (move.type == MoveType::TwoOpt) {
 
+                    number_of_two_opt_evaluations++;
                     Profit objective_new = evaluate_two_opt_move(
                             solution,
                             move.city_id,
@@ -965,6 +1040,7 @@ void EfficientLocalScheme<Distances>::local_search(
 
                 } else if (move.type == MoveType::TwoOptChangeCityStates) {
 
+                    number_of_two_opt_change_city_states_evaluations++;
                     auto output = evaluate_two_opt_change_city_states_move(
                             solution,
                             move.city_id,
@@ -980,7 +1056,7 @@ void EfficientLocalScheme<Distances>::local_search(
                                 ++city_pos) {
                             CityId city_id = solution.visit(city_pos).city_id;
                             city_ids_new.push_back(city_id);
-                            profit += city_states_[city_id][city_state_ids[city_id]].total_profit;
+                            profit += city_states_.total_profit(city_id, city_state_ids[city_id]);
                         }
                         CityPos x = 0;
                         for (CityPos city_pos = city_pos_2;
@@ -996,7 +1072,7 @@ void EfficientLocalScheme<Distances>::local_search(
                                 ++city_pos) {
                             CityId city_id = solution.visit(city_pos).city_id;
                             city_ids_new.push_back(city_id);
-                            profit += city_states_[city_id][city_state_ids[city_id]].total_profit;
+                            profit += city_states_.total_profit(city_id, city_state_ids[city_id]);
                         }
                         if ((CityPos)city_ids_new.size() != instance_.number_of_cities()) {
                             throw std::runtime_error(
@@ -1031,6 +1107,7 @@ void EfficientLocalScheme<Distances>::local_search(
 
                 } else if (move.type == MoveType::Shift) {
 
+                    number_of_shift_evaluations++;
                     auto output = evaluate_shift_move(
                             solution,
                             move.city_id);
@@ -1078,6 +1155,7 @@ void EfficientLocalScheme<Distances>::local_search(
 
                 } else if (move.type == MoveType::ShiftChangeCityState) {
 
+                    number_of_shift_change_city_state_evaluations++;
                     auto output = evaluate_shift_change_city_state_move(
                             solution,
                             move.city_id,
@@ -1129,6 +1207,7 @@ void EfficientLocalScheme<Distances>::local_search(
 
                 } else if (move.type == MoveType::ShiftChangeCityState2) {
 
+                    number_of_shift_change_city_state_2_evaluations++;
                     auto output = evaluate_shift_change_city_state_2_move(
                             solution,
                             move.city_id);
@@ -1191,6 +1270,7 @@ void EfficientLocalScheme<Distances>::local_search(
 
                 } else if (move.type == MoveType::ChangeTwoCtiyStates) {
 
+                    number_of_change_two_city_states_evaluations++;
                     auto output = evaluate_change_two_city_states_move(
                             solution,
                             move.city_id);
@@ -1230,6 +1310,14 @@ void EfficientLocalScheme<Distances>::local_search(
                 break;
         }
 
+        PROFILING_COUNT("TtpEfficientLocalSearchChangeCityStateEvaluations", number_of_change_city_state_evaluations);
+        PROFILING_COUNT("TtpEfficientLocalSearchTwoOptEvaluations", number_of_two_opt_evaluations);
+        PROFILING_COUNT("TtpEfficientLocalSearchTwoOptChangeCityStatesEvaluations", number_of_two_opt_change_city_states_evaluations);
+        PROFILING_COUNT("TtpEfficientLocalSearchShiftEvaluations", number_of_shift_evaluations);
+        PROFILING_COUNT("TtpEfficientLocalSearchShiftChangeCityStateEvaluations", number_of_shift_change_city_state_evaluations);
+        PROFILING_COUNT("TtpEfficientLocalSearchShiftChangeCityState2Evaluations", number_of_shift_change_city_state_2_evaluations);
+        PROFILING_COUNT("TtpEfficientLocalSearchChangeTwoCityStatesEvaluations", number_of_change_two_city_states_evaluations);
+
         //std::cout << number_of_improvements << std::endl;
         //std::cout << solution_objective << std::endl;
         if (number_of_improvements == 0)
@@ -1255,11 +1343,11 @@ EfficientLocalScheme<Distances>::evaluate_change_city_state_move(
             -std::numeric_limits<Profit>::infinity()};
     }
     Profit profit_new = solution.profit()
-        - city_states_[city_id][city_state_id_cur].total_profit
-        + city_states_[city_id][city_state_id].total_profit;
+        - city_states_.total_profit(city_id, city_state_id_cur)
+        + city_states_.total_profit(city_id, city_state_id);
     Weight weight_new = solution.weight()
-        - city_states_[city_id][city_state_id_cur].total_weight
-        + city_states_[city_id][city_state_id].total_weight;
+        - city_states_.total_weight(city_id, city_state_id_cur)
+        + city_states_.total_weight(city_id, city_state_id);
     Weight overweight_new = std::max(
             (Weight)0,
             weight_new - instance_.capacity());
@@ -1270,8 +1358,8 @@ EfficientLocalScheme<Distances>::evaluate_change_city_state_move(
     }
     CityPos city_pos = solution.city(city_id).position;
     Weight weight_diff =
-        - city_states_[city_id][city_state_id_cur].total_weight
-        + city_states_[city_id][city_state_id].total_weight;
+        - city_states_.total_weight(city_id, city_state_id_cur)
+        + city_states_.total_weight(city_id, city_state_id);
     Time time_cur = 0;
 
     if (city_state_id > city_state_id_cur) {
@@ -1434,7 +1522,7 @@ Profit EfficientLocalScheme<Distances>::evaluate_two_opt_move(
         CityId city_id_4 = solution.visit(city_pos_4).city_id;
         CityId city_id_3 = solution.visit(city_pos_4 + 1).city_id;
         CityStateId city_state_id_4 = solution.city(city_id_4).city_state_id;
-        weight_cur -= city_states_[city_id_4][city_state_id_4].total_weight;
+        weight_cur -= city_states_.total_weight(city_id_4, city_state_id_4);
         time_cur += instance_.duration(
                 distances_,
                 city_id_3,
@@ -1530,9 +1618,9 @@ EfficientLocalScheme<Distances>::evaluate_two_opt_change_city_states_move(
             --city_pos_3) {
         CityId city_id_3 = solution.visit(city_pos_3).city_id;
         for (CityStateId city_state_id_3 = 1;
-                city_state_id_3 < (CityStateId)city_states_[city_id_3].size();
+                city_state_id_3 < city_states_.number_of_states(city_id_3);
                 ++city_state_id_3) {
-            const CityState& city_state = city_states_[city_id_3][city_state_id_3];
+            const CityStateTable::State city_state = city_states_.state(city_id_3, city_state_id_3);
             TwoOptChangeCityStatesStruct s;
             s.city_pos = city_pos;
             s.city_pos_3 = city_pos_3;
@@ -1568,7 +1656,7 @@ EfficientLocalScheme<Distances>::evaluate_two_opt_change_city_states_move(
                 p < (CityPos)weights_cur.size();
                 ++p) {
             if (weights_cur[p]
-                    - city_states_[s.city_id][city_state_id_cur].total_weight
+                    - city_states_.total_weight(s.city_id, city_state_id_cur)
                     + s.weight
                     > solution.visit(city_pos_1 + 1 + p).weight_from_start) {
                 ok = false;
@@ -1589,7 +1677,7 @@ EfficientLocalScheme<Distances>::evaluate_two_opt_change_city_states_move(
                 p < (CityPos)weights_cur.size();
                 ++p) {
             weights_cur[p] += s.weight
-                - city_states_[s.city_id][city_state_id_cur].total_weight;
+                - city_states_.total_weight(s.city_id, city_state_id_cur);
         }
         city_state_ids_cur[pos] = s.city_state_id;
     }
@@ -1604,8 +1692,8 @@ EfficientLocalScheme<Distances>::evaluate_two_opt_change_city_states_move(
         CityId city_id_3 = solution.visit(city_pos_4 + 1).city_id;
         CityStateId city_state_id_3 = city_state_ids_cur[city_state_ids_new.size()];
         city_state_ids_new.push_back(city_state_id_3);
-        weight_cur += city_states_[city_id_3][city_state_id_3].total_weight;
-        profit_new += city_states_[city_id_3][city_state_id_3].total_profit;
+        weight_cur += city_states_.total_weight(city_id_3, city_state_id_3);
+        profit_new += city_states_.total_profit(city_id_3, city_state_id_3);
         time_cur += instance_.duration(
                 distances_,
                 city_id_3,
@@ -1636,8 +1724,8 @@ EfficientLocalScheme<Distances>::evaluate_two_opt_change_city_states_move(
             solution.visit(city_pos_2 + 1).city_id;
         CityStateId city_state_id_3 = city_state_ids_cur[city_state_ids_new.size()];
         city_state_ids_new.push_back(city_state_id_3);
-        weight_cur += city_states_[city_id_3][city_state_id_3].total_weight;
-        profit_new += city_states_[city_id_3][city_state_id_3].total_profit;
+        weight_cur += city_states_.total_weight(city_id_3, city_state_id_3);
+        profit_new += city_states_.total_profit(city_id_3, city_state_id_3);
         time_cur += instance_.duration(
                 distances_,
                 city_id_3,
@@ -1712,7 +1800,7 @@ EfficientLocalScheme<Distances>::evaluate_shift_move(
         const EfficientLocalSearchSolution& solution,
         CityId city_id)
 {
-    const CityState& city_state = city_states_[city_id][solution.city(city_id).city_state_id];
+    const CityStateTable::State city_state = city_states_.state(city_id, solution.city(city_id).city_state_id);
 
     std::vector<Time> time_from_start = {0};
     std::vector<Weight> weight_from_start = {0};
@@ -1724,7 +1812,7 @@ EfficientLocalScheme<Distances>::evaluate_shift_move(
         CityId city_id_cur = solution.visit(city_pos).city_id;
         if (city_id_cur == city_id)
             continue;
-        const CityState& city_state_cur = city_states_[city_id_cur][solution.city(city_id_cur).city_state_id];
+        const CityStateTable::State city_state_cur = city_states_.state(city_id_cur, solution.city(city_id_cur).city_state_id);
         city_ids.push_back(city_id_cur);
         time_from_start.push_back(time_from_start.back() + instance_.duration(
                     distances_,
@@ -1786,8 +1874,8 @@ EfficientLocalScheme<Distances>::evaluate_shift_change_city_state_move(
         CityId city_id,
         CityStateId city_state_id)
 {
-    const CityState& city_state_old = city_states_[city_id][solution.city(city_id).city_state_id];
-    const CityState& city_state = city_states_[city_id][city_state_id];
+    const CityStateTable::State city_state_old = city_states_.state(city_id, solution.city(city_id).city_state_id);
+    const CityStateTable::State city_state = city_states_.state(city_id, city_state_id);
     Weight weight_new = solution.weight()
         - city_state_old.total_weight
         + city_state.total_weight;
@@ -1813,7 +1901,7 @@ EfficientLocalScheme<Distances>::evaluate_shift_change_city_state_move(
         CityId city_id_cur = solution.visit(city_pos).city_id;
         if (city_id_cur == city_id)
             continue;
-        const CityState& city_state_cur = city_states_[city_id_cur][solution.city(city_id_cur).city_state_id];
+        const CityStateTable::State city_state_cur = city_states_.state(city_id_cur, solution.city(city_id_cur).city_state_id);
         city_ids.push_back(city_id_cur);
         time_from_start.push_back(time_from_start.back() + instance_.duration(
                     distances_,
@@ -1877,7 +1965,7 @@ EfficientLocalScheme<Distances>::evaluate_shift_change_city_state_2_move(
         const EfficientLocalSearchSolution& solution,
         CityId city_id)
 {
-    const CityState& city_state_old = city_states_[city_id][solution.city(city_id).city_state_id];
+    const CityStateTable::State city_state_old = city_states_.state(city_id, solution.city(city_id).city_state_id);
 
     Profit objective_best = solution.objective();
     CityPos city_pos_best = -1;
@@ -1885,7 +1973,7 @@ EfficientLocalScheme<Distances>::evaluate_shift_change_city_state_2_move(
     Weight overweight_best = solution.overweight();
 
     for (CityStateId city_state_id = 0;
-            city_state_id < (CityStateId)city_states_[city_id].size();
+            city_state_id < city_states_.number_of_states(city_id);
             ++city_state_id) {
         auto output = evaluate_change_city_state_move(
                 solution,
@@ -1911,10 +1999,10 @@ EfficientLocalScheme<Distances>::evaluate_shift_change_city_state_2_move(
     }
 
     for (CityStateId city_state_id = 0;
-            city_state_id < (CityStateId)city_states_[city_id].size();
+            city_state_id < city_states_.number_of_states(city_id);
             ++city_state_id) {
 
-        const CityState& city_state = city_states_[city_id][city_state_id];
+        const CityStateTable::State city_state = city_states_.state(city_id, city_state_id);
         Weight weight_new = solution.weight()
             - city_state_old.total_weight
             + city_state.total_weight;
@@ -1937,7 +2025,7 @@ EfficientLocalScheme<Distances>::evaluate_shift_change_city_state_2_move(
             CityId city_id_cur = solution.visit(city_pos).city_id;
             if (city_id_cur == city_id)
                 continue;
-            const CityState& city_state_cur = city_states_[city_id_cur][solution.city(city_id_cur).city_state_id];
+            const CityStateTable::State city_state_cur = city_states_.state(city_id_cur, solution.city(city_id_cur).city_state_id);
             city_ids.push_back(city_id_cur);
             time_from_start.push_back(time_from_start.back() + instance_.duration(
                         distances_,
@@ -2013,7 +2101,7 @@ EfficientLocalScheme<Distances>::evaluate_change_two_city_states_move(
 {
     CityPos city_pos_1 = solution.city(city_id_1).position;
     CityStateId city_state_id_1_cur = solution.city(city_id_1).city_state_id;
-    const CityState& city_state_1_cur = city_states_[city_id_1][city_state_id_1_cur];
+    const CityStateTable::State city_state_1_cur = city_states_.state(city_id_1, city_state_id_1_cur);
 
     CityPos city_id_2_best = -1;
     CityStateId city_state_id_1_best = -1;
@@ -2026,16 +2114,16 @@ EfficientLocalScheme<Distances>::evaluate_change_two_city_states_move(
 
         CityId city_id_2 = solution.visit(city_pos_2).city_id;
         CityStateId city_state_id_2_cur = solution.city(city_id_2).city_state_id;
-        const CityState& city_state_2_cur = city_states_[city_id_2][city_state_id_2_cur];
+        const CityStateTable::State city_state_2_cur = city_states_.state(city_id_2, city_state_id_2_cur);
 
         for (CityStateId city_state_id_1 = 0;
                 city_state_id_1 < city_state_id_1_cur;
                 ++city_state_id_1) {
-            const CityState& city_state_1 = city_states_[city_id_1][city_state_id_1];
+            const CityStateTable::State city_state_1 = city_states_.state(city_id_1, city_state_id_1);
             for (CityStateId city_state_id_2 = city_state_id_2_cur + 1;
-                    city_state_id_2 < (CityStateId)city_states_[city_id_2].size();
+                    city_state_id_2 < city_states_.number_of_states(city_id_2);
                     ++city_state_id_2) {
-                const CityState& city_state_2 = city_states_[city_id_2][city_state_id_2];
+                const CityStateTable::State city_state_2 = city_states_.state(city_id_2, city_state_id_2);
                 if (solution.weight()
                         - city_state_1_cur.total_weight
                         - city_state_2_cur.total_weight
@@ -2213,9 +2301,9 @@ EfficientLocalScheme<Distances>::evaluate_change_two_city_states_move(
 
     CityPos city_pos_2 = solution.city(city_id_2_best).position;
     CityStateId city_state_id_2_cur = solution.city(city_id_2_best).city_state_id;
-    const CityState& city_state_2_cur = city_states_[city_id_2_best][city_state_id_2_cur];
-    const CityState& city_state_1 = city_states_[city_id_1][city_state_id_1_best];
-    const CityState& city_state_2 = city_states_[city_id_2_best][city_state_id_2_best];
+    const CityStateTable::State city_state_2_cur = city_states_.state(city_id_2_best, city_state_id_2_cur);
+    const CityStateTable::State city_state_1 = city_states_.state(city_id_1, city_state_id_1_best);
+    const CityStateTable::State city_state_2 = city_states_.state(city_id_2_best, city_state_id_2_best);
 
     Profit profit_new = solution.profit()
         - city_state_1_cur.total_profit
@@ -2300,14 +2388,14 @@ void EfficientLocalScheme<Distances>::apply_perturbation(
         CityId city_id = d_city(generator);
 
         // Draw city state.
-        std::uniform_int_distribution<CityStateId> d(0, city_states_[city_id].size() - 2);
+        std::uniform_int_distribution<CityStateId> d(0, city_states_.number_of_states(city_id) - 2);
         CityStateId city_state_id = d(generator);
         if (city_state_id >= solution.city(city_id).city_state_id)
             city_state_id++;
 
-        weight -= city_states_[city_id][city_state_ids[city_id]].total_weight;
+        weight -= city_states_.total_weight(city_id, city_state_ids[city_id]);
         city_state_ids[city_id] = city_state_id;
-        weight += city_states_[city_id][city_state_ids[city_id]].total_weight;
+        weight += city_states_.total_weight(city_id, city_state_ids[city_id]);
     }
     // Fix overweight.
     while (weight > instance_.capacity()) {
@@ -2317,9 +2405,9 @@ void EfficientLocalScheme<Distances>::apply_perturbation(
         if (city_state_ids[city_id] == 0)
             continue;
 
-        weight -= city_states_[city_id][city_state_ids[city_id]].total_weight;
+        weight -= city_states_.total_weight(city_id, city_state_ids[city_id]);
         city_state_ids[city_id]--;
-        weight += city_states_[city_id][city_state_ids[city_id]].total_weight;
+        weight += city_states_.total_weight(city_id, city_state_ids[city_id]);
     }
 
     // Draw 5 random two-opt moves.
@@ -2537,7 +2625,16 @@ const EfficientLocalSearchOutput efficient_local_search(
     algorithm_formatter.start("Efficient local search");
     algorithm_formatter.print_header();
 
-    auto city_states = packing_while_travelling::compute_city_states<Instance>(instance);
+    packing_while_travelling::CityStateTable computed_city_states;
+    if (parameters.city_states == nullptr) {
+        computed_city_states = packing_while_travelling::compute_city_state_table<Instance>(
+                instance,
+                parameters.number_of_threads);
+    }
+    const packing_while_travelling::CityStateTable& city_states
+        = (parameters.city_states != nullptr)?
+        *parameters.city_states:
+        computed_city_states;
 
     EfficientLocalScheme<Distances> local_scheme(
             instance,
@@ -2592,7 +2689,16 @@ const EfficientLocalSearchOutput efficient_genetic_local_search(
     algorithm_formatter.start("Efficient genetic local search");
     algorithm_formatter.print_header();
 
-    auto city_states = packing_while_travelling::compute_city_states<Instance>(instance);
+    packing_while_travelling::CityStateTable computed_city_states;
+    if (parameters.city_states == nullptr) {
+        computed_city_states = packing_while_travelling::compute_city_state_table<Instance>(
+                instance,
+                parameters.number_of_threads);
+    }
+    const packing_while_travelling::CityStateTable& city_states
+        = (parameters.city_states != nullptr)?
+        *parameters.city_states:
+        computed_city_states;
 
     EfficientLocalScheme<Distances> local_scheme(
             instance,
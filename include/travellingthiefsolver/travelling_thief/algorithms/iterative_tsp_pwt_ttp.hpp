@@ -5,6 +5,7 @@
 #include "travellingthiefsolver/travelling_thief/algorithm_formatter.hpp"
 #include "travellingthiefsolver/travelling_thief/utils.hpp"
 #include "travellingthiefsolver/travelling_thief/algorithms/efficient_local_search.hpp"
+#include "travellingthiefsolver/travelling_thief/algorithms/window_repair.hpp"
 #include "travellingthiefsolver/packing_while_travelling/instance_builder.hpp"
 #include "travellingthiefsolver/packing_while_travelling/algorithms/sequential_value_correction.hpp"
 #include "travellingthiefsolver/packing_while_travelling/algorithms/efficient_local_search.hpp"
@@ -20,6 +21,39 @@ struct IterativeTspPwtTtpParameters: Parameters
 {
     /** Maximum number of iterations. */
     Counter maximum_number_of_iterations = -1;
+
+    /**
+     * Size of the windows of the window repair run after each TTP-ELS.
+     *
+     * If it is smaller than 2, the window repair is disabled.
+     */
+    Counter window_repair_window_size = 0;
+
+    /** Number of threads of the window repair. */
+    Counter number_of_threads = 1;
+
+
+    virtual int format_width() const override { return 30; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Parameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Window repair window size: " << window_repair_window_size << std::endl
+            << std::setw(width) << std::left << "Number of threads: " << number_of_threads << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Parameters::to_json();
+        json.merge_patch({
+                {"WindowRepairWindowSize", window_repair_window_size},
+                {"NumberOfThreads", number_of_threads},
+                });
+        return json;
+    }
 };
 
 struct IterativeTspPwtTtpOutput: Output
@@ -35,6 +69,9 @@ struct IterativeTspPwtTtpOutput: Output
     /** Number of efficient local search calls. */
     Counter number_of_els_calls = 0;
 
+    /** Number of window repair calls. */
+    Counter number_of_window_repair_calls = 0;
+
     /** Time spent in TSP. */
     double tsp_time = 0.0;
 
@@ -82,6 +119,34 @@ const IterativeTspPwtTtpOutput iterative_tsp_pwt_ttp(
     std::vector<Solution> svc_solutions;
     Counter svc_solutions_size = 10;
 
+    // The city states only depend on the instance, so they are computed once
+    // for all the TTP-ELS and window repair calls.
+    auto city_states = packing_while_travelling::compute_city_state_table<Instance>(
+            instance,
+            parameters.number_of_threads);
+
+    // Polish a TTP-ELS solution with the window repair.
+    auto polish = [&distances, &instance, &parameters, &output, &algorithm_formatter, &city_states](
+            const Solution& solution,
+            const std::string& s)
+    {
+        if (parameters.window_repair_window_size < 2)
+            return;
+        WindowRepairParameters window_repair_parameters;
+        window_repair_parameters.timer = parameters.timer;
+        window_repair_parameters.verbosity_level = 0;
+        window_repair_parameters.initial_solution = &solution;
+        window_repair_parameters.city_states = &city_states;
+        window_repair_parameters.window_size = parameters.window_repair_window_size;
+        window_repair_parameters.number_of_threads = parameters.number_of_threads;
+        auto window_repair_output = window_repair(
+                distances,
+                instance,
+                window_repair_parameters);
+        output.number_of_window_repair_calls++;
+        algorithm_formatter.update_solution(window_repair_output.solution, s);
+    };
+
     for (Counter i = 0; i < 5; ++i) {
 
         auto tsp_begin = std::chrono::steady_clock::now();
@@ -197,6 +262,7 @@ const IterativeTspPwtTtpOutput iterative_tsp_pwt_ttp(
         ttpels_parameters.verbosity_level = 0;
         ttpels_parameters.initial_solution = &els_solution;
         ttpels_parameters.lkh_candidate_file_content = lkh_candidate_file_content;
+        ttpels_parameters.city_states = &city_states;
         auto ttpels_output = efficient_local_search(
                 instance,
                 generator,
@@ -206,6 +272,7 @@ const IterativeTspPwtTtpOutput iterative_tsp_pwt_ttp(
         {
             algorithm_formatter.update_solution(ttpels_output.solution, "initial ttpels");
         }
+        polish(ttpels_output.solution, "initial window repair");
 
         auto ttp_end = std::chrono::steady_clock::now();
         std::chrono::duration<double> ttp_time_span
@@ -324,6 +391,7 @@ const IterativeTspPwtTtpOutput iterative_tsp_pwt_ttp(
                 ttpels_parameters.verbosity_level = 0;
                 ttpels_parameters.initial_solution = &els_solution;
                 ttpels_parameters.lkh_candidate_file_content = lkh_candidate_file_content;
+                ttpels_parameters.city_states = &city_states;
                 auto ttpels_output = efficient_local_search(
                         instance,
                         generator,
@@ -335,6 +403,11 @@ const IterativeTspPwtTtpOutput iterative_tsp_pwt_ttp(
                     ss << "iteration " << number_of_iterations << " (ttpels)";
                     algorithm_formatter.update_solution(ttpels_output.solution, ss.str());
                 }
+                {
+                    std::stringstream ss;
+                    ss << "iteration " << number_of_iterations << " (window repair)";
+                    polish(ttpels_output.solution, ss.str());
+                }
 
                 auto ttp_end = std::chrono::steady_clock::now();
                 std::chrono::duration<double> ttp_time_span
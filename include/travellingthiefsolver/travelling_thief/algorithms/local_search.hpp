@@ -123,7 +123,7 @@ public:
     SequencingScheme(
             const Instance& instance,
             const Distances& distances,
-            const std::vector<std::vector<travellingthiefsolver::packing_while_travelling::CityState>>& city_states):
+            const travellingthiefsolver::packing_while_travelling::CityStateTable& city_states):
         instance_(instance),
         distances_(distances),
         city_states_(city_states)
@@ -141,7 +141,7 @@ public:
 
     inline localsearchsolver::sequencing::Mode number_of_modes(localsearchsolver::sequencing::ElementId element_id) const
     {
-        return city_states_[element_id + 1].size();
+        return city_states_.number_of_states(element_id + 1);
     }
 
     inline SequenceData empty_sequence_data(localsearchsolver::sequencing::SequenceId) const
@@ -182,11 +182,11 @@ public:
                 element_id + 1,
                 sequence_data.weight);
         // Update weight
-        sequence_data.weight += city_states_[element_id + 1][mode].total_weight;
+        sequence_data.weight += city_states_.total_weight(element_id + 1, mode);
         // Update profit
-        sequence_data.profit += city_states_[element_id + 1][mode].total_profit;
+        sequence_data.profit += city_states_.total_profit(element_id + 1, mode);
         // Update remaining_profit.
-        sequence_data.remaining_profit -= city_states_[element_id + 1].back().total_profit;
+        sequence_data.remaining_profit -= city_states_.maximum_total_profit(element_id + 1);
         // Update time_full.
         sequence_data.time_full = sequence_data.time
             + instance_.duration(distances_, element_id + 1, 0, sequence_data.weight);
@@ -203,7 +203,7 @@ private:
     const Distances& distances_;
 
     /** City states. */
-    const std::vector<std::vector<travellingthiefsolver::packing_while_travelling::CityState>>& city_states_;
+    const travellingthiefsolver::packing_while_travelling::CityStateTable& city_states_;
 
     Profit total_profit_ = 0;
 
@@ -220,7 +220,9 @@ const Output local_search(
     algorithm_formatter.start("Local search");
     algorithm_formatter.print_header();
 
-    auto city_states = packing_while_travelling::compute_city_states<Instance>(instance);
+    auto city_states = packing_while_travelling::compute_city_state_table<Instance>(
+            instance,
+            parameters.number_of_threads);
 
     //for (CityId city_id = 0; city_id < instance.number_of_cities(); ++city_id) {
     //    std::cout << "city_id " << city_id << std::endl;
@@ -254,7 +256,7 @@ const Output local_search(
             for (auto se: solution.sequences[0].elements) {
                 CityId city_id = se.element_id + 1;
                 sol.add_city(city_id);
-                for (ItemId item_id: city_states[city_id][se.mode].item_ids) {
+                for (ItemId item_id: city_states.item_ids(city_id, se.mode)) {
                     sol.add_item(item_id);
                 }
             }
@@ -278,7 +280,7 @@ const Output local_search(
             for (auto se: lss_output.solution_pool.best().sequences[0].elements) {
                 CityId city_id = se.element_id + 1;
                 solution.add_city(distances, city_id);
-                for (ItemId item_id: city_states[city_id][se.mode].item_ids) {
+                for (ItemId item_id: city_states.item_ids(city_id, se.mode)) {
                     solution.add_item(distances, item_id);
                 }
             }
@@ -3,14 +3,193 @@
 #include "travellingthiefsolver/travelling_thief/solution.hpp"
 
 #include "travellingthiefsolver/travelling_thief/algorithm_formatter.hpp"
+#include "travellingthiefsolver/packing_while_travelling/iterative_beam_search.hpp"
+#include "travellingthiefsolver/packing_while_travelling/memory_pool.hpp"
+#include "travellingthiefsolver/packing_while_travelling/tree_search_overflow_policy.hpp"
 
 #include "treesearchsolver/best_first_search.hpp"
 
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
 namespace travellingthiefsolver
 {
 namespace travelling_thief
 {
 
+struct TreeSearchParameters: Parameters
+{
+    /** Number of threads of the best-first search. */
+    Counter number_of_threads = 1;
+
+    /**
+     * Number of candidate neighbours of each city.
+     *
+     * If positive, the children of a node only visit the candidate
+     * neighbours of its last visited city, and the search is not exact
+     * anymore.
+     */
+    CityId number_of_candidates = -1;
+
+    /**
+     * LKH candidate file content of the cities.
+     *
+     * If non-empty, the candidate neighbours of a city are its first LKH
+     * candidates; otherwise, they are its closest cities.
+     */
+    std::string lkh_candidate_file_content;
+
+    /** Maximum number of nodes in the queue. */
+    Counter maximum_number_of_nodes = -1;
+
+    /**
+     * Maximum number of bytes used by the search, estimated from the size of
+     * the nodes and of the structures kept for each node created.
+     */
+    Counter maximum_number_of_bytes = -1;
+
+    /** Policy applied when the budget is reached. */
+    packing_while_travelling::TreeSearchOverflowPolicy overflow_policy
+        = packing_while_travelling::TreeSearchOverflowPolicy::Stop;
+
+
+    virtual int format_width() const override { return 25; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Parameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of threads: " << number_of_threads << std::endl
+            << std::setw(width) << std::left << "Number of candidates: " << number_of_candidates << std::endl
+            << std::setw(width) << std::left << "Maximum number of nodes: " << maximum_number_of_nodes << std::endl
+            << std::setw(width) << std::left << "Maximum number of bytes: " << maximum_number_of_bytes << std::endl
+            << std::setw(width) << std::left << "Overflow policy: " << overflow_policy << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Parameters::to_json();
+        json.merge_patch({
+                {"NumberOfThreads", number_of_threads},
+                {"NumberOfCandidates", number_of_candidates},
+                {"MaximumNumberOfNodes", maximum_number_of_nodes},
+                {"MaximumNumberOfBytes", maximum_number_of_bytes},
+                {"OverflowPolicy", packing_while_travelling::to_string(overflow_policy)},
+                });
+        return json;
+    }
+};
+
+struct TreeSearchOutput: Output
+{
+    TreeSearchOutput(
+            const Instance& instance):
+        Output(instance) { }
+
+
+    /** Number of nodes created. */
+    Counter number_of_nodes = 0;
+
+    /** Maximum number of nodes in the queue. */
+    Counter peak_number_of_nodes = 0;
+
+    /** Maximum estimated number of bytes used by the search. */
+    Counter peak_number_of_bytes = 0;
+
+    /**
+     * 'true' iff the budget has been reached, whether the search has been
+     * stopped or part of its queue has been purged.
+     */
+    bool overflow = false;
+
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Output::to_json();
+        json.merge_patch({
+                {"NumberOfNodes", number_of_nodes},
+                {"PeakNumberOfNodes", peak_number_of_nodes},
+                {"PeakNumberOfBytes", peak_number_of_bytes},
+                {"Overflow", overflow},
+                });
+        return json;
+    }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Output::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of nodes: " << number_of_nodes << std::endl
+            << std::setw(width) << std::left << "Peak number of nodes: " << peak_number_of_nodes << std::endl
+            << std::setw(width) << std::left << "Peak number of bytes: " << peak_number_of_bytes << std::endl
+            << std::setw(width) << std::left << "Overflow: " << overflow << std::endl
+            ;
+    }
+};
+
+struct IterativeBeamSearchParameters: Parameters
+{
+    /** Minimum size of the queue. */
+    Counter minimum_size_of_the_queue = 1;
+
+    /** Maximum size of the queue. */
+    Counter maximum_size_of_the_queue = 100000000;
+
+    /** Growth factor of the size of the queue. */
+    double growth_factor = 2;
+
+    /**
+     * Number of candidate neighbours of each city.
+     *
+     * If positive, the children of a node only visit the candidate
+     * neighbours of its last visited city.
+     */
+    CityId number_of_candidates = -1;
+
+    /**
+     * LKH candidate file content of the cities.
+     *
+     * If non-empty, the candidate neighbours of a city are its first LKH
+     * candidates; otherwise, they are its closest cities.
+     */
+    std::string lkh_candidate_file_content;
+
+
+    virtual int format_width() const override { return 27; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Parameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Minimum size of the queue: " << minimum_size_of_the_queue << std::endl
+            << std::setw(width) << std::left << "Maximum size of the queue: " << maximum_size_of_the_queue << std::endl
+            << std::setw(width) << std::left << "Growth factor: " << growth_factor << std::endl
+            << std::setw(width) << std::left << "Number of candidates: " << number_of_candidates << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Parameters::to_json();
+        json.merge_patch({
+                {"MinimumSizeOfTheQueue", minimum_size_of_the_queue},
+                {"MaximumSizeOfTheQueue", maximum_size_of_the_queue},
+                {"GrowthFactor", growth_factor},
+                {"NumberOfCandidates", number_of_candidates},
+                });
+        return json;
+    }
+};
+
 /**
  * Tree search algorithm (dynamic programming) for the travelling thief
  * problem..
@@ -19,15 +198,43 @@ namespace travelling_thief
  * - "Exact Approaches for the Travelling Thief Problem" (Wu et al., 2017)
  *   https://doi.org/10.1007/978-3-319-68759-9_10
  */
-const Output tree_search(
+const TreeSearchOutput tree_search(
         const Instance& instance,
-        const Parameters& parameters = {});
+        const TreeSearchParameters& parameters = {});
 
 template <typename Distances>
-const Output tree_search(
+const TreeSearchOutput tree_search(
         const Distances& distances,
         const Instance& instance,
-        const Parameters& parameters = {});
+        const TreeSearchParameters& parameters = {});
+
+/**
+ * Iterative beam search algorithm for the travelling thief problem.
+ *
+ * It uses the same branching scheme as the tree search algorithm, but only
+ * keeps the best nodes of each level according to the guide. The width of
+ * the beam grows from a beam to the next one, so that it provides good
+ * solutions quickly with a bounded memory usage, and it stops once a beam is
+ * not truncated.
+ */
+const Output iterative_beam_search(
+        const Instance& instance,
+        const IterativeBeamSearchParameters& parameters = {});
+
+template <typename Distances>
+const Output iterative_beam_search(
+        const Distances& distances,
+        const Instance& instance,
+        const IterativeBeamSearchParameters& parameters = {});
+
+/**
+ * Get the first 'number_of_candidates' LKH candidate neighbours of each city
+ * from an LKH candidate file content.
+ */
+std::vector<std::vector<CityId>> read_lkh_candidate_neighbors(
+        const Instance& instance,
+        const std::string& lkh_candidate_file_content,
+        CityId number_of_candidates);
 
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
@@ -39,17 +246,20 @@ class BranchingScheme
 
 public:
 
+    /** Type of the words of the visited cities bitset. */
+    using Word = uint64_t;
+
+    /**
+     * Structure for a node.
+     *
+     * Nodes are allocated from a memory pool. The bitset of the visited
+     * cities is stored right after the node, in the same block.
+     */
     struct Node
     {
         /** Id of the node. */
         treesearchsolver::NodeId node_id = -1;
 
-        /** Parent of the node. */
-        std::shared_ptr<Node> parent = nullptr;
-
-        /** Visited cities. */
-        std::vector<bool> visited_cities;
-
         /** Last visited city. */
         CityId last_visited_city_id = -1;
 
@@ -80,15 +290,6 @@ public:
         /** Current weight. */
         Weight weight = 0;
 
-        /** Minimum remaining distance. */
-        Distance minimum_remaining_distance = 0;
-
-        /** Remaining profit. */
-        Profit remaining_profit = 0;
-
-        /** Remaining weight. */
-        Weight remaining_weight = 0;
-
         /** Objective value. */
         Profit objective = -std::numeric_limits<Profit>::infinity();
 
@@ -98,72 +299,238 @@ public:
         /** Guide value. */
         double guide = -std::numeric_limits<Profit>::infinity();
 
-        /** City of the next child. */
-        CityId next_child_city_id = 0;
+        /**
+         * 'true' iff the children of the node only visit the candidate
+         * neighbours of its last visited city.
+         */
+        bool restricted = false;
+
+        /**
+         * 'true' iff the fields used to bound the children of the node have
+         * been computed.
+         *
+         * They are computed when the first child is generated and shared by
+         * all the children.
+         */
+        bool children_bound_computed = false;
+
+        /**
+         * Position of the city of the next child among the neighbours of the
+         * node, that is, the candidate neighbours of its last visited city if
+         * 'restricted' is 'true' and all the cities otherwise.
+         */
+        CityId next_child_pos = 0;
 
         /** State of the city of the next child. */
         CityStateId next_child_city_state_id = 0;
+
+        /**
+         * Weight of a minimum spanning tree of the cities not visited by the
+         * node and of city 0.
+         */
+        Distance minimum_spanning_tree_weight = 0;
+
+        /**
+         * Multiplier of the capacity constraint in the Lagrangian relaxation
+         * of the knapsack over the items of the cities not visited by the
+         * node, that is, the efficiency of the break item of its fractional
+         * knapsack.
+         */
+        double knapsack_multiplier = 0;
+
+        /**
+         * Sum of the positive reduced profits 'profit - knapsack_multiplier *
+         * weight' of the items of the cities not visited by the node.
+         */
+        Profit knapsack_reduced_profit = 0;
+
+        /** Zobrist hash of the visited cities bitset. */
+        Word visited_cities_hash = 0;
+
+        /** Get the visited cities bitset. */
+        inline Word* visited_cities() { return reinterpret_cast<Word*>(this + 1); }
+
+        /** Get the visited cities bitset. */
+        inline const Word* visited_cities() const { return reinterpret_cast<const Word*>(this + 1); }
+
+        /** Check if a city has been visited. */
+        inline bool visited(CityId city_id) const
+        {
+            return (visited_cities()[city_id / 64] >> (city_id % 64)) & 1;
+        }
+
+        /** Mark a city as visited. */
+        inline void visit(CityId city_id)
+        {
+            visited_cities()[city_id / 64] |= ((Word)1 << (city_id % 64));
+        }
+    };
+
+    /**
+     * Structure storing the last visited city of a node and the id of its
+     * parent.
+     *
+     * They are kept for all the nodes created so that the path of a node can
+     * be retrieved without keeping its ancestors alive.
+     */
+    struct PathElement
+    {
+        /** Id of the parent node. */
+        treesearchsolver::NodeId parent_node_id;
+
+        /** Last visited city. */
+        int32_t city_id;
+
+        /** State of the last visited city. */
+        int32_t city_state_id;
+
+        /** 'true' iff the node has been dominated by a node created later. */
+        std::atomic<bool> dominated;
+    };
+
+    struct Parameters
+    {
+        /**
+         * Number of threads.
+         *
+         * If greater than 1, the branching scheme can be used by several
+         * threads at the same time, as long as a node is only expanded by
+         * one thread at a time.
+         */
+        Counter number_of_threads = 1;
+
+        /**
+         * Number of candidate neighbours of each city.
+         *
+         * If positive, the children of a node only visit the candidate
+         * neighbours of its last visited city, unless they have all been
+         * visited already. The child generation is then not complete.
+         */
+        CityId number_of_candidates = -1;
+
+        /**
+         * Candidate neighbours of each city, for example the candidate set of
+         * LKH.
+         *
+         * If empty and 'number_of_candidates' is positive, the
+         * 'number_of_candidates' closest cities are used.
+         */
+        std::vector<std::vector<CityId>> candidates;
     };
 
     BranchingScheme(
             const Instance& instance,
             const Distances& distances,
-            const std::vector<std::vector<travellingthiefsolver::packing_while_travelling::CityState>>& city_states):
+            const travellingthiefsolver::packing_while_travelling::CityStateTable& city_states,
+            const Parameters& parameters):
         instance_(instance),
         distances_(distances),
         city_states_(city_states),
-        closest_city_distances_(instance_.number_of_cities(), std::numeric_limits<Distance>::max())
+        number_of_words_((instance_.number_of_cities() + 63) / 64),
+        node_size_(sizeof(Node) + number_of_words_ * sizeof(Word)),
+        node_pool_(new travellingthiefsolver::packing_while_travelling::MemoryPool(
+                    1 << 20,
+                    parameters.number_of_threads > 1)),
+        path_element_chunks_(new std::atomic<PathElement*>[path_element_maximum_number_of_chunks_]),
+        visited_city_keys_(instance_.number_of_cities()),
+        last_visited_city_keys_(instance_.number_of_cities()),
+        number_of_dominance_shards_((parameters.number_of_threads > 1)? 16 * parameters.number_of_threads: 1),
+        dominance_shards_(new DominanceShard[number_of_dominance_shards_])
     {
+        for (treesearchsolver::NodeId chunk_id = 0;
+                chunk_id < path_element_maximum_number_of_chunks_;
+                ++chunk_id) {
+            path_element_chunks_[chunk_id].store(nullptr);
+        }
+
+        // Draw the Zobrist keys. The seed is fixed so that the search is
+        // deterministic.
+        std::mt19937_64 generator(0);
         for (CityId city_id = 0;
                 city_id < instance_.number_of_cities();
                 ++city_id) {
-            Profit profit = city_states_[city_id].back().total_profit;
-            Weight weight = city_states_[city_id].back().total_weight;
-            double eff = profit / weight;
-            if (best_efficiency_ < eff)
-                best_efficiency_ = eff;
-        }
-
-        for (CityId city_id_1 = 0;
-                city_id_1 < instance_.number_of_cities();
-                ++city_id_1) {
-            for (CityId city_id_2 = city_id_1 + 1;
-                    city_id_2 < instance_.number_of_cities();
-                    ++city_id_2) {
-                Distance d = distances_.distance(city_id_1, city_id_2);
-                if (closest_city_distances_[city_id_1] > d)
-                    closest_city_distances_[city_id_1] = d;
-                if (closest_city_distances_[city_id_2] > d)
-                    closest_city_distances_[city_id_2] = d;
+            visited_city_keys_[city_id] = generator();
+            last_visited_city_keys_[city_id] = generator();
+        }
+
+        // Sort the items by non-increasing efficiency for the fractional
+        // knapsack bound.
+        sorted_item_ids_.reserve(instance_.number_of_items());
+        for (ItemId item_id = 0;
+                item_id < instance_.number_of_items();
+                ++item_id) {
+            sorted_item_ids_.push_back(item_id);
+        }
+        std::sort(
+                sorted_item_ids_.begin(),
+                sorted_item_ids_.end(),
+                [this](ItemId item_id_1, ItemId item_id_2)
+                {
+                    const Item& item_1 = instance_.item(item_id_1);
+                    const Item& item_2 = instance_.item(item_id_2);
+                    // p1 / w1 > p2 / w2
+                    return item_1.profit * item_2.weight
+                        > item_2.profit * item_1.weight;
+                });
+
+        // Compute the candidate neighbours.
+        if (!parameters.candidates.empty()) {
+            for (CityId city_id = 0;
+                    city_id < instance_.number_of_cities();
+                    ++city_id) {
+                candidate_city_ids_.insert(
+                        candidate_city_ids_.end(),
+                        parameters.candidates[city_id].begin(),
+                        parameters.candidates[city_id].end());
+                candidate_offsets_.push_back(candidate_city_ids_.size());
             }
+        } else if (parameters.number_of_candidates > 0) {
+            CityId number_of_candidates = (std::min)(
+                    parameters.number_of_candidates,
+                    instance_.number_of_cities() - 1);
+            std::vector<std::pair<Distance, CityId>> neighbors;
+            for (CityId city_id = 0;
+                    city_id < instance_.number_of_cities();
+                    ++city_id) {
+                neighbors.clear();
+                for (CityId city_id_2 = 0;
+                        city_id_2 < instance_.number_of_cities();
+                        ++city_id_2) {
+                    if (city_id_2 == city_id)
+                        continue;
+                    neighbors.push_back({distances_.distance(city_id, city_id_2), city_id_2});
+                }
+                std::partial_sort(
+                        neighbors.begin(),
+                        neighbors.begin() + number_of_candidates,
+                        neighbors.end());
+                for (CityId pos = 0; pos < number_of_candidates; ++pos)
+                    candidate_city_ids_.push_back(neighbors[pos].second);
+                candidate_offsets_.push_back(candidate_city_ids_.size());
+            }
+        }
+    }
+
+    /** Destructor. */
+    ~BranchingScheme()
+    {
+        for (treesearchsolver::NodeId chunk_id = 0;
+                chunk_id < path_element_maximum_number_of_chunks_;
+                ++chunk_id) {
+            delete[] path_element_chunks_[chunk_id].load();
         }
     }
 
     inline const std::shared_ptr<Node> root() const
     {
-        auto r = std::shared_ptr<Node>(new BranchingScheme::Node());
-        r->visited_cities.resize(instance_.number_of_cities(), false);
-        r->visited_cities[0] = true;
+        auto r = create_node();
+        r->visit(0);
+        r->visited_cities_hash = visited_city_keys_[0];
         r->number_of_cities = 1;
         r->last_visited_city_id = 0;
-        r->remaining_profit = 0;
-        r->remaining_weight = 0;
-        for (CityId city_id = 0;
-                city_id < instance_.number_of_cities();
-                ++city_id) {
-            Profit profit = city_states_[city_id].back().total_profit;
-            Weight weight = city_states_[city_id].back().total_weight;
-            r->remaining_profit += profit;
-            r->remaining_weight += weight;
-        }
-        r->minimum_remaining_distance = 0;
-        for (CityId city_id = 1;
-                city_id < instance_.number_of_cities();
-                ++city_id) {
-            r->minimum_remaining_distance += closest_city_distances_[city_id];
-        }
-        r->node_id = node_id_cur_;
-        node_id_cur_++;
+        init_next_child(r);
+        r->node_id = node_id_cur_++;
+        create_path_element(r->node_id, -1, 0, -1);
         return r;
     }
 
@@ -172,45 +539,62 @@ public:
     {
         assert(!infertile(parent));
         assert(!leaf(parent));
+        PROFILING_COUNT("TtpTreeSearchChildren", 1);
         //std::cout << "parent id " << parent->node_id
-        //    << " next_child_city_id " << parent->next_child_city_id
+        //    << " next_child_pos " << parent->next_child_pos
         //    << " next_child_city_state_id " << parent->next_child_city_state_id
         //    << std::endl;
         //std::cout << parent->bound << " " << parent->objective << std::endl;
 
-        CityId city_id_next = parent->next_child_city_id;;
+        // If the parent has been dominated since its creation, none of its
+        // children needs to be generated.
+        if (path_element(parent->node_id).dominated.load(std::memory_order_relaxed)) {
+            parent->next_child_pos = number_of_neighbors(parent);
+            return nullptr;
+        }
+
+        CityId city_id_next = neighbor(parent, parent->next_child_pos);
         CityStateId city_state_id_next = parent->next_child_city_state_id;
 
-        // Update parent
+        // Update parent. The states of a city are sorted by increasing
+        // weight, so if the current one doesn't fit, the next ones don't
+        // either.
         parent->next_child_city_state_id++;
-        if (parent->next_child_city_state_id
-                == (CityStateId)city_states_[parent->next_child_city_id].size()) {
-            parent->next_child_city_id++;
+        bool fits = (parent->weight
+                + city_states_.total_weight(city_id_next, city_state_id_next)
+                <= instance_.capacity());
+        if (!fits || parent->next_child_city_state_id
+                == city_states_.number_of_states(city_id_next)) {
+            parent->next_child_pos++;
             parent->next_child_city_state_id = 0;
+            skip_visited_neighbors(parent);
         }
 
-        // Check if the next city has already been visited.
-        if (parent->visited_cities[city_id_next])
-            return nullptr;
-
         // Check capacity.
-        if (parent->weight
-                + city_states_[city_id_next][city_state_id_next].total_weight
-                > instance_.capacity())
+        if (!fits)
             return nullptr;
 
         // Compute new child.
-        auto child = std::shared_ptr<Node>(new BranchingScheme::Node());
-        child->node_id = node_id_cur_;
-        node_id_cur_++;
-        child->parent = parent;
-        child->visited_cities = parent->visited_cities;
-        child->visited_cities[city_id_next] = true;
+        auto child = create_node();
+        child->node_id = node_id_cur_++;
+        create_path_element(
+                child->node_id,
+                parent->node_id,
+                city_id_next,
+                city_state_id_next);
+        std::copy(
+                parent->visited_cities(),
+                parent->visited_cities() + number_of_words_,
+                child->visited_cities());
+        child->visit(city_id_next);
+        child->visited_cities_hash = parent->visited_cities_hash
+            ^ visited_city_keys_[city_id_next];
         child->last_visited_city_id = city_id_next;
+        init_next_child(child);
         child->last_visited_city_state_id = city_state_id_next;
         child->number_of_cities = parent->number_of_cities + 1;
         child->number_of_items = parent->number_of_items
-            + city_states_[city_id_next][city_state_id_next].item_ids.size();
+            + city_states_.number_of_items(city_id_next, city_state_id_next);
         Distance d = distances_.distance(
                 parent->last_visited_city_id,
                 city_id_next);
@@ -222,15 +606,9 @@ public:
                 parent->weight);
         child->time = parent->time + t;
         child->profit = parent->profit
-            + city_states_[city_id_next][city_state_id_next].total_profit;
+            + city_states_.total_profit(city_id_next, city_state_id_next);
         child->weight = parent->weight
-            + city_states_[city_id_next][city_state_id_next].total_weight;
-        child->minimum_remaining_distance = parent->minimum_remaining_distance
-            - closest_city_distances_[city_id_next];
-        child->remaining_profit = parent->remaining_profit
-            - city_states_[city_id_next].back().total_profit;
-        child->remaining_weight = parent->remaining_weight
-            - city_states_[city_id_next].back().total_weight;
+            + city_states_.total_weight(city_id_next, city_state_id_next);
         Time d_end = distances_.distance(
                 city_id_next,
                 0);
@@ -243,14 +621,40 @@ public:
         child->time_full = child->time + t_end;
         child->objective = child->profit
             - instance_.renting_ratio() * child->time_full;
-        Weight remaining_capacity = instance_.capacity() - child->weight;
-        Profit profit_bound = child->profit + std::min(
-                child->remaining_profit,
-                best_efficiency_ * remaining_capacity);
+
+        // Compute the bound from the fields shared by the children of the
+        // parent.
+        // The remaining path of the child goes from its last visited city to
+        // city 0 through the other cities not visited by the parent. It spans
+        // the cities not visited by the parent and city 0, so its length is
+        // at least the weight of their minimum spanning tree. Since the
+        // weight never decreases, the speed on the remaining path is at most
+        // the speed at the current weight.
+        // The profit which can still be collected is bounded by the
+        // Lagrangian relaxation of the knapsack over the items of the cities
+        // not visited by the child, with the multiplier of the parent.
+        if (!parent->children_bound_computed)
+            compute_children_bound(parent);
+        double multiplier = parent->knapsack_multiplier;
+        Profit reduced_profit = parent->knapsack_reduced_profit;
+        for (ItemId item_id: instance_.city(city_id_next).item_ids) {
+            const Item& item = instance_.item(item_id);
+            if (item.profit > multiplier * item.weight)
+                reduced_profit -= item.profit - multiplier * item.weight;
+        }
+        Profit profit_bound = child->profit
+            + multiplier * (instance_.capacity() - child->weight)
+            + (std::max)(0.0, reduced_profit);
         double speed = instance_.speed(child->weight);
         child->bound = profit_bound - instance_.renting_ratio()
-            * (child->time_full + (double)child->minimum_remaining_distance / speed);
+            * (child->time + (double)parent->minimum_spanning_tree_weight / speed);
         child->guide = -child->bound;
+
+        // Check dominance.
+        if (child->number_of_cities != instance_.number_of_cities()
+                && !add_to_dominance_store(child))
+            return nullptr;
+
         //std::cout << "child id " << child->node_id << std::endl;
         return child;
     }
@@ -259,9 +663,18 @@ public:
             const std::shared_ptr<Node>& node) const
     {
         assert(node != nullptr);
-        return (node->next_child_city_id == instance_.number_of_cities());
+        return (node->next_child_pos == number_of_neighbors(node));
     }
 
+    /**
+     * Return 'true' iff all the children of the nodes are generated, that is,
+     * iff the child generation is not restricted to candidate neighbours.
+     *
+     * If 'false', a search completed with this branching scheme doesn't prove
+     * the optimality of its best solution.
+     */
+    inline bool complete() const { return candidate_offsets_.size() == 1; }
+
     inline bool operator()(
             const std::shared_ptr<Node>& node_1,
             const std::shared_ptr<Node>& node_2) const
@@ -314,19 +727,26 @@ public:
 
     /*
      * Dominances.
+     *
+     * Dominances are handled by the branching scheme itself, in
+     * 'add_to_dominance_store', when the children are created. Therefore,
+     * nodes are not comparable for the tree search algorithm.
      */
 
     inline bool comparable(
             const std::shared_ptr<Node>&) const
     {
-        return true;
+        return false;
     }
 
     const Instance& instance() const { return instance_; }
 
     struct NodeHasher
     {
-        std::hash<std::vector<bool>> hasher_cities;
+        /** Number of words of the visited cities bitsets. */
+        CityId number_of_words;
+
+        std::hash<Word> hasher_word;
         std::hash<CityId> hasher_city;
 
         inline bool operator()(
@@ -335,7 +755,10 @@ public:
         {
             if (node_1->last_visited_city_id != node_2->last_visited_city_id)
                 return false;
-            if (node_1->visited_cities != node_2->visited_cities)
+            if (!std::equal(
+                        node_1->visited_cities(),
+                        node_1->visited_cities() + number_of_words,
+                        node_2->visited_cities()))
                 return false;
             return true;
         }
@@ -343,13 +766,13 @@ public:
         inline std::size_t operator()(
                 const std::shared_ptr<Node>& node) const
         {
-            size_t hash = hasher_city(node->last_visited_city_id);
-            optimizationtools::hash_combine(hash, hasher_cities(node->visited_cities));
+            size_t hash = hasher_word(node->visited_cities_hash);
+            optimizationtools::hash_combine(hash, hasher_city(node->last_visited_city_id));
             return hash;
         }
     };
 
-    inline NodeHasher node_hasher() const { return NodeHasher(); }
+    inline NodeHasher node_hasher() const { return NodeHasher{number_of_words_}; }
 
     inline bool dominates(
             const std::shared_ptr<Node>& node_1,
@@ -382,38 +805,558 @@ public:
             std::ostream& os,
             const std::shared_ptr<Node>& node) const
     {
-        os << "node_id " << node->node_id << std::endl;
-        for (auto node_tmp = node;
-                node_tmp->parent != nullptr;
-                node_tmp = node_tmp->parent) {
-            os << "node_tmp"
-                << " n " << node_tmp->number_of_cities
-                << " m " << node_tmp->number_of_items
-                << " d " << node_tmp->distance
-                << " d_full " << node_tmp->distance_full
-                << " t " << node_tmp->time
-                << " t_full " << node_tmp->time_full
-                << " w " << node_tmp->weight
-                << " p " << node_tmp->profit
-                << " obj " << node_tmp->objective
-                << " guide " << node_tmp->guide
-                << " j " << node_tmp->last_visited_city_id
-                << " p1 " << node_tmp->next_child_city_id
-                << " p2 " << node_tmp->next_child_city_state_id
+        os << "node_id " << node->node_id
+            << " n " << node->number_of_cities
+            << " m " << node->number_of_items
+            << " d " << node->distance
+            << " d_full " << node->distance_full
+            << " t " << node->time
+            << " t_full " << node->time_full
+            << " w " << node->weight
+            << " p " << node->profit
+            << " obj " << node->objective
+            << " guide " << node->guide
+            << std::endl;
+        for (auto city: path(node)) {
+            os << "j " << city.first
+                << " s " << city.second
                 << std::endl;
         }
         return os;
     }
 
+    /**
+     * Get the cities visited by a node, except the first one, with their
+     * states.
+     */
+    std::vector<std::pair<CityId, CityStateId>> path(
+            const std::shared_ptr<Node>& node) const
+    {
+        std::vector<std::pair<CityId, CityStateId>> cities;
+        for (treesearchsolver::NodeId node_id = node->node_id;
+                path_element(node_id).parent_node_id != -1;
+                node_id = path_element(node_id).parent_node_id) {
+            const PathElement& path_element = this->path_element(node_id);
+            cities.push_back({
+                    path_element.city_id,
+                    path_element.city_state_id});
+        }
+        std::reverse(cities.begin(), cities.end());
+        return cities;
+    }
+
     inline void write(
             const std::shared_ptr<Node>&,
             std::string) const
     {
     }
 
+    /**
+     * Drop the path elements and the dominance store of the nodes created so
+     * far, except for the given nodes.
+     *
+     * The given nodes are renumbered and their paths are cut: 'path' only
+     * returns the cities visited after the reset. This is used by the
+     * iterative beam search at each level. Since nodes from different levels
+     * have different numbers of visited cities, they never dominate each
+     * other and clearing the dominance store loses no dominance.
+     *
+     * The branching scheme must not be used by other threads meanwhile.
+     */
+    void reset(const std::vector<std::shared_ptr<Node>>& nodes) const
+    {
+        std::vector<bool> dominated(nodes.size());
+        for (treesearchsolver::NodeId node_id = 0;
+                node_id < (treesearchsolver::NodeId)nodes.size();
+                ++node_id) {
+            dominated[node_id] = path_element(nodes[node_id]->node_id).dominated.load();
+        }
+        for (treesearchsolver::NodeId node_id = 0;
+                node_id < (treesearchsolver::NodeId)nodes.size();
+                ++node_id) {
+            const std::shared_ptr<Node>& node = nodes[node_id];
+            node->node_id = node_id;
+            create_path_element(
+                    node_id,
+                    -1,
+                    node->last_visited_city_id,
+                    node->last_visited_city_state_id);
+            path_element(node_id).dominated.store(dominated[node_id]);
+        }
+        node_id_cur_ = nodes.size();
+
+        for (Counter shard_id = 0;
+                shard_id < number_of_dominance_shards_;
+                ++shard_id) {
+            DominanceShard& shard = dominance_shards_[shard_id];
+            shard.bucket_ids.clear();
+            shard.buckets.clear();
+            shard.words.clear();
+        }
+        dominance_store_number_of_bytes_ = 0;
+    }
+
+    /**
+     * Get an estimation of the number of bytes used by the search when
+     * 'number_of_nodes' nodes are alive.
+     *
+     * It includes the alive nodes, and the path elements and the dominance
+     * store which grow with the number of nodes created.
+     */
+    inline std::size_t number_of_bytes(Counter number_of_nodes) const
+    {
+        return number_of_nodes * node_number_of_bytes()
+            + number_of_path_element_chunks_.load()
+            * (sizeof(PathElement) << path_element_chunk_size_log2_)
+            + dominance_store_number_of_bytes_.load();
+    }
+
+    /**
+     * Get an estimation of the number of bytes of an alive node, including
+     * its control block and a pointer to it.
+     */
+    inline std::size_t node_number_of_bytes() const
+    {
+        return node_size_ + 2 * sizeof(std::shared_ptr<Node>);
+    }
+
+    /**
+     * Get an estimation of the number of bytes kept for each node created,
+     * that is, its path element and its entry in the dominance store.
+     */
+    inline std::size_t created_node_number_of_bytes() const
+    {
+        return sizeof(PathElement) + sizeof(DominanceEntry);
+    }
+
 
 private:
 
+    /**
+     * Deleter of the nodes, returning their block to the memory pool.
+     */
+    struct NodeDeleter
+    {
+        /** Memory pool. */
+        std::shared_ptr<travellingthiefsolver::packing_while_travelling::MemoryPool> pool;
+
+        /** Size of the block of a node. */
+        std::size_t node_size;
+
+        inline void operator()(Node* node) const
+        {
+            node->~Node();
+            pool->deallocate(node, node_size);
+        }
+    };
+
+    /**
+     * Structure for an entry of the dominance store.
+     */
+    struct DominanceEntry
+    {
+        /** Id of the node. */
+        treesearchsolver::NodeId node_id;
+
+        /** Travel time of the node. */
+        Time time;
+
+        /** Profit of the node. */
+        Profit profit;
+
+        /** Weight of the node. */
+        Weight weight;
+
+        /** Maximum profit of the entries of the bucket up to this one. */
+        Profit prefix_maximum_profit;
+
+        /** Minimum weight of the entries of the bucket up to this one. */
+        Weight prefix_minimum_weight;
+    };
+
+    /**
+     * Structure for a bucket of the dominance store.
+     *
+     * A bucket contains the Pareto frontier, in terms of time, profit and
+     * weight, of the nodes sharing the same visited cities and the same last
+     * visited city. The entries are sorted by increasing time, and each entry
+     * stores the maximum profit and the minimum weight of the entries up to
+     * it, so that a dominance check stops as soon as the earlier entries
+     * can't dominate the node.
+     */
+    struct DominanceBucket
+    {
+        /** Last visited city. */
+        CityId last_visited_city_id;
+
+        /** Position of the visited cities bitset in the words of its shard. */
+        std::size_t words_pos;
+
+        /** Next bucket with the same key; -1 if none. */
+        int64_t next_bucket_id;
+
+        /** Pareto frontier. */
+        std::vector<DominanceEntry> entries;
+    };
+
+    /**
+     * Structure for a shard of the dominance store.
+     *
+     * The dominance store is partitioned by the key of the buckets, each
+     * shard being protected by its own mutex.
+     */
+    struct DominanceShard
+    {
+        /**
+         * Map from the key of a bucket (Zobrist hash of the visited cities
+         * and of the last visited city) to the id of the first bucket with
+         * this key.
+         */
+        std::unordered_map<Word, int64_t> bucket_ids;
+
+        /** Buckets. */
+        std::vector<DominanceBucket> buckets;
+
+        /** Visited cities bitsets of the buckets. */
+        std::vector<Word> words;
+
+        /** Mutex. */
+        std::mutex mutex;
+    };
+
+    /**
+     * Add a node to the dominance store.
+     *
+     * Return 'false' if the node is dominated by a node of the store.
+     * Otherwise, the nodes of the store dominated by the new node are removed
+     * from it and marked as dominated, and 'true' is returned.
+     */
+    inline bool add_to_dominance_store(
+            const std::shared_ptr<Node>& node) const
+    {
+        Word key = node->visited_cities_hash
+            ^ last_visited_city_keys_[node->last_visited_city_id];
+        DominanceShard& shard = dominance_shards_[key % number_of_dominance_shards_];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        // Find the bucket of the node.
+        auto it = shard.bucket_ids.find(key);
+        int64_t bucket_id = (it == shard.bucket_ids.end())? -1: it->second;
+        while (bucket_id != -1) {
+            const DominanceBucket& bucket = shard.buckets[bucket_id];
+            if (bucket.last_visited_city_id == node->last_visited_city_id
+                    && std::equal(
+                        node->visited_cities(),
+                        node->visited_cities() + number_of_words_,
+                        shard.words.begin() + bucket.words_pos)) {
+                break;
+            }
+            bucket_id = bucket.next_bucket_id;
+        }
+
+        // Create a new bucket if needed.
+        if (bucket_id == -1) {
+            DominanceBucket bucket;
+            bucket.last_visited_city_id = node->last_visited_city_id;
+            bucket.words_pos = shard.words.size();
+            bucket.next_bucket_id = (it == shard.bucket_ids.end())? -1: it->second;
+            shard.words.insert(
+                    shard.words.end(),
+                    node->visited_cities(),
+                    node->visited_cities() + number_of_words_);
+            bucket_id = shard.buckets.size();
+            shard.buckets.push_back(bucket);
+            shard.bucket_ids[key] = bucket_id;
+            dominance_store_number_of_bytes_ += sizeof(DominanceBucket)
+                + number_of_words_ * sizeof(Word)
+                + sizeof(std::pair<const Word, int64_t>) + 2 * sizeof(void*);
+        }
+        std::vector<DominanceEntry>& entries = shard.buckets[bucket_id].entries;
+
+        // Only the entries with a smaller or equal time may dominate the
+        // node. They are scanned from the latest one.
+        auto pos = std::upper_bound(
+                entries.begin(),
+                entries.end(),
+                node->time,
+                [](Time time, const DominanceEntry& entry) { return time < entry.time; });
+        for (auto it_entry = pos; it_entry != entries.begin();) {
+            --it_entry;
+            if (it_entry->prefix_maximum_profit < node->profit
+                    || it_entry->prefix_minimum_weight > node->weight) {
+                break;
+            }
+            if (it_entry->profit >= node->profit
+                    && it_entry->weight <= node->weight) {
+                return false;
+            }
+        }
+
+        // Remove the entries dominated by the node. Only the entries with a
+        // greater or equal time may be dominated.
+        auto first = std::lower_bound(
+                entries.begin(),
+                pos,
+                node->time,
+                [](const DominanceEntry& entry, Time time) { return entry.time < time; });
+        auto it_out = first;
+        for (auto it_entry = first; it_entry != entries.end(); ++it_entry) {
+            if (it_entry->profit <= node->profit
+                    && it_entry->weight >= node->weight) {
+                path_element(it_entry->node_id).dominated.store(
+                        true,
+                        std::memory_order_relaxed);
+            } else {
+                *it_out = *it_entry;
+                ++it_out;
+            }
+        }
+        dominance_store_number_of_bytes_ -= (entries.end() - it_out) * sizeof(DominanceEntry);
+        entries.erase(it_out, entries.end());
+
+        // Insert the node and update the prefix bounds of the entries after
+        // it.
+        std::size_t node_pos = first - entries.begin();
+        entries.insert(
+                entries.begin() + node_pos,
+                {node->node_id, node->time, node->profit, node->weight, node->profit, node->weight});
+        dominance_store_number_of_bytes_ += sizeof(DominanceEntry);
+        for (std::size_t entry_pos = node_pos;
+                entry_pos < entries.size();
+                ++entry_pos) {
+            DominanceEntry& entry = entries[entry_pos];
+            entry.prefix_maximum_profit = entry.profit;
+            entry.prefix_minimum_weight = entry.weight;
+            if (entry_pos > 0) {
+                const DominanceEntry& previous_entry = entries[entry_pos - 1];
+                entry.prefix_maximum_profit = (std::max)(
+                        entry.prefix_maximum_profit,
+                        previous_entry.prefix_maximum_profit);
+                entry.prefix_minimum_weight = (std::min)(
+                        entry.prefix_minimum_weight,
+                        previous_entry.prefix_minimum_weight);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Compute the fields of a node used to bound its children.
+     *
+     * They only depend on the node, so that the cost of the bounds is
+     * quadratic in the number of cities per expanded node, and constant per
+     * child apart from the items of its last visited city.
+     */
+    inline void compute_children_bound(
+            const std::shared_ptr<Node>& node) const
+    {
+        PROFILING_SCOPE("TtpTreeSearchBound");
+        node->children_bound_computed = true;
+
+        // Minimum spanning tree of the unvisited cities and of city 0, with
+        // Prim's algorithm. City 0 is the root of the tree.
+        std::vector<CityId> mst_city_ids(instance_.number_of_cities());
+        std::vector<Distance> mst_distances(instance_.number_of_cities());
+        CityId number_of_remaining_cities = 0;
+        for (CityId city_id = 1;
+                city_id < instance_.number_of_cities();
+                ++city_id) {
+            if (node->visited(city_id))
+                continue;
+            mst_city_ids[number_of_remaining_cities] = city_id;
+            mst_distances[number_of_remaining_cities] = distances_.distance(0, city_id);
+            number_of_remaining_cities++;
+        }
+        Distance mst_weight = 0;
+        while (number_of_remaining_cities > 0) {
+            CityId pos_best = 0;
+            for (CityId pos = 1; pos < number_of_remaining_cities; ++pos)
+                if (mst_distances[pos_best] > mst_distances[pos])
+                    pos_best = pos;
+            CityId city_id_best = mst_city_ids[pos_best];
+            mst_weight += mst_distances[pos_best];
+            number_of_remaining_cities--;
+            mst_city_ids[pos_best] = mst_city_ids[number_of_remaining_cities];
+            mst_distances[pos_best] = mst_distances[number_of_remaining_cities];
+            for (CityId pos = 0; pos < number_of_remaining_cities; ++pos) {
+                Distance d = distances_.distance(city_id_best, mst_city_ids[pos]);
+                if (mst_distances[pos] > d)
+                    mst_distances[pos] = d;
+            }
+        }
+        node->minimum_spanning_tree_weight = mst_weight;
+
+        // Fractional knapsack over the items of the unvisited cities. Its
+        // break item gives the optimal multiplier of the Lagrangian
+        // relaxation; if all the items fit, the multiplier is 0. Only the
+        // items packed before the break item have a positive reduced profit.
+        Weight remaining_capacity = instance_.capacity() - node->weight;
+        Weight packed_weight = 0;
+        Profit packed_profit = 0;
+        double multiplier = 0;
+        for (ItemId item_id: sorted_item_ids_) {
+            const Item& item = instance_.item(item_id);
+            if (node->visited(item.city_id))
+                continue;
+            if (item.weight <= remaining_capacity) {
+                remaining_capacity -= item.weight;
+                packed_weight += item.weight;
+                packed_profit += item.profit;
+            } else {
+                multiplier = item.profit / item.weight;
+                break;
+            }
+        }
+        node->knapsack_multiplier = multiplier;
+        node->knapsack_reduced_profit = packed_profit - multiplier * packed_weight;
+    }
+
+    /** Get the number of neighbours of a node. */
+    inline CityId number_of_neighbors(
+            const std::shared_ptr<Node>& node) const
+    {
+        if (!node->restricted)
+            return instance_.number_of_cities();
+        return candidate_offsets_[node->last_visited_city_id + 1]
+            - candidate_offsets_[node->last_visited_city_id];
+    }
+
+    /** Get a neighbour of a node. */
+    inline CityId neighbor(
+            const std::shared_ptr<Node>& node,
+            CityId pos) const
+    {
+        if (!node->restricted)
+            return pos;
+        return candidate_city_ids_[candidate_offsets_[node->last_visited_city_id] + pos];
+    }
+
+    /** Get the position of the lowest set bit of a non-zero word. */
+    static inline CityId lowest_set_bit(Word word)
+    {
+        static const CityId table[64] = {
+            0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4,
+            62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+            63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+            46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6};
+        return table[((word & (~word + 1)) * (Word)0x03f79d71b4cb0a89) >> 58];
+    }
+
+    /**
+     * Move the position of the next child of a node to its next unvisited
+     * neighbour.
+     *
+     * When the neighbours are all the cities, the unvisited ones are found
+     * directly from the words of the visited cities bitset.
+     */
+    inline void skip_visited_neighbors(
+            const std::shared_ptr<Node>& node) const
+    {
+        if (node->restricted) {
+            CityId number_of_neighbors = this->number_of_neighbors(node);
+            while (node->next_child_pos < number_of_neighbors
+                    && node->visited(neighbor(node, node->next_child_pos))) {
+                node->next_child_pos++;
+            }
+            return;
+        }
+
+        CityId word_pos = node->next_child_pos / 64;
+        if (word_pos >= number_of_words_) {
+            node->next_child_pos = instance_.number_of_cities();
+            return;
+        }
+        Word word = ~node->visited_cities()[word_pos]
+            & (~(Word)0 << (node->next_child_pos % 64));
+        while (word == 0 && ++word_pos < number_of_words_)
+            word = ~node->visited_cities()[word_pos];
+        node->next_child_pos = (word == 0)?
+            instance_.number_of_cities():
+            (std::min)(
+                    instance_.number_of_cities(),
+                    word_pos * 64 + lowest_set_bit(word));
+    }
+
+    /**
+     * Initialize the position of the next child of a node whose visited
+     * cities and last visited city have been set.
+     */
+    inline void init_next_child(
+            const std::shared_ptr<Node>& node) const
+    {
+        node->restricted = false;
+        if (!complete()) {
+            // Only use the candidate neighbours if one of them has not been
+            // visited yet.
+            node->restricted = true;
+            node->next_child_pos = 0;
+            skip_visited_neighbors(node);
+            if (node->next_child_pos < number_of_neighbors(node))
+                return;
+            node->restricted = false;
+        }
+        node->next_child_pos = 0;
+        skip_visited_neighbors(node);
+    }
+
+    /** Get the path element of a node. */
+    inline PathElement& path_element(treesearchsolver::NodeId node_id) const
+    {
+        PathElement* path_elements = path_element_chunks_[node_id >> path_element_chunk_size_log2_].load(
+                std::memory_order_acquire);
+        return path_elements[node_id & (((treesearchsolver::NodeId)1 << path_element_chunk_size_log2_) - 1)];
+    }
+
+    /**
+     * Create the path element of a node.
+     *
+     * The path elements are stored in chunks which are never moved, so that
+     * a thread can create a path element while another thread reads another
+     * one.
+     */
+    inline void create_path_element(
+            treesearchsolver::NodeId node_id,
+            treesearchsolver::NodeId parent_node_id,
+            CityId city_id,
+            CityStateId city_state_id) const
+    {
+        treesearchsolver::NodeId chunk_id = node_id >> path_element_chunk_size_log2_;
+        if (chunk_id >= path_element_maximum_number_of_chunks_) {
+            throw std::runtime_error(
+                    "travellingthiefsolver::travelling_thief::BranchingScheme::create_path_element; "
+                    "too many nodes.");
+        }
+        std::atomic<PathElement*>& chunk = path_element_chunks_[chunk_id];
+        if (chunk.load(std::memory_order_acquire) == nullptr) {
+            std::lock_guard<std::mutex> lock(path_element_chunks_mutex_);
+            if (chunk.load(std::memory_order_relaxed) == nullptr) {
+                chunk.store(
+                        new PathElement[(treesearchsolver::NodeId)1 << path_element_chunk_size_log2_],
+                        std::memory_order_release);
+                number_of_path_element_chunks_++;
+            }
+        }
+        PathElement& path_element = this->path_element(node_id);
+        path_element.parent_node_id = parent_node_id;
+        path_element.city_id = city_id;
+        path_element.city_state_id = city_state_id;
+        path_element.dominated.store(false, std::memory_order_relaxed);
+    }
+
+    /** Create a node with no visited city. */
+    inline std::shared_ptr<Node> create_node() const
+    {
+        Node* node = new (node_pool_->allocate(node_size_)) Node();
+        std::fill(
+                node->visited_cities(),
+                node->visited_cities() + number_of_words_,
+                0);
+        return std::shared_ptr<Node>(
+                node,
+                NodeDeleter{node_pool_, node_size_},
+                travellingthiefsolver::packing_while_travelling::PoolAllocator<Node>(node_pool_));
+    }
+
     /** Instance. */
     const Instance& instance_;
 
@@ -421,62 +1364,476 @@ private:
     const Distances& distances_;
 
     /** City states. */
-    const std::vector<std::vector<travellingthiefsolver::packing_while_travelling::CityState>>& city_states_;
+    const travellingthiefsolver::packing_while_travelling::CityStateTable& city_states_;
+
+    /** Items sorted by non-increasing efficiency. */
+    std::vector<ItemId> sorted_item_ids_;
+
+    /** Candidate neighbours of the cities. */
+    std::vector<CityId> candidate_city_ids_;
+
+    /**
+     * For each city, position of its first candidate neighbour in
+     * 'candidate_city_ids_'.
+     */
+    std::vector<CityId> candidate_offsets_ = {0};
+
+    /** Number of words of the visited cities bitsets. */
+    CityId number_of_words_;
 
-    double best_efficiency_ = 0;
+    /** Size of the block of a node, including its visited cities bitset. */
+    std::size_t node_size_;
 
-    std::vector<Distance> closest_city_distances_;
+    /** Memory pool of the nodes. */
+    std::shared_ptr<travellingthiefsolver::packing_while_travelling::MemoryPool> node_pool_;
+
+    /** Logarithm of the number of path elements per chunk. */
+    static constexpr int path_element_chunk_size_log2_ = 16;
+
+    /** Maximum number of chunks of path elements. */
+    static constexpr treesearchsolver::NodeId path_element_maximum_number_of_chunks_ = (1 << 16);
+
+    /** Chunks of path elements, indexed by node id. */
+    std::unique_ptr<std::atomic<PathElement*>[]> path_element_chunks_;
+
+    /** Mutex protecting the allocation of the chunks of path elements. */
+    mutable std::mutex path_element_chunks_mutex_;
+
+    /** Number of chunks of path elements allocated. */
+    mutable std::atomic<Counter> number_of_path_element_chunks_ {0};
 
     /** Current node id. */
-    mutable treesearchsolver::NodeId node_id_cur_ = 0;
+    mutable std::atomic<treesearchsolver::NodeId> node_id_cur_ {0};
+
+    /** Zobrist keys of the visited cities. */
+    std::vector<Word> visited_city_keys_;
+
+    /** Zobrist keys of the last visited city. */
+    std::vector<Word> last_visited_city_keys_;
+
+    /** Number of shards of the dominance store. */
+    Counter number_of_dominance_shards_;
+
+    /** Shards of the dominance store. */
+    std::unique_ptr<DominanceShard[]> dominance_shards_;
+
+    /** Estimated number of bytes of the dominance store. */
+    mutable std::atomic<std::size_t> dominance_store_number_of_bytes_ {0};
 
 };
 
+/**
+ * Parallel best-first search.
+ *
+ * The open nodes are stored in a relaxed concurrent priority queue: a set of
+ * binary heaps, each protected by its own mutex. A thread pushes the children
+ * it generates into a random heap and pops the best of the tops of two random
+ * heaps. Therefore, the nodes are not expanded exactly in the order of the
+ * guide, but the contention stays low.
+ *
+ * The dominance checks are performed by the branching scheme in a store
+ * partitioned by node hash. The incumbent is shared between the threads.
+ *
+ * The size of the queue and the estimated memory used are checked before
+ * each expansion against the budget of the parameters. When it is reached,
+ * either the search stops, or, with the 'PurgeQueue' policy, the worst half
+ * of each heap is dropped. The search also stops if purging doesn't bring it
+ * back under the budget.
+ *
+ * The number of nodes created and the peaks are written in 'output'. An
+ * exception thrown by a thread, for example when the path elements are full,
+ * stops all the threads and is rethrown once they have been joined.
+ *
+ * Return 'true' iff the budget has been reached, that is, iff the search has
+ * been stopped or nodes have been dropped. In both cases, the search is not
+ * exact anymore.
+ */
 template <typename Distances>
-const Output tree_search(
+bool parallel_best_first_search(
+        const BranchingScheme<Distances>& branching_scheme,
+        const TreeSearchParameters& parameters,
+        TreeSearchOutput& output,
+        const std::function<void(const std::shared_ptr<typename BranchingScheme<Distances>::Node>&, Counter)>& new_solution_callback)
+{
+    using NodePtr = std::shared_ptr<typename BranchingScheme<Distances>::Node>;
+
+    /**
+     * Structure for a heap of the relaxed priority queue.
+     */
+    struct OpenList
+    {
+        /** Nodes; the best one is at the front. */
+        std::vector<NodePtr> nodes;
+
+        /** Guide of the best node; infinity if the heap is empty. */
+        std::atomic<double> top_guide {std::numeric_limits<double>::infinity()};
+
+        /** Mutex. */
+        std::mutex mutex;
+    };
+
+    Counter number_of_threads = (std::max)((Counter)1, parameters.number_of_threads);
+
+    // With a single thread, a single heap makes the search an exact
+    // best-first search.
+    Counter number_of_open_lists = (number_of_threads > 1)?
+        2 * number_of_threads: 1;
+    std::unique_ptr<OpenList[]> open_lists(new OpenList[number_of_open_lists]);
+    auto heap_comparator = [&branching_scheme](
+            const NodePtr& node_1,
+            const NodePtr& node_2)
+    {
+        return branching_scheme(node_2, node_1);
+    };
+
+    // Number of nodes pushed and not completely processed yet.
+    std::atomic<Counter> number_of_pending_nodes {0};
+    // Number of nodes generated.
+    std::atomic<Counter> number_of_nodes {0};
+
+    // Incumbent.
+    std::mutex incumbent_mutex;
+    NodePtr incumbent = nullptr;
+    std::atomic<Counter> incumbent_version {0};
+
+    // Budget.
+    std::atomic<bool> overflow {false};
+    std::atomic<bool> purged {false};
+    std::mutex purge_mutex;
+    std::atomic<Counter> peak_number_of_nodes {0};
+    std::atomic<Counter> peak_number_of_bytes {0};
+    auto update_peak = [](std::atomic<Counter>& peak, Counter value)
+    {
+        Counter peak_cur = peak.load();
+        while (peak_cur < value
+                && !peak.compare_exchange_weak(peak_cur, value)) { }
+    };
+    auto over_budget = [&parameters, &branching_scheme](
+            Counter number_of_open_nodes)
+    {
+        if (parameters.maximum_number_of_nodes >= 0
+                && number_of_open_nodes > parameters.maximum_number_of_nodes) {
+            return true;
+        }
+        if (parameters.maximum_number_of_bytes >= 0
+                && (Counter)branching_scheme.number_of_bytes(number_of_open_nodes)
+                > parameters.maximum_number_of_bytes) {
+            return true;
+        }
+        return false;
+    };
+
+    auto push = [&heap_comparator, &number_of_pending_nodes](
+            OpenList& open_list,
+            const NodePtr& node)
+    {
+        number_of_pending_nodes++;
+        std::lock_guard<std::mutex> lock(open_list.mutex);
+        open_list.nodes.push_back(node);
+        std::push_heap(open_list.nodes.begin(), open_list.nodes.end(), heap_comparator);
+        open_list.top_guide.store(open_list.nodes.front()->guide);
+    };
+
+    auto pop = [&heap_comparator](OpenList& open_list)
+    {
+        std::lock_guard<std::mutex> lock(open_list.mutex);
+        if (open_list.nodes.empty())
+            return NodePtr(nullptr);
+        std::pop_heap(open_list.nodes.begin(), open_list.nodes.end(), heap_comparator);
+        NodePtr node = open_list.nodes.back();
+        open_list.nodes.pop_back();
+        open_list.top_guide.store((open_list.nodes.empty())?
+                std::numeric_limits<double>::infinity():
+                open_list.nodes.front()->guide);
+        return node;
+    };
+
+    // An exception thrown by a worker stops all the workers and is rethrown
+    // once they have been joined.
+    std::atomic<bool> failed {false};
+    std::mutex exception_mutex;
+    std::exception_ptr exception = nullptr;
+
+    auto search = [&](Counter thread_id)
+    {
+        std::mt19937_64 generator(thread_id);
+        std::uniform_int_distribution<Counter> d_open_list(0, number_of_open_lists - 1);
+        NodePtr incumbent_local = nullptr;
+        Counter incumbent_version_local = 0;
+
+        for (;;) {
+            if (parameters.timer.needs_to_end())
+                break;
+            if (overflow.load() || failed.load())
+                break;
+
+            // Check the budget.
+            Counter number_of_open_nodes = number_of_pending_nodes.load();
+            update_peak(peak_number_of_nodes, number_of_open_nodes);
+            update_peak(
+                    peak_number_of_bytes,
+                    branching_scheme.number_of_bytes(number_of_open_nodes));
+            if (over_budget(number_of_open_nodes)) {
+                if (parameters.overflow_policy
+                        != packing_while_travelling::TreeSearchOverflowPolicy::PurgeQueue) {
+                    overflow = true;
+                    break;
+                }
+                // Only one thread purges the open lists; the other ones
+                // check the budget again afterwards.
+                std::lock_guard<std::mutex> lock(purge_mutex);
+                if (over_budget(number_of_pending_nodes.load())) {
+                    for (Counter open_list_id = 0;
+                            open_list_id < number_of_open_lists;
+                            ++open_list_id) {
+                        OpenList& open_list = open_lists[open_list_id];
+                        std::lock_guard<std::mutex> lock(open_list.mutex);
+                        // Sort the nodes from the worst to the best and
+                        // drop the first half.
+                        std::sort_heap(open_list.nodes.begin(), open_list.nodes.end(), heap_comparator);
+                        Counter number_of_dropped_nodes = open_list.nodes.size()
+                            - open_list.nodes.size() / 2;
+                        number_of_pending_nodes -= number_of_dropped_nodes;
+                        open_list.nodes.erase(
+                                open_list.nodes.begin(),
+                                open_list.nodes.begin() + number_of_dropped_nodes);
+                        std::make_heap(open_list.nodes.begin(), open_list.nodes.end(), heap_comparator);
+                        open_list.top_guide.store((open_list.nodes.empty())?
+                                std::numeric_limits<double>::infinity():
+                                open_list.nodes.front()->guide);
+                    }
+                    purged = true;
+                    if (over_budget(number_of_pending_nodes.load())) {
+                        overflow = true;
+                        break;
+                    }
+                }
+                continue;
+            }
+
+            // Pop the best of the tops of two random open lists. If they are
+            // both empty, look at all the open lists.
+            Counter open_list_id_1 = d_open_list(generator);
+            Counter open_list_id_2 = d_open_list(generator);
+            if (open_lists[open_list_id_2].top_guide.load()
+                    < open_lists[open_list_id_1].top_guide.load()) {
+                std::swap(open_list_id_1, open_list_id_2);
+            }
+            NodePtr node = pop(open_lists[open_list_id_1]);
+            if (node == nullptr)
+                node = pop(open_lists[open_list_id_2]);
+            for (Counter open_list_id = 0;
+                    node == nullptr && open_list_id < number_of_open_lists;
+                    ++open_list_id) {
+                node = pop(open_lists[open_list_id]);
+            }
+            if (node == nullptr) {
+                if (number_of_pending_nodes.load() == 0)
+                    break;
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Update the local copy of the incumbent.
+            if (incumbent_version.load() != incumbent_version_local) {
+                std::lock_guard<std::mutex> lock(incumbent_mutex);
+                incumbent_local = incumbent;
+                incumbent_version_local = incumbent_version.load();
+            }
+
+            // Expand the node completely.
+            while (incumbent_local == nullptr
+                    || !branching_scheme.bound(node, incumbent_local)) {
+                if (branching_scheme.infertile(node))
+                    break;
+                NodePtr child = branching_scheme.next_child(node);
+                if (child == nullptr)
+                    continue;
+                number_of_nodes++;
+
+                if (branching_scheme.leaf(child)) {
+                    if (incumbent_local == nullptr
+                            || branching_scheme.better(child, incumbent_local)) {
+                        std::lock_guard<std::mutex> lock(incumbent_mutex);
+                        if (incumbent == nullptr
+                                || branching_scheme.better(child, incumbent)) {
+                            incumbent = child;
+                            incumbent_version++;
+                            new_solution_callback(incumbent, number_of_nodes.load());
+                        }
+                        incumbent_local = incumbent;
+                        incumbent_version_local = incumbent_version.load();
+                    }
+                    continue;
+                }
+
+                if (incumbent_local != nullptr
+                        && branching_scheme.bound(child, incumbent_local)) {
+                    continue;
+                }
+                push(open_lists[d_open_list(generator)], child);
+            }
+
+            number_of_pending_nodes--;
+        }
+    };
+
+    auto worker = [&search, &failed, &exception_mutex, &exception](Counter thread_id)
+    {
+        try {
+            search(thread_id);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(exception_mutex);
+            if (exception == nullptr)
+                exception = std::current_exception();
+            failed = true;
+        }
+    };
+
+    push(open_lists[0], branching_scheme.root());
+    std::vector<std::thread> threads;
+    for (Counter thread_id = 0;
+            thread_id < number_of_threads;
+            ++thread_id) {
+        threads.push_back(std::thread(worker, thread_id));
+    }
+    for (std::thread& thread: threads)
+        thread.join();
+    if (exception != nullptr)
+        std::rethrow_exception(exception);
+
+    output.number_of_nodes = number_of_nodes;
+    output.peak_number_of_nodes = peak_number_of_nodes;
+    output.peak_number_of_bytes = peak_number_of_bytes;
+    return overflow || purged;
+}
+
+template <typename Distances>
+const TreeSearchOutput tree_search(
         const Distances& distances,
         const Instance& instance,
-        const Parameters& parameters)
+        const TreeSearchParameters& parameters)
 {
-    Output output(instance);
+    TreeSearchOutput output(instance);
     AlgorithmFormatter algorithm_formatter(parameters, output);
     algorithm_formatter.start("Tree search");
     algorithm_formatter.print_header();
-
-    auto city_states = packing_while_travelling::compute_city_states<Instance>(instance);
-    BranchingScheme<Distances> branching_scheme(instance, distances, city_states);
-    treesearchsolver::BestFirstSearchParameters<BranchingScheme<Distances>> bfs_parameters;
-    bfs_parameters.timer = parameters.timer;
-    bfs_parameters.verbosity_level = 0;
-    bfs_parameters.new_solution_callback
-        = [&instance, &distances, &city_states, &algorithm_formatter](
-                const treesearchsolver::Output<BranchingScheme<Distances>>& ts_output)
-        {
-            const auto& bfs_output = static_cast<const treesearchsolver::BestFirstSearchOutput<BranchingScheme<Distances>>&>(ts_output);
-            Solution solution(instance);
-            auto node = bfs_output.solution_pool.best();
-            std::vector<std::shared_ptr<typename BranchingScheme<Distances>::Node>> ancestors;
-            for (auto node_tmp = node;
-                    node_tmp->parent != nullptr;
-                    node_tmp = node_tmp->parent) {
-                ancestors.push_back(node_tmp);
-            }
-            std::reverse(ancestors.begin(), ancestors.end());
-            for (auto node_tmp: ancestors) {
-                CityId city_id = node_tmp->last_visited_city_id;
-                CityStateId city_state_id = node_tmp->last_visited_city_state_id;
-                solution.add_city(distances, city_id);
-                for (ItemId item_id: city_states[city_id][city_state_id].item_ids) {
-                    solution.add_item(distances, item_id);
-                }
+    PROFILING_SCOPE("TtpTreeSearch");
+
+    auto city_states = packing_while_travelling::compute_city_state_table<Instance>(
+            instance,
+            parameters.number_of_threads);
+    typename BranchingScheme<Distances>::Parameters bs_parameters;
+    bs_parameters.number_of_threads = parameters.number_of_threads;
+    bs_parameters.number_of_candidates = parameters.number_of_candidates;
+    if (parameters.number_of_candidates > 0
+            && !parameters.lkh_candidate_file_content.empty()) {
+        bs_parameters.candidates = read_lkh_candidate_neighbors(
+                instance,
+                parameters.lkh_candidate_file_content,
+                parameters.number_of_candidates);
+    }
+    BranchingScheme<Distances> branching_scheme(
+            instance,
+            distances,
+            city_states,
+            bs_parameters);
+    auto new_solution_callback = [&instance, &distances, &city_states, &branching_scheme, &algorithm_formatter](
+            const std::shared_ptr<typename BranchingScheme<Distances>::Node>& node,
+            Counter number_of_nodes)
+    {
+        Solution solution(instance);
+        for (auto city: branching_scheme.path(node)) {
+            CityId city_id = city.first;
+            CityStateId city_state_id = city.second;
+            solution.add_city(distances, city_id);
+            for (ItemId item_id: city_states.item_ids(city_id, city_state_id)) {
+                solution.add_item(distances, item_id);
             }
-            std::stringstream ss;
-            ss << "node " << bfs_output.number_of_nodes;
-            algorithm_formatter.update_solution(solution, ss.str());
-        };
-    treesearchsolver::best_first_search(branching_scheme, bfs_parameters);
+        }
+        std::stringstream ss;
+        ss << "node " << number_of_nodes;
+        algorithm_formatter.update_solution(solution, ss.str());
+    };
 
-    if (!parameters.timer.needs_to_end()) {
+    output.overflow = parallel_best_first_search(
+            branching_scheme,
+            parameters,
+            output,
+            new_solution_callback);
+
+    if (output.overflow
+            && parameters.overflow_policy
+            == packing_while_travelling::TreeSearchOverflowPolicy::IterativeBeamSearch) {
+        // A level of the beam keeps the nodes of the level and of the next
+        // level, and the structures of the children of the nodes of the
+        // level.
+        Counter number_of_states = 0;
+        for (CityId city_id = 0;
+                city_id < instance.number_of_cities();
+                ++city_id) {
+            number_of_states += city_states.number_of_states(city_id);
+        }
+        if (parameters.number_of_candidates > 0) {
+            number_of_states = number_of_states
+                * (std::min)(parameters.number_of_candidates, instance.number_of_cities())
+                / instance.number_of_cities();
+        }
+        Counter maximum_size_of_the_queue = std::numeric_limits<Counter>::max();
+        if (parameters.maximum_number_of_nodes >= 0) {
+            maximum_size_of_the_queue = (std::min)(
+                    maximum_size_of_the_queue,
+                    parameters.maximum_number_of_nodes / 2);
+        }
+        if (parameters.maximum_number_of_bytes >= 0) {
+            Counter number_of_bytes_per_node
+                = 2 * branching_scheme.node_number_of_bytes()
+                + number_of_states * branching_scheme.created_node_number_of_bytes();
+            maximum_size_of_the_queue = (std::min)(
+                    maximum_size_of_the_queue,
+                    parameters.maximum_number_of_bytes / number_of_bytes_per_node);
+        }
+        maximum_size_of_the_queue = (std::max)((Counter)1, maximum_size_of_the_queue);
+
+        bool completed = packing_while_travelling::iterative_beam_search(
+                branching_scheme,
+                1,
+                maximum_size_of_the_queue,
+                2,
+                [&parameters]() { return parameters.timer.needs_to_end(); },
+                [&instance, &distances, &city_states, &algorithm_formatter](
+                    const std::shared_ptr<typename BranchingScheme<Distances>::Node>&,
+                    const std::vector<std::pair<CityId, CityStateId>>& path,
+                    Counter width)
+                {
+                    Solution solution(instance);
+                    for (auto city: path) {
+                        CityId city_id = city.first;
+                        CityStateId city_state_id = city.second;
+                        solution.add_city(distances, city_id);
+                        for (ItemId item_id: city_states.item_ids(city_id, city_state_id)) {
+                            solution.add_item(distances, item_id);
+                        }
+                    }
+                    std::stringstream ss;
+                    ss << "queue size " << width;
+                    algorithm_formatter.update_solution(solution, ss.str());
+                });
+        output.peak_number_of_nodes = (std::max)(
+                output.peak_number_of_nodes,
+                2 * maximum_size_of_the_queue);
+        output.peak_number_of_bytes = (std::max)(
+                output.peak_number_of_bytes,
+                (Counter)branching_scheme.number_of_bytes(2 * maximum_size_of_the_queue));
+
+        if (completed && branching_scheme.complete()) {
+            algorithm_formatter.update_bound(
+                    output.solution.objective_value(),
+                    "iterative beam search completed");
+        }
+    } else if (!output.overflow
+            && !parameters.timer.needs_to_end()
+            && branching_scheme.complete()) {
         algorithm_formatter.update_bound(
                 output.solution.objective_value(),
                 "tree search completed");
@@ -486,5 +1843,67 @@ const Output tree_search(
     return output;
 }
 
+template <typename Distances>
+const Output iterative_beam_search(
+        const Distances& distances,
+        const Instance& instance,
+        const IterativeBeamSearchParameters& parameters)
+{
+    Output output(instance);
+    AlgorithmFormatter algorithm_formatter(parameters, output);
+    algorithm_formatter.start("Iterative beam search");
+    algorithm_formatter.print_header();
+    PROFILING_SCOPE("TtpIterativeBeamSearch");
+
+    auto city_states = packing_while_travelling::compute_city_state_table<Instance>(instance);
+    typename BranchingScheme<Distances>::Parameters bs_parameters;
+    bs_parameters.number_of_candidates = parameters.number_of_candidates;
+    if (parameters.number_of_candidates > 0
+            && !parameters.lkh_candidate_file_content.empty()) {
+        bs_parameters.candidates = read_lkh_candidate_neighbors(
+                instance,
+                parameters.lkh_candidate_file_content,
+                parameters.number_of_candidates);
+    }
+    BranchingScheme<Distances> branching_scheme(
+            instance,
+            distances,
+            city_states,
+            bs_parameters);
+    bool completed = packing_while_travelling::iterative_beam_search(
+            branching_scheme,
+            parameters.minimum_size_of_the_queue,
+            parameters.maximum_size_of_the_queue,
+            parameters.growth_factor,
+            [&parameters]() { return parameters.timer.needs_to_end(); },
+            [&instance, &distances, &city_states, &algorithm_formatter](
+                const std::shared_ptr<typename BranchingScheme<Distances>::Node>&,
+                const std::vector<std::pair<CityId, CityStateId>>& path,
+                Counter width)
+            {
+                Solution solution(instance);
+                for (auto city: path) {
+                    CityId city_id = city.first;
+                    CityStateId city_state_id = city.second;
+                    solution.add_city(distances, city_id);
+                    for (ItemId item_id: city_states.item_ids(city_id, city_state_id)) {
+                        solution.add_item(distances, item_id);
+                    }
+                }
+                std::stringstream ss;
+                ss << "queue size " << width;
+                algorithm_formatter.update_solution(solution, ss.str());
+            });
+
+    if (completed && branching_scheme.complete()) {
+        algorithm_formatter.update_bound(
+                output.solution.objective_value(),
+                "iterative beam search completed");
+    }
+
+    algorithm_formatter.end();
+    return output;
+}
+
 }
 }
@@ -0,0 +1,641 @@
+#pragma once
+
+#include "travellingthiefsolver/travelling_thief/solution.hpp"
+
+#include "travellingthiefsolver/travelling_thief/algorithm_formatter.hpp"
+#include "travellingthiefsolver/packing_while_travelling/utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace travellingthiefsolver
+{
+namespace travelling_thief
+{
+
+struct WindowRepairParameters: Parameters
+{
+    /** Initial solution. */
+    const Solution* initial_solution = nullptr;
+
+    /**
+     * City states of the instance; computed if 'nullptr'.
+     *
+     * They only depend on the items and on the capacity, so they can be
+     * reused between calls on the same instance.
+     */
+    const packing_while_travelling::CityStateTable* city_states = nullptr;
+
+    /**
+     * Number of consecutive cities re-optimized together.
+     *
+     * It is capped to 16 since the dynamic programming is exponential in it.
+     */
+    Counter window_size = 8;
+
+    /**
+     * Maximum number of labels created when solving a window.
+     *
+     * If it is reached, the window is left unchanged.
+     */
+    Counter maximum_number_of_labels = 1000000;
+
+    /** Number of threads. */
+    Counter number_of_threads = 1;
+
+
+    virtual int format_width() const override { return 27; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Parameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Window size: " << window_size << std::endl
+            << std::setw(width) << std::left << "Maximum number of labels: " << maximum_number_of_labels << std::endl
+            << std::setw(width) << std::left << "Number of threads: " << number_of_threads << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Parameters::to_json();
+        json.merge_patch({
+                {"WindowSize", window_size},
+                {"MaximumNumberOfLabels", maximum_number_of_labels},
+                {"NumberOfThreads", number_of_threads},
+                });
+        return json;
+    }
+};
+
+struct WindowRepairOutput: Output
+{
+    WindowRepairOutput(
+            const Instance& instance):
+        Output(instance) { }
+
+
+    /** Number of passes over the tour. */
+    Counter number_of_passes = 0;
+
+    /** Number of windows solved. */
+    Counter number_of_windows = 0;
+
+    /** Number of windows given up because of the label limit. */
+    Counter number_of_windows_given_up = 0;
+
+    /** Number of improvements. */
+    Counter number_of_improvements = 0;
+
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Output::to_json();
+        json.merge_patch({
+                {"NumberOfPasses", number_of_passes},
+                {"NumberOfWindows", number_of_windows},
+                {"NumberOfWindowsGivenUp", number_of_windows_given_up},
+                {"NumberOfImprovements", number_of_improvements},
+                });
+        return json;
+    }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Output::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of passes: " << number_of_passes << std::endl
+            << std::setw(width) << std::left << "Number of windows: " << number_of_windows << std::endl
+            << std::setw(width) << std::left << "Number of windows given up: " << number_of_windows_given_up << std::endl
+            << std::setw(width) << std::left << "Number of improvements: " << number_of_improvements << std::endl
+            ;
+    }
+};
+
+/**
+ * Window repair algorithm.
+ *
+ * Windows of 'window_size' consecutive cities are cut out of the tour of the
+ * initial solution. For each of them, the cities before and after the window
+ * and their items are kept; the order of the cities of the window and their
+ * states are re-optimized exactly by a dynamic programming over the subsets of
+ * the window.
+ *
+ * The labels of a subset and a last city are filtered with the dominance rule
+ * of the tree search: a label dominates another one if its time is smaller,
+ * its profit is greater and its weight is smaller. Since the time needed to
+ * travel the rest of the tour only grows with the weight entering it, this
+ * rule remains valid with a fixed suffix.
+ *
+ * The windows of a pass are solved in parallel on the same solution. Then the
+ * improving ones which don't overlap are applied, best first, as long as they
+ * still improve the solution. Passes are repeated until no window improves
+ * the solution.
+ */
+const WindowRepairOutput window_repair(
+        const Instance& instance,
+        const WindowRepairParameters& parameters = {});
+
+template <typename Distances>
+const WindowRepairOutput window_repair(
+        const Distances& distances,
+        const Instance& instance,
+        const WindowRepairParameters& parameters = {});
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+namespace window_repair_internal
+{
+
+/**
+ * Structure for the new content of a window.
+ */
+struct WindowMove
+{
+    /** Position of the first city of the window. */
+    CityPos position = -1;
+
+    /** Improvement of the objective value. */
+    Profit improvement = 0.0;
+
+    /** New cities of the window with their states. */
+    std::vector<std::pair<CityId, CityStateId>> cities;
+};
+
+/**
+ * Structure for a partial path of a window.
+ */
+struct Label
+{
+    /** Weight, including the items collected before the window. */
+    Weight weight;
+
+    /** Time since the beginning of the window. */
+    Time time;
+
+    /** Profit of the items collected in the window. */
+    Profit profit;
+
+    /** Parent label; -1 for the first city of the window. */
+    int64_t parent_label_id;
+
+    /** Position of the last city in the window. */
+    int32_t window_pos;
+
+    /** State of the last city. */
+    CityStateId city_state_id;
+};
+
+/**
+ * Solve the window of 'window_size' cities starting at position 'position'.
+ *
+ * Return a move with a positive improvement iff an improving window has been
+ * found; return 'false' iff the label limit has been reached.
+ */
+template <typename Distances>
+bool solve_window(
+        const Distances& distances,
+        const Instance& instance,
+        const packing_while_travelling::CityStateTable& city_states,
+        const Solution& solution,
+        CityPos position,
+        CityPos window_size,
+        Counter maximum_number_of_labels,
+        WindowMove& move)
+{
+    move.position = position;
+    move.improvement = 0.0;
+    move.cities.clear();
+
+    CityPos number_of_cities = solution.number_of_cities();
+    CityPos position_end = position + window_size;
+    double renting_ratio = instance.renting_ratio();
+
+    // Prefix.
+    Weight prefix_weight = 0;
+    for (CityPos pos = 1; pos < position; ++pos)
+        prefix_weight += solution.city(solution.city_id(pos)).weight;
+    CityId city_id_prev = solution.city_id(position - 1);
+    CityId city_id_next = (position_end < number_of_cities)?
+        solution.city_id(position_end): 0;
+
+    // Suffix. For each leg of the suffix, its distance and the weight
+    // collected in the suffix before it.
+    std::vector<std::pair<Distance, Weight>> suffix_legs;
+    Weight suffix_weight = 0;
+    for (CityPos pos = position_end; pos < number_of_cities; ++pos) {
+        CityId city_id = solution.city_id(pos);
+        CityId city_id_2 = (pos + 1 < number_of_cities)?
+            solution.city_id(pos + 1): 0;
+        suffix_weight += solution.city(city_id).weight;
+        suffix_legs.push_back({
+                distances.distance(city_id, city_id_2),
+                suffix_weight});
+    }
+    auto suffix_time = [&instance, &suffix_legs](Weight weight)
+    {
+        Time time = 0;
+        for (const auto& leg: suffix_legs)
+            time += (double)leg.first / instance.speed(weight + leg.second);
+        return time;
+    };
+
+    // Value of the current window. The terms which don't depend on the window
+    // are omitted.
+    Weight current_weight = prefix_weight;
+    Time current_time = 0;
+    Profit current_profit = 0;
+    for (CityPos pos = position; pos < position_end; ++pos) {
+        CityId city_id = solution.city_id(pos);
+        current_time += instance.duration(
+                distances,
+                solution.city_id(pos - 1),
+                city_id,
+                current_weight);
+        current_weight += solution.city(city_id).weight;
+        current_profit += solution.city(city_id).profit;
+    }
+    current_time += instance.duration(
+            distances,
+            solution.city_id(position_end - 1),
+            city_id_next,
+            current_weight);
+    Profit best_value = current_profit - renting_ratio * (
+            current_time + suffix_time(current_weight));
+    Profit current_value = best_value;
+
+    // The suffix time can't be smaller than with the lightest window.
+    Time suffix_time_bound = suffix_time(prefix_weight);
+    Weight weight_max = instance.capacity() - suffix_weight;
+
+    std::vector<CityId> window_city_ids(window_size);
+    for (CityPos pos = 0; pos < window_size; ++pos)
+        window_city_ids[pos] = solution.city_id(position + pos);
+
+    // Maximum profit collectable in the cities of each subset.
+    uint32_t number_of_subsets = (uint32_t)1 << window_size;
+    std::vector<Profit> subset_profits(number_of_subsets, 0);
+    for (uint32_t subset = 1; subset < number_of_subsets; ++subset) {
+        CityPos pos = 0;
+        while (!(subset & ((uint32_t)1 << pos)))
+            ++pos;
+        subset_profits[subset] = subset_profits[subset & (subset - 1)]
+            + city_states.maximum_total_profit(window_city_ids[pos]);
+    }
+    uint32_t subset_full = number_of_subsets - 1;
+
+    // Labels of each subset and last city. Most pairs are never reached, so
+    // their buckets are only allocated when their first label is added:
+    // 'bucket_ids[subset * window_size + window_pos]' is the bucket of a
+    // pair, -1 if it has none yet.
+    std::vector<Label> labels;
+    std::vector<int32_t> bucket_ids(number_of_subsets * window_size, -1);
+    std::vector<std::vector<int64_t>> buckets;
+    int64_t best_label_id = -1;
+
+    auto add_label = [&](
+            uint32_t subset,
+            const Label& label)
+    {
+        // Check the bound.
+        Profit bound = label.profit
+            + subset_profits[subset_full & ~subset]
+            - renting_ratio * (label.time + suffix_time_bound);
+        if (bound <= best_value)
+            return;
+
+        int32_t& bucket_id = bucket_ids[subset * window_size + label.window_pos];
+        if (bucket_id == -1) {
+            bucket_id = buckets.size();
+            buckets.push_back({});
+        }
+        std::vector<int64_t>& bucket = buckets[bucket_id];
+        for (int64_t label_id: bucket) {
+            const Label& label_2 = labels[label_id];
+            if (label_2.time <= label.time
+                    && label_2.profit >= label.profit
+                    && label_2.weight <= label.weight) {
+                return;
+            }
+        }
+        bucket.erase(std::remove_if(
+                    bucket.begin(),
+                    bucket.end(),
+                    [&labels, &label](int64_t label_id)
+                    {
+                        const Label& label_2 = labels[label_id];
+                        return label.time <= label_2.time
+                            && label.profit >= label_2.profit
+                            && label.weight <= label_2.weight;
+                    }),
+                bucket.end());
+        bucket.push_back(labels.size());
+        labels.push_back(label);
+
+        if (subset == subset_full) {
+            CityId city_id = window_city_ids[label.window_pos];
+            Profit value = label.profit - renting_ratio * (
+                    label.time
+                    + instance.duration(
+                        distances,
+                        city_id,
+                        city_id_next,
+                        label.weight)
+                    + suffix_time(label.weight));
+            if (best_value < value) {
+                best_value = value;
+                best_label_id = labels.size() - 1;
+            }
+        }
+    };
+
+    auto extend = [&](
+            uint32_t subset,
+            CityId city_id,
+            Weight weight,
+            Time time,
+            Profit profit,
+            int64_t label_id)
+    {
+        for (CityPos window_pos = 0; window_pos < window_size; ++window_pos) {
+            if (subset & ((uint32_t)1 << window_pos))
+                continue;
+            CityId city_id_2 = window_city_ids[window_pos];
+            Time time_2 = time + instance.duration(
+                    distances,
+                    city_id,
+                    city_id_2,
+                    weight);
+            // States are sorted by increasing weight.
+            for (CityStateId city_state_id = 0;
+                    city_state_id < city_states.number_of_states(city_id_2);
+                    ++city_state_id) {
+                auto state = city_states.state(city_id_2, city_state_id);
+                if (weight + state.total_weight > weight_max)
+                    break;
+                Label label;
+                label.weight = weight + state.total_weight;
+                label.time = time_2;
+                label.profit = profit + state.total_profit;
+                label.parent_label_id = label_id;
+                label.window_pos = window_pos;
+                label.city_state_id = city_state_id;
+                add_label(subset | ((uint32_t)1 << window_pos), label);
+            }
+        }
+    };
+
+    extend(0, city_id_prev, prefix_weight, 0, 0, -1);
+    // Successors of a subset are greater than it, so the subsets can be
+    // processed in increasing order.
+    for (uint32_t subset = 1; subset < subset_full; ++subset) {
+        for (CityPos window_pos = 0; window_pos < window_size; ++window_pos) {
+            int32_t bucket_id = bucket_ids[subset * window_size + window_pos];
+            if (bucket_id == -1)
+                continue;
+            // Only the buckets of greater subsets are modified while
+            // extending the labels of this one, but new buckets may be
+            // added. The bucket is moved out, which also releases it once
+            // processed.
+            std::vector<int64_t> bucket = std::move(buckets[bucket_id]);
+            for (int64_t label_id: bucket) {
+                if ((Counter)labels.size() > maximum_number_of_labels)
+                    return false;
+                // Copy since 'labels' may be reallocated.
+                Label label = labels[label_id];
+                extend(
+                        subset,
+                        window_city_ids[window_pos],
+                        label.weight,
+                        label.time,
+                        label.profit,
+                        label_id);
+            }
+        }
+    }
+
+    if (best_label_id == -1)
+        return true;
+
+    // Retrieve the window.
+    move.improvement = best_value - current_value;
+    for (int64_t label_id = best_label_id;
+            label_id != -1;
+            label_id = labels[label_id].parent_label_id) {
+        const Label& label = labels[label_id];
+        move.cities.push_back({
+                window_city_ids[label.window_pos],
+                label.city_state_id});
+    }
+    std::reverse(move.cities.begin(), move.cities.end());
+    return true;
+}
+
+/**
+ * Build the solution obtained by applying a set of non-overlapping moves.
+ */
+template <typename Distances>
+Solution apply_moves(
+        const Distances& distances,
+        const Instance& instance,
+        const packing_while_travelling::CityStateTable& city_states,
+        const Solution& solution,
+        const std::vector<const WindowMove*>& moves)
+{
+    std::vector<const WindowMove*> moves_sorted = moves;
+    std::sort(
+            moves_sorted.begin(),
+            moves_sorted.end(),
+            [](const WindowMove* move_1, const WindowMove* move_2)
+            {
+                return move_1->position < move_2->position;
+            });
+
+    Solution new_solution(instance);
+    auto move_it = moves_sorted.begin();
+    for (CityPos pos = 1; pos < solution.number_of_cities();) {
+        if (move_it != moves_sorted.end() && (*move_it)->position == pos) {
+            for (const auto& p: (*move_it)->cities) {
+                new_solution.add_city(distances, p.first);
+                for (ItemId item_id: city_states.item_ids(p.first, p.second))
+                    new_solution.add_item(distances, item_id);
+            }
+            pos += (*move_it)->cities.size();
+            ++move_it;
+            continue;
+        }
+        CityId city_id = solution.city_id(pos);
+        new_solution.add_city(distances, city_id);
+        for (ItemId item_id: instance.city(city_id).item_ids)
+            if (solution.contains(item_id))
+                new_solution.add_item(distances, item_id);
+        ++pos;
+    }
+    return new_solution;
+}
+
+}
+
+template <typename Distances>
+const WindowRepairOutput window_repair(
+        const Distances& distances,
+        const Instance& instance,
+        const WindowRepairParameters& parameters)
+{
+    WindowRepairOutput output(instance);
+    AlgorithmFormatter algorithm_formatter(parameters, output);
+    algorithm_formatter.start("Window repair");
+    algorithm_formatter.print_header();
+
+    if (parameters.initial_solution == nullptr
+            || parameters.initial_solution->number_of_cities() <= 2) {
+        if (parameters.initial_solution != nullptr)
+            algorithm_formatter.update_solution(*parameters.initial_solution, "initial solution");
+        algorithm_formatter.end();
+        return output;
+    }
+    algorithm_formatter.update_solution(*parameters.initial_solution, "initial solution");
+
+    packing_while_travelling::CityStateTable computed_city_states;
+    if (parameters.city_states == nullptr) {
+        computed_city_states = packing_while_travelling::compute_city_state_table<Instance>(
+                instance,
+                parameters.number_of_threads);
+    }
+    const packing_while_travelling::CityStateTable& city_states
+        = (parameters.city_states != nullptr)?
+        *parameters.city_states:
+        computed_city_states;
+
+    // The dynamic programming is exponential in the size of the windows.
+    CityPos window_size = (std::min)(
+            (CityPos)parameters.window_size,
+            (CityPos)16);
+    window_size = (std::min)(
+            window_size,
+            output.solution.number_of_cities() - 1);
+    // Consecutive windows overlap by half of their size so that the
+    // improvements across their boundaries are found as well.
+    CityPos stride = (std::max)((CityPos)1, window_size / 2);
+
+    Solution solution = *parameters.initial_solution;
+    for (;;) {
+        output.number_of_passes++;
+
+        std::vector<CityPos> positions;
+        for (CityPos position = 1;
+                position + window_size <= solution.number_of_cities();
+                position += stride) {
+            positions.push_back(position);
+        }
+        if (positions.back() + window_size < solution.number_of_cities())
+            positions.push_back(solution.number_of_cities() - window_size);
+
+        // Solve the windows.
+        std::vector<window_repair_internal::WindowMove> moves(positions.size());
+        std::atomic<Counter> window_id_next(0);
+        std::atomic<Counter> number_of_windows(0);
+        std::atomic<Counter> number_of_windows_given_up(0);
+        auto worker = [&]()
+        {
+            for (;;) {
+                Counter window_id = window_id_next.fetch_add(1);
+                if (window_id >= (Counter)positions.size())
+                    break;
+                if (parameters.timer.needs_to_end())
+                    break;
+                bool finished = window_repair_internal::solve_window(
+                        distances,
+                        instance,
+                        city_states,
+                        solution,
+                        positions[window_id],
+                        window_size,
+                        parameters.maximum_number_of_labels,
+                        moves[window_id]);
+                number_of_windows++;
+                if (!finished)
+                    number_of_windows_given_up++;
+            }
+        };
+        std::vector<std::thread> threads;
+        for (Counter thread_id = 1;
+                thread_id < parameters.number_of_threads;
+                ++thread_id) {
+            threads.push_back(std::thread(worker));
+        }
+        worker();
+        for (std::thread& thread: threads)
+            thread.join();
+        output.number_of_windows += number_of_windows;
+        output.number_of_windows_given_up += number_of_windows_given_up;
+
+        // Apply the improving windows, best first, as long as they don't
+        // overlap the ones already applied and still improve the solution
+        // once the weights and times around them have changed.
+        std::vector<const window_repair_internal::WindowMove*> improving_moves;
+        for (const auto& move: moves)
+            if (move.improvement > 0)
+                improving_moves.push_back(&move);
+        std::sort(
+                improving_moves.begin(),
+                improving_moves.end(),
+                [](
+                    const window_repair_internal::WindowMove* move_1,
+                    const window_repair_internal::WindowMove* move_2)
+                {
+                    return move_1->improvement > move_2->improvement;
+                });
+        std::vector<const window_repair_internal::WindowMove*> applied_moves;
+        Solution new_solution = solution;
+        for (const auto* move: improving_moves) {
+            bool overlap = false;
+            for (const auto* move_2: applied_moves) {
+                if (move->position < move_2->position + window_size
+                        && move_2->position < move->position + window_size) {
+                    overlap = true;
+                    break;
+                }
+            }
+            if (overlap)
+                continue;
+            applied_moves.push_back(move);
+            Solution solution_tmp = window_repair_internal::apply_moves(
+                    distances,
+                    instance,
+                    city_states,
+                    solution,
+                    applied_moves);
+            if (solution_tmp.feasible()
+                    && solution_tmp.objective_value() > new_solution.objective_value()) {
+                new_solution = solution_tmp;
+            } else {
+                applied_moves.pop_back();
+            }
+        }
+
+        if (applied_moves.empty())
+            break;
+        output.number_of_improvements += applied_moves.size();
+        solution = new_solution;
+
+        // Update output.
+        std::stringstream ss;
+        ss << "pass " << output.number_of_passes;
+        algorithm_formatter.update_solution(solution, ss.str());
+
+        if (parameters.timer.needs_to_end())
+            break;
+    }
+
+    algorithm_formatter.end();
+    return output;
+}
+
+}
+}
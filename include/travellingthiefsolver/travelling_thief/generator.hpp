@@ -0,0 +1,18 @@
+#pragma once
+
+#include "travellingthiefsolver/travelling_thief/instance.hpp"
+#include "travellingthiefsolver/packing_while_travelling/generator.hpp"
+
+namespace travellingthiefsolver
+{
+namespace travelling_thief
+{
+
+/**
+ * Generate a travelling thief instance.
+ */
+Instance generate_instance(
+        const packing_while_travelling::GeneratorParameters& parameters);
+
+}
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "travellingthiefsolver/packing_while_travelling/utils.hpp"
+#include "travellingthiefsolver/packing_while_travelling/binary_instance.hpp"
 
 #include "travelingsalesmansolver/distances/distances.hpp"
 
@@ -77,6 +78,9 @@ public:
     /** Get a city. */
     inline const City& city(CityId city_id) const { return cities_[city_id]; }
 
+    /** Get the items of a city. */
+    inline const std::vector<ItemId>& city_item_ids(CityId city_id) const { return cities_[city_id].item_ids; }
+
     /** Get the speed for a given weight. */
     inline double speed(
             Weight weight) const;
@@ -113,6 +117,12 @@ public:
     /** Get the shared pointer to the distances class. */
     const std::shared_ptr<const travelingsalesmansolver::Distances>& distances_ptr() const { return distances_; }
 
+    /**
+     * Get the coordinates of the cities; 'nullptr' if the distances have not
+     * been read from coordinates.
+     */
+    const std::shared_ptr<const packing_while_travelling::CityCoordinates>& coordinates_ptr() const { return coordinates_; }
+
     /** Get the total weight of the items. */
     inline Weight total_item_weight() const { return total_item_weight_; }
 
@@ -128,6 +138,10 @@ public:
             std::ostream& os,
             int verbosity_level = 1) const;
 
+    /** Write the instance to a file in the binary format. */
+    void write_binary(
+            const std::string& instance_path) const;
+
 private:
 
     /*
@@ -147,6 +161,9 @@ private:
     /** Distances. */
     std::shared_ptr<const travelingsalesmansolver::Distances> distances_;
 
+    /** Coordinates of the cities. */
+    std::shared_ptr<const packing_while_travelling::CityCoordinates> coordinates_;
+
     /** Minimum speed. */
     double speed_min_ = -1;
 
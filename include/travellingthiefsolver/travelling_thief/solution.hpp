@@ -1,6 +1,7 @@
 #pragma once
 
 #include "travellingthiefsolver/travelling_thief/instance.hpp"
+#include "travellingthiefsolver/packing_while_travelling/intermediary_outputs.hpp"
 
 #include "optimizationtools//utils/utils.hpp"
 #include "optimizationtools//utils/output.hpp"
@@ -137,6 +138,10 @@ public:
     void write(
             const std::string& certificate_path) const;
 
+    /** Write the solution to a stream. */
+    void write(
+            std::ostream& os) const;
+
     void write_csv(
             const std::string& output_path) const;
 
@@ -272,6 +277,23 @@ struct Output: optimizationtools::Output
         };
     }
 
+    /**
+     * Export the scalar metrics to a JSON structure.
+     *
+     * Unlike 'to_json', the solution is not exported; this is what is stored
+     * in the intermediary outputs.
+     */
+    nlohmann::json metrics_to_json() const
+    {
+        return nlohmann::json {
+            {"Value", solution_value()},
+            {"Bound", bound},
+            {"AbsoluteOptimalityGap", absolute_optimality_gap()},
+            {"RelativeOptimalityGap", relative_optimality_gap()},
+            {"Time", time}
+        };
+    }
+
     virtual int format_width() const { return 30; }
 
     virtual void format(std::ostream& os) const
@@ -294,10 +316,14 @@ struct Parameters: optimizationtools::Parameters
     /** Callback function called when a new best solution is found. */
     NewSolutionCallback new_solution_callback = [](const Output&, const std::string&) { };
 
+    /** Parameters of the history of intermediary outputs. */
+    packing_while_travelling::IntermediaryOutputsParameters intermediary_outputs_parameters;
+
 
     virtual nlohmann::json to_json() const override
     {
         nlohmann::json json = optimizationtools::Parameters::to_json();
+        json.merge_patch({{"IntermediaryOutputs", intermediary_outputs_parameters.to_json()}});
         return json;
     }
 
@@ -306,6 +332,7 @@ struct Parameters: optimizationtools::Parameters
     virtual void format(std::ostream& os) const override
     {
         optimizationtools::Parameters::format(os);
+        intermediary_outputs_parameters.format(os, format_width());
     }
 };
 
@@ -4,6 +4,7 @@
 
 #include "travellingthiefsolver/packing_while_travelling/solution.hpp"
 #include "travellingthiefsolver/packing_while_travelling/instance_builder.hpp"
+#include "travellingthiefsolver/packing_while_travelling/profiling.hpp"
 #include "travellingthiefsolver/travelling_while_packing/solution.hpp"
 #include "travelingsalesmansolver/solution.hpp"
 
@@ -130,6 +131,7 @@ std::vector<Solution> solve_tsp_lkh(
         const Parameters& parameters,
         std::string& lkh_candidate_file_content)
 {
+    PROFILING_SCOPE("Lkh");
     std::uniform_int_distribution<Counter> d_seed(1, 1e8);
     travelingsalesmansolver::LkhParameters tsp_parameters;
     tsp_parameters.timer = parameters.timer;
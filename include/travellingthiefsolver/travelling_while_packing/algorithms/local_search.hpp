@@ -8,20 +8,149 @@
 //#include "localsearchsolver/best_first_local_search.hpp"
 #include "localsearchsolver/genetic_local_search.hpp"
 
+#include "travellingthiefsolver/packing_while_travelling/multi_start_local_search.hpp"
+
 namespace travellingthiefsolver
 {
 namespace travelling_while_packing
 {
 
+struct LocalSearchParameters: Parameters
+{
+    /** Number of threads. */
+    Counter number_of_threads = 6;
+
+    /** Maximum number of iterations. */
+    Counter maximum_number_of_iterations = 100;
+
+
+    virtual int format_width() const override { return 31; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Parameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of threads: " << number_of_threads << std::endl
+            << std::setw(width) << std::left << "Maximum number of iterations: " << maximum_number_of_iterations << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Parameters::to_json();
+        json.merge_patch({
+                {"NumberOfThreads", number_of_threads},
+                {"MaximumNumberOfIterations", maximum_number_of_iterations},
+                });
+        return json;
+    }
+};
+
 const Output local_search(
         const Instance& instance,
-        const Parameters& parameters = {});
+        const LocalSearchParameters& parameters = {});
 
 template <typename Distances>
 const Output local_search(
         const Distances& distances,
         const Instance& instance,
-        const Parameters& parameters = {});
+        const LocalSearchParameters& parameters = {});
+
+struct MultiStartLocalSearchParameters: Parameters
+{
+    /** Number of threads. */
+    Counter number_of_threads = 1;
+
+    /** Size of the elite pool. */
+    Counter elite_pool_size = 16;
+
+    /**
+     * Probability that a new start is built by crossing two elite solutions
+     * over rather than by perturbing one of them.
+     */
+    double crossover_probability = 0.5;
+
+    /** Maximum number of local searches. */
+    Counter maximum_number_of_iterations = -1;
+
+
+    virtual int format_width() const override { return 31; }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Parameters::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of threads: " << number_of_threads << std::endl
+            << std::setw(width) << std::left << "Elite pool size: " << elite_pool_size << std::endl
+            << std::setw(width) << std::left << "Crossover probability: " << crossover_probability << std::endl
+            << std::setw(width) << std::left << "Maximum number of iterations: " << maximum_number_of_iterations << std::endl
+            ;
+    }
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Parameters::to_json();
+        json.merge_patch({
+                {"NumberOfThreads", number_of_threads},
+                {"ElitePoolSize", elite_pool_size},
+                {"CrossoverProbability", crossover_probability},
+                {"MaximumNumberOfIterations", maximum_number_of_iterations},
+                });
+        return json;
+    }
+};
+
+struct MultiStartLocalSearchOutput: Output
+{
+    MultiStartLocalSearchOutput(
+            const Instance& instance):
+        Output(instance) { }
+
+
+    /** Number of local searches performed. */
+    Counter number_of_iterations = 0;
+
+
+    virtual nlohmann::json to_json() const override
+    {
+        nlohmann::json json = Output::to_json();
+        json.merge_patch({
+                {"NumberOfIterations", number_of_iterations},
+                });
+        return json;
+    }
+
+    virtual void format(std::ostream& os) const override
+    {
+        Output::format(os);
+        int width = format_width();
+        os
+            << std::setw(width) << std::left << "Number of iterations: " << number_of_iterations << std::endl
+            ;
+    }
+};
+
+/**
+ * Parallel multi-start genetic local search for the travelling while
+ * packing problem.
+ *
+ * The threads share the sequencing scheme and an elite pool; new starts
+ * are built from random initial solutions, by crossing elite solutions over,
+ * or by perturbing elite solutions.
+ */
+const MultiStartLocalSearchOutput multi_start_local_search(
+        const Instance& instance,
+        std::mt19937_64& generator,
+        const MultiStartLocalSearchParameters& parameters = {});
+
+template <typename Distances>
+const MultiStartLocalSearchOutput multi_start_local_search(
+        const Distances& distances,
+        const Instance& instance,
+        std::mt19937_64& generator,
+        const MultiStartLocalSearchParameters& parameters = {});
 
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
@@ -125,7 +254,7 @@ template <typename Distances>
 const Output local_search(
         const Distances& distances,
         const Instance& instance,
-        const Parameters& parameters)
+        const LocalSearchParameters& parameters)
 {
     Output output(instance);
     AlgorithmFormatter algorithm_formatter(parameters, output);
@@ -161,8 +290,8 @@ const Output local_search(
     localsearchsolver::GeneticLocalSearchParameters<LocalScheme> gls_parameters;
     gls_parameters.timer = parameters.timer;
     gls_parameters.verbosity_level = 0;
-    gls_parameters.maximum_number_of_iterations = 100;
-    gls_parameters.number_of_threads = 6;
+    gls_parameters.maximum_number_of_iterations = parameters.maximum_number_of_iterations;
+    gls_parameters.number_of_threads = parameters.number_of_threads;
     gls_parameters.new_solution_callback
         = [&instance, &distances, &algorithm_formatter](
                 const localsearchsolver::Output<LocalScheme>& ls_output)
@@ -180,5 +309,51 @@ const Output local_search(
     return output;
 }
 
+template <typename Distances>
+const MultiStartLocalSearchOutput multi_start_local_search(
+        const Distances& distances,
+        const Instance& instance,
+        std::mt19937_64& generator,
+        const MultiStartLocalSearchParameters& parameters)
+{
+    MultiStartLocalSearchOutput output(instance);
+    AlgorithmFormatter algorithm_formatter(parameters, output);
+    algorithm_formatter.start("Multi-start local search");
+    algorithm_formatter.print_header();
+
+    // The sequencing scheme only reads the instance; it is shared by the
+    // local schemes of the threads.
+    using LocalScheme = localsearchsolver::sequencing::LocalScheme<SequencingScheme<Distances>>;
+    SequencingScheme<Distances> sequencing_scheme(instance, distances);
+    localsearchsolver::sequencing::Parameters sequencing_parameters
+        = sequencing_scheme.sequencing_parameters();
+    LocalScheme local_scheme(sequencing_scheme, sequencing_parameters);
+
+    output.number_of_iterations = packing_while_travelling::multi_start_local_search(
+            local_scheme,
+            generator,
+            parameters.number_of_threads,
+            parameters.elite_pool_size,
+            parameters.crossover_probability,
+            parameters.maximum_number_of_iterations,
+            [&parameters]() { return parameters.timer.needs_to_end(); },
+            [&instance, &distances, &algorithm_formatter](
+                const typename LocalScheme::Solution& ls_solution,
+                Counter iteration)
+            {
+                Solution solution(instance);
+                for (auto se: ls_solution.sequences[0].elements) {
+                    CityId city_id = se.element_id + 1;
+                    solution.add_city(distances, city_id);
+                }
+                std::stringstream ss;
+                ss << "iteration " << iteration;
+                algorithm_formatter.update_solution(solution, ss.str());
+            });
+
+    algorithm_formatter.end();
+    return output;
+}
+
 }
 }
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "travellingthiefsolver/travelling_while_packing/instance.hpp"
+#include "travellingthiefsolver/packing_while_travelling/generator.hpp"
+
+namespace travellingthiefsolver
+{
+namespace travelling_while_packing
+{
+
+/**
+ * Generate a travelling while packing instance.
+ *
+ * The weight of each city is the weight of its items selected by the greedy
+ * solution of the knapsack problem.
+ */
+Instance generate_instance(
+        const packing_while_travelling::GeneratorParameters& parameters);
+
+}
+}
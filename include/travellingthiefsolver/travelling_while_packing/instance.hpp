@@ -1,5 +1,7 @@
 #pragma once
 
+#include "travellingthiefsolver/packing_while_travelling/binary_instance.hpp"
+
 #include "travelingsalesmansolver/distances/distances.hpp"
 
 #include <memory>
@@ -72,6 +74,12 @@ public:
     /** Get the shared pointer to the distances class. */
     const std::shared_ptr<const travelingsalesmansolver::Distances>& distances_ptr() const { return distances_; }
 
+    /**
+     * Get the coordinates of the cities; 'nullptr' if the distances have not
+     * been read from coordinates.
+     */
+    const std::shared_ptr<const packing_while_travelling::CityCoordinates>& coordinates_ptr() const { return coordinates_; }
+
     /*
      * Export
      */
@@ -81,6 +89,10 @@ public:
             std::ostream& os,
             int verbosity_level = 1) const;
 
+    /** Write the instance to a file in the binary format. */
+    void write_binary(
+            const std::string& instance_path) const;
+
     /** Write the instance to a file. */
     void write(
             const std::string& instance_path) const;
@@ -104,6 +116,9 @@ private:
     /** Distances. */
     std::shared_ptr<const travelingsalesmansolver::Distances> distances_;
 
+    /** Coordinates of the cities. */
+    std::shared_ptr<const packing_while_travelling::CityCoordinates> coordinates_;
+
     /** Minimum speed. */
     double speed_min_ = -1;
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "travellingthiefsolver/travelling_while_packing/instance.hpp"
+#include "travellingthiefsolver/packing_while_travelling/intermediary_outputs.hpp"
 
 #include "optimizationtools//utils/utils.hpp"
 #include "optimizationtools//utils/output.hpp"
@@ -92,6 +93,10 @@ public:
     void write(
             const std::string& certificate_path) const;
 
+    /** Write the solution to a stream. */
+    void write(
+            std::ostream& os) const;
+
     /** Export solution characteristics to a JSON structure. */
     nlohmann::json to_json() const;
 
@@ -212,6 +217,23 @@ struct Output: optimizationtools::Output
         };
     }
 
+    /**
+     * Export the scalar metrics to a JSON structure.
+     *
+     * Unlike 'to_json', the solution is not exported; this is what is stored
+     * in the intermediary outputs.
+     */
+    nlohmann::json metrics_to_json() const
+    {
+        return nlohmann::json {
+            {"Value", solution_value()},
+            {"Bound", bound},
+            {"AbsoluteOptimalityGap", absolute_optimality_gap()},
+            {"RelativeOptimalityGap", relative_optimality_gap()},
+            {"Time", time}
+        };
+    }
+
     virtual int format_width() const { return 30; }
 
     virtual void format(std::ostream& os) const
@@ -234,10 +256,14 @@ struct Parameters: optimizationtools::Parameters
     /** Callback function called when a new best solution is found. */
     NewSolutionCallback new_solution_callback = [](const Output&, const std::string&) { };
 
+    /** Parameters of the history of intermediary outputs. */
+    packing_while_travelling::IntermediaryOutputsParameters intermediary_outputs_parameters;
+
 
     virtual nlohmann::json to_json() const override
     {
         nlohmann::json json = optimizationtools::Parameters::to_json();
+        json.merge_patch({{"IntermediaryOutputs", intermediary_outputs_parameters.to_json()}});
         return json;
     }
 
@@ -246,6 +272,7 @@ struct Parameters: optimizationtools::Parameters
     virtual void format(std::ostream& os) const override
     {
         optimizationtools::Parameters::format(os);
+        intermediary_outputs_parameters.format(os, format_width());
     }
 };
 
@@ -0,0 +1,45 @@
+import argparse
+import json
+import socket
+import struct
+import sys
+
+parser = argparse.ArgumentParser(
+        description=(
+            "Send the JSON-lines requests read on the standard input to a"
+            " solver daemon and print its responses, one per line."))
+parser.add_argument(
+        "-s", "--socket",
+        type=str,
+        required=True,
+        help="path of the Unix domain socket of the daemon")
+
+args = parser.parse_args()
+
+
+def read_bytes(connection, size):
+    data = b""
+    while len(data) < size:
+        chunk = connection.recv(size - len(data))
+        if not chunk:
+            raise RuntimeError("Connection closed by the daemon.")
+        data += chunk
+    return data
+
+
+def send_request(connection, request):
+    message = json.dumps(request).encode("utf-8")
+    connection.sendall(struct.pack(">I", len(message)) + message)
+    length, = struct.unpack(">I", read_bytes(connection, 4))
+    return json.loads(read_bytes(connection, length).decode("utf-8"))
+
+
+connection = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+connection.connect(args.socket)
+for line in sys.stdin:
+    if not line.strip():
+        continue
+    response = send_request(connection, json.loads(line))
+    print(json.dumps(response))
+    sys.stdout.flush()
+connection.close()
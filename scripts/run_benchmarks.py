@@ -0,0 +1,301 @@
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+parser = argparse.ArgumentParser(
+        description=(
+            "Run a fixed matrix of (problem, algorithm, number of cities,"
+            " seed, time limit) on generated instances and compare the"
+            " results with a baseline."))
+parser.add_argument(
+        "-d", "--directory",
+        type=str,
+        default="benchmark_results",
+        help="directory of the generated instances and of the outputs")
+parser.add_argument(
+        "--bin",
+        type=str,
+        default=os.path.join("install", "bin"),
+        help="directory of the executables")
+parser.add_argument(
+        "-b", "--baseline",
+        type=str,
+        default=os.path.join("benchmarks", "baseline.json"),
+        help="baseline file")
+parser.add_argument(
+        "-u", "--update-baseline",
+        action="store_true",
+        help="write the results to the baseline file instead of comparing")
+parser.add_argument(
+        "--tolerance",
+        type=float,
+        default=0.01,
+        help="relative tolerance on the objective values")
+parser.add_argument(
+        "--throughput-tolerance",
+        type=float,
+        default=0.2,
+        help="relative tolerance on the iterations and evaluations per second")
+parser.add_argument(
+        "--memory-tolerance",
+        type=float,
+        default=0.2,
+        help="relative tolerance on the peak resident set size")
+parser.add_argument(
+        "-j", "--jobs",
+        type=str,
+        nargs='*',
+        help="only run the jobs whose name contains one of these strings")
+
+args = parser.parse_args()
+
+
+# Parameters of the generated instances; the number of cities and the seed are
+# given by the jobs.
+generator_arguments = [
+        "--coordinates", "uniform",
+        "--items", "bounded-strongly-correlated",
+        "--number-of-items-per-city", "3",
+        "--capacity-category", "5"]
+
+# Jobs: (problem, algorithm, number of cities, seed, time limit, additional
+# arguments). The algorithms run on a single thread so that the throughput
+# doesn't depend on the number of cores of the host.
+jobs = [
+        ("travelling-thief", "efficient-local-search", 1000, 0, 10, []),
+        ("travelling-thief", "efficient-local-search", 10000, 0, 30, []),
+        ("packing-while-travelling", "efficient-local-search", 1000, 0, 5, []),
+        ("packing-while-travelling", "efficient-local-search", 100000, 0, 10, []),
+        ("packing-while-travelling", "efficient-local-search", 100000, 0, 10, ["--best-improvement"]),
+        ("packing-while-travelling", "efficient-local-search", 1000000, 0, 30, []),
+        ("packing-while-travelling", "sequential-value-correction", 100000, 0, 10, []),
+        ("thief-orienteering", "local-search", 1000, 0, 10, []),
+        ("travelling-while-packing", "local-search", 1000, 0, 10, [])]
+
+# Objective direction of each problem.
+maximize = {
+        "travelling-thief": True,
+        "packing-while-travelling": True,
+        "thief-orienteering": True,
+        "travelling-while-packing": False}
+
+# Checkpoints of the objective-vs-time curves, as fractions of the time limit.
+checkpoints = [0.1, 0.25, 0.5, 1.0]
+
+
+def job_name(job):
+    problem, algorithm, number_of_cities, seed, time_limit, arguments = job
+    name = "%s/%s/n%d/s%d/t%g" % (
+            problem, algorithm, number_of_cities, seed, time_limit)
+    for argument in arguments:
+        name += "/" + argument.lstrip("-")
+    return name
+
+
+def executable(name):
+    path = os.path.join(args.bin, "travellingthiefsolver_" + name)
+    if sys.platform == "win32":
+        path += ".exe"
+    return path
+
+
+def run(command):
+    """Run a command and return its peak resident set size in bytes, or None
+    if it is not available on this platform."""
+    print(" ".join(command))
+    sys.stdout.flush()
+    process = subprocess.Popen(command, stdout=subprocess.DEVNULL)
+    if not hasattr(os, "wait4"):
+        returncode = process.wait()
+        peak_rss = None
+    else:
+        _, status, rusage = os.wait4(process.pid, 0)
+        returncode = os.waitstatus_to_exitcode(status) \
+            if hasattr(os, "waitstatus_to_exitcode") else (status >> 8)
+        process.returncode = returncode
+        # 'ru_maxrss' is in kilobytes on Linux and in bytes on macOS.
+        peak_rss = rusage.ru_maxrss
+        if sys.platform != "darwin":
+            peak_rss *= 1024
+    if returncode != 0:
+        raise RuntimeError(
+                "Command \"" + " ".join(command) + "\" failed.")
+    return peak_rss
+
+
+def generate_instance(problem, number_of_cities, seed):
+    instance_path = os.path.join(
+            args.directory,
+            "instances",
+            "%s_n%d_s%d.bin" % (problem, number_of_cities, seed))
+    if not os.path.exists(instance_path):
+        os.makedirs(os.path.dirname(instance_path), exist_ok=True)
+        run([executable("generate_instance"),
+             "--problem", problem,
+             "--number-of-cities", str(number_of_cities),
+             "--seed", str(seed),
+             "--verbosity-level", "0",
+             "--output", instance_path]
+            + generator_arguments)
+    return instance_path
+
+
+def value_at(curve, time):
+    """Value of the best solution found before a given time."""
+    value = None
+    for t, v in curve:
+        if t > time:
+            break
+        value = v
+    return value
+
+
+def run_job(job):
+    problem, algorithm, number_of_cities, seed, time_limit, arguments = job
+    instance_path = generate_instance(problem, number_of_cities, seed)
+    json_output_path = os.path.join(
+            args.directory,
+            "outputs",
+            job_name(job).replace("/", "_") + ".json")
+    os.makedirs(os.path.dirname(json_output_path), exist_ok=True)
+    peak_rss = run(
+            [executable(problem.replace("-", "_")),
+             "--input", instance_path,
+             "--format", "binary",
+             "--algorithm", algorithm,
+             "--seed", str(seed),
+             "--time-limit", str(time_limit),
+             "--verbosity-level", "0",
+             "--only-write-at-the-end",
+             "--intermediary-outputs-policy", "log-spaced",
+             "--number-of-threads", "1",
+             "--output", json_output_path]
+            + arguments)
+
+    with open(json_output_path) as json_file:
+        output = json.load(json_file)
+    curve = [[entry["Time"], entry["Value"]]
+             for entry in output.get("IntermediaryOutputs", [])]
+    result = {
+            "Value": output["Output"]["Value"],
+            "Time": output["Output"]["Time"],
+            "Curve": curve,
+            "PeakRss": peak_rss}
+    time = max(output["Output"]["Time"], 1e-9)
+    if "NumberOfIterations" in output["Output"]:
+        result["IterationsPerSecond"] = (
+                output["Output"]["NumberOfIterations"] / time)
+    # Move evaluations and tree search children counted by the profiling
+    # instrumentation.
+    number_of_evaluations = sum(
+            entry["Count"]
+            for name, entry in output.get("Profile", {}).items()
+            if name.endswith("Evaluations") or name.endswith("Children"))
+    if number_of_evaluations > 0:
+        result["EvaluationsPerSecond"] = number_of_evaluations / time
+    return result
+
+
+def relative_degradation(baseline, current, higher_is_better):
+    """Relative degradation of 'current' compared to 'baseline'; negative if
+    it is an improvement."""
+    difference = (baseline - current) if higher_is_better else (current - baseline)
+    return difference / max(abs(baseline), 1e-9)
+
+
+def compare(job, baseline, result):
+    """Return the list of the regressions of a job."""
+    problem, _, _, _, time_limit, _ = job
+    regressions = []
+
+    # Objective values along the curve.
+    for checkpoint in checkpoints:
+        time = checkpoint * time_limit
+        baseline_value = value_at(baseline["Curve"], time)
+        if checkpoint == 1.0:
+            baseline_value = baseline["Value"]
+        if baseline_value is None:
+            continue
+        value = value_at(result["Curve"], time)
+        if checkpoint == 1.0:
+            value = result["Value"]
+        if value is None:
+            regressions.append(
+                    "no solution at %gs (baseline: %g)" % (time, baseline_value))
+            continue
+        degradation = relative_degradation(
+                baseline_value, value, maximize[problem])
+        if degradation > args.tolerance:
+            regressions.append(
+                    "value at %gs: %g (baseline: %g, %+.2f%%)" % (
+                        time, value, baseline_value, -100 * degradation))
+
+    # Throughput.
+    for key in ["IterationsPerSecond", "EvaluationsPerSecond"]:
+        if baseline.get(key) is None or result.get(key) is None:
+            continue
+        degradation = relative_degradation(baseline[key], result[key], True)
+        if degradation > args.throughput_tolerance:
+            regressions.append(
+                    "%s: %g (baseline: %g, %+.2f%%)" % (
+                        key, result[key], baseline[key], -100 * degradation))
+
+    # Memory.
+    if baseline.get("PeakRss") is not None and result.get("PeakRss") is not None:
+        degradation = relative_degradation(
+                baseline["PeakRss"], result["PeakRss"], False)
+        if degradation > args.memory_tolerance:
+            regressions.append(
+                    "PeakRss: %d (baseline: %d, %+.2f%%)" % (
+                        result["PeakRss"], baseline["PeakRss"], 100 * degradation))
+
+    return regressions
+
+
+if args.jobs is not None:
+    jobs = [job for job in jobs
+            if any(pattern in job_name(job) for pattern in args.jobs)]
+
+results = {}
+for job in jobs:
+    results[job_name(job)] = run_job(job)
+    print()
+
+results_path = os.path.join(args.directory, "results.json")
+with open(results_path, "w") as results_file:
+    json.dump(results, results_file, indent=4)
+
+if args.update_baseline:
+    baseline = {}
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as baseline_file:
+            baseline = json.load(baseline_file)
+    baseline.update(results)
+    with open(args.baseline, "w") as baseline_file:
+        json.dump(baseline, baseline_file, indent=4, sort_keys=True)
+    print("Baseline written to \"" + args.baseline + "\".")
+    sys.exit(0)
+
+if not os.path.exists(args.baseline):
+    print("Baseline \"" + args.baseline + "\" not found;"
+          " run with --update-baseline first.")
+    sys.exit(1)
+with open(args.baseline) as baseline_file:
+    baseline = json.load(baseline_file)
+
+number_of_regressions = 0
+for job in jobs:
+    name = job_name(job)
+    result = results[name]
+    if name not in baseline:
+        print("%-64s NO BASELINE" % name)
+        continue
+    regressions = compare(job, baseline[name], result)
+    print("%-64s %s" % (name, "REGRESSION" if regressions else "OK"))
+    for regression in regressions:
+        print("    " + regression)
+    number_of_regressions += len(regressions)
+
+sys.exit(1 if number_of_regressions > 0 else 0)
@@ -1,4 +1,5 @@
 import argparse
+import json
 import sys
 import os
 
@@ -100,6 +101,155 @@ if args.tests is None or "travelling-thief-tree-search" in args.tests:
     print()
 
 
+convert_instance_main = os.path.join(
+        "install",
+        "bin",
+        "travellingthiefsolver_convert_instance")
+
+
+def strip_times(json_output):
+    """Remove the measures which differ between two identical runs."""
+    if isinstance(json_output, dict):
+        return {
+                key: strip_times(value)
+                for key, value in json_output.items()
+                if key not in ("Time", "Profile")}
+    if isinstance(json_output, list):
+        return [strip_times(value) for value in json_output]
+    return json_output
+
+
+failures = []
+
+
+if args.tests is None or "travelling-thief-instance-formats" in args.tests:
+    print("Travelling thief problem / instance formats")
+    print("-------------------------------------------")
+    print()
+
+    # The same instance is read by the text reader, by the stream reader and,
+    # after conversion, by the binary reader; a deterministic tree search must
+    # return the same output on all of them.
+    data = [
+            os.path.join("wu2017", "eil51_n05_m40_multiple-strongly-corr_01.ttp"),
+            os.path.join("wu2017", "eil51_n05_m40_uncorr_01.ttp"),
+            os.path.join("wu2017", "eil51_n05_m40_uncorr-similar-weights_01.ttp")]
+    for instance in data:
+        instance_path = os.path.join(
+                travelling_thief_data,
+                instance)
+        output_path = os.path.join(
+                args.directory,
+                "travelling_thief",
+                "instance_formats",
+                instance)
+        if not os.path.exists(os.path.dirname(output_path)):
+            os.makedirs(os.path.dirname(output_path))
+        command = (
+                convert_instance_main
+                + "  --input \"" + instance_path + "\""
+                + "  --problem travelling-thief"
+                + "  --output \"" + output_path + ".bin\"")
+        print(command)
+        os.system(command)
+
+        json_outputs = {}
+        for format, path in [
+                ("polyakovskiy2014", instance_path),
+                ("polyakovskiy2014_stream", instance_path),
+                ("binary", output_path + ".bin")]:
+            json_output_path = output_path + "_" + format + ".json"
+            command = (
+                    travelling_thief_main
+                    + "  --verbosity-level 0"
+                    + "  --input \"" + path + "\""
+                    + "  --format " + format
+                    + "  --algorithm tree-search"
+                    + "  --number-of-threads 1"
+                    + "  --output \"" + json_output_path + "\"")
+            print(command)
+            os.system(command)
+            with open(json_output_path) as json_output_file:
+                json_outputs[format] = strip_times(json.load(json_output_file))
+        for format in ["polyakovskiy2014_stream", "binary"]:
+            if json_outputs[format] != json_outputs["polyakovskiy2014"]:
+                print("Different outputs with formats polyakovskiy2014 and " + format + ".")
+                failures.append(instance + " (" + format + ")")
+        print()
+    print()
+    print()
+
+
+packing_while_travelling_main = os.path.join(
+        "install",
+        "bin",
+        "travellingthiefsolver_packing_while_travelling")
+solution2instances_main = os.path.join(
+        "install",
+        "bin",
+        "travellingthiefsolver_travelling_thief_solution2instances")
+
+
+if args.tests is None or "packing-while-travelling-efficient-local-search" in args.tests:
+    print("Packing while travelling / efficient local search")
+    print("-------------------------------------------------")
+    print()
+
+    data = [
+            os.path.join("polyakovskiy2014", "berlin52-ttp", "berlin52_n51_bounded-strongly-corr_01.ttp"),
+            os.path.join("polyakovskiy2014", "berlin52-ttp", "berlin52_n153_uncorr_01.ttp"),
+            os.path.join("polyakovskiy2014", "berlin52-ttp", "berlin52_n255_uncorr-similar-weights_01.ttp")]
+    for instance in data:
+        instance_path = os.path.join(
+                travelling_thief_data,
+                instance)
+        output_directory = os.path.join(
+                args.directory,
+                "packing_while_travelling",
+                "efficient_local_search")
+        output_path = os.path.join(
+                output_directory,
+                instance)
+        if not os.path.exists(os.path.dirname(output_path)):
+            os.makedirs(os.path.dirname(output_path))
+
+        # Build the PWT instance from the tour of a TTP solution.
+        command = (
+                travelling_thief_main
+                + "  --verbosity-level 0"
+                + "  --input \"" + instance_path + "\""
+                + "  --algorithm local-search"
+                + " --maximum-number-of-iterations 1"
+                + "  --certificate \"" + output_path + ".sol\"")
+        print(command)
+        os.system(command)
+        command = (
+                solution2instances_main
+                + "  --input \"" + instance_path + "\""
+                + "  --certificate \"" + output_path + ".sol\""
+                + "  --output \"" + output_path + "\"")
+        print(command)
+        os.system(command)
+
+        # Compare first-improvement and best-improvement.
+        for name, options in [
+                ("first_improvement", ""),
+                ("best_improvement_1", " --best-improvement --number-of-threads 1"),
+                ("best_improvement_4", " --best-improvement --number-of-threads 4")]:
+            command = (
+                    packing_while_travelling_main
+                    + "  --verbosity-level 1"
+                    + "  --input \"" + output_path + ".pwt\""
+                    + "  --algorithm efficient-local-search"
+                    + options
+                    + "  --output \"" + output_path + "_" + name + ".json\"")
+            print(command)
+            os.system(command)
+            print()
+    print()
+    print()
+
+
 thief_orienteering_data = os.environ['THIEF_ORIENTEERING_DATA']
 thief_orienteering_main = os.path.join(
         "install",
@@ -145,3 +295,10 @@ if args.tests is None or "thief-orienteering-local-search" in args.tests:
         print()
     print()
     print()
+
+
+if failures:
+    print("Failures:")
+    for failure in failures:
+        print("- " + failure)
+    sys.exit(1)
@@ -0,0 +1,73 @@
+#include "travellingthiefsolver/packing_while_travelling/instance_builder.hpp"
+#include "travellingthiefsolver/thief_orienteering/instance_builder.hpp"
+#include "travellingthiefsolver/travelling_thief/instance_builder.hpp"
+#include "travellingthiefsolver/travelling_while_packing/instance_builder.hpp"
+
+#include <boost/program_options.hpp>
+
+/**
+ * Read an instance and write it in the binary format.
+ */
+template <typename InstanceBuilder>
+void run(
+        const std::string& instance_path,
+        const std::string& format,
+        const std::string& output_path)
+{
+    InstanceBuilder instance_builder;
+    instance_builder.read(instance_path, format);
+    auto instance = instance_builder.build();
+    instance.write_binary(output_path);
+}
+
+int main(int argc, char *argv[])
+{
+    namespace po = boost::program_options;
+
+    // Parse program options
+
+    std::string instance_path = "";
+    std::string format = "";
+    std::string problem = "travelling-thief";
+    std::string output_path = "";
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("input,i", po::value<std::string>(&instance_path)->required(), "set input file (required)")
+        ("format,f", po::value<std::string>(&format), "set input file format (default: standard, binary)")
+        ("problem,p", po::value<std::string>(&problem), "set problem (travelling-thief, thief-orienteering, packing-while-travelling, travelling-while-packing)")
+        ("output,o", po::value<std::string>(&output_path)->required(), "set binary output file (required)")
+        ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+        std::cout << desc << std::endl;;
+        return 1;
+    }
+    try {
+        po::notify(vm);
+    } catch (const po::required_option& e) {
+        std::cout << desc << std::endl;;
+        return 1;
+    }
+
+    if (problem == "travelling-thief") {
+        run<travellingthiefsolver::travelling_thief::InstanceBuilder>(
+                instance_path, format, output_path);
+    } else if (problem == "thief-orienteering") {
+        run<travellingthiefsolver::thief_orienteering::InstanceBuilder>(
+                instance_path, format, output_path);
+    } else if (problem == "packing-while-travelling") {
+        run<travellingthiefsolver::packing_while_travelling::InstanceBuilder>(
+                instance_path, format, output_path);
+    } else if (problem == "travelling-while-packing") {
+        run<travellingthiefsolver::travelling_while_packing::InstanceBuilder>(
+                instance_path, format, output_path);
+    } else {
+        throw std::invalid_argument(
+                "Unknown problem \"" + problem + "\".");
+    }
+
+    return 0;
+}
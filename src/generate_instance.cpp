@@ -0,0 +1,83 @@
+#include "travellingthiefsolver/packing_while_travelling/generator.hpp"
+#include "travellingthiefsolver/thief_orienteering/generator.hpp"
+#include "travellingthiefsolver/travelling_thief/generator.hpp"
+#include "travellingthiefsolver/travelling_while_packing/generator.hpp"
+
+#include <boost/program_options.hpp>
+
+/**
+ * Generate an instance and write it in the binary format.
+ */
+template <typename Instance>
+void run(
+        Instance (*generate_instance)(const travellingthiefsolver::packing_while_travelling::GeneratorParameters&),
+        const travellingthiefsolver::packing_while_travelling::GeneratorParameters& parameters,
+        const std::string& output_path,
+        int verbosity_level)
+{
+    Instance instance = generate_instance(parameters);
+    instance.format(std::cout, verbosity_level);
+    instance.write_binary(output_path);
+}
+
+int main(int argc, char *argv[])
+{
+    namespace po = boost::program_options;
+    using travellingthiefsolver::packing_while_travelling::CoordinatesDistribution;
+    using travellingthiefsolver::packing_while_travelling::ItemsCorrelation;
+
+    // Parse program options
+
+    travellingthiefsolver::packing_while_travelling::GeneratorParameters parameters;
+    std::string problem = "travelling-thief";
+    std::string output_path = "";
+    int verbosity_level = 1;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("problem,p", po::value<std::string>(&problem), "set problem (travelling-thief, thief-orienteering, packing-while-travelling, travelling-while-packing)")
+        ("output,o", po::value<std::string>(&output_path)->required(), "set binary output file (required)")
+        ("number-of-cities,n", po::value<int64_t>(&parameters.number_of_cities), "set number of cities")
+        ("coordinates,c", po::value<CoordinatesDistribution>(&parameters.coordinates_distribution), "set distribution of the coordinates (uniform, clustered, tsplib-like)")
+        ("items,i", po::value<ItemsCorrelation>(&parameters.items_correlation), "set correlation of the items (uncorrelated, bounded-strongly-correlated, uncorrelated-similar-weights)")
+        ("number-of-items-per-city,", po::value<int64_t>(&parameters.number_of_items_per_city), "set number of items per city")
+        ("capacity-category,", po::value<int64_t>(&parameters.capacity_category), "set capacity category (1 to 10)")
+        ("minimum-speed,", po::value<double>(&parameters.minimum_speed), "set minimum speed")
+        ("maximum-speed,", po::value<double>(&parameters.maximum_speed), "set maximum speed")
+        ("time-limit-factor,", po::value<double>(&parameters.time_limit_factor), "set time limit factor (thief-orienteering)")
+        ("seed,s", po::value<int64_t>(&parameters.seed), "set seed")
+        ("verbosity-level,v", po::value<int>(&verbosity_level), "set verbosity level")
+        ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+        std::cout << desc << std::endl;;
+        return 1;
+    }
+    try {
+        po::notify(vm);
+    } catch (const po::required_option& e) {
+        std::cout << desc << std::endl;;
+        return 1;
+    }
+
+    if (problem == "travelling-thief") {
+        run(travellingthiefsolver::travelling_thief::generate_instance,
+                parameters, output_path, verbosity_level);
+    } else if (problem == "thief-orienteering") {
+        run(travellingthiefsolver::thief_orienteering::generate_instance,
+                parameters, output_path, verbosity_level);
+    } else if (problem == "packing-while-travelling") {
+        run(travellingthiefsolver::packing_while_travelling::generate_instance,
+                parameters, output_path, verbosity_level);
+    } else if (problem == "travelling-while-packing") {
+        run(travellingthiefsolver::travelling_while_packing::generate_instance,
+                parameters, output_path, verbosity_level);
+    } else {
+        throw std::invalid_argument(
+                "Unknown problem \"" + problem + "\".");
+    }
+
+    return 0;
+}
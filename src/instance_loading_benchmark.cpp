@@ -0,0 +1,109 @@
+#include "travellingthiefsolver/packing_while_travelling/instance_builder.hpp"
+#include "travellingthiefsolver/thief_orienteering/instance_builder.hpp"
+#include "travellingthiefsolver/travelling_thief/instance_builder.hpp"
+#include "travellingthiefsolver/travelling_while_packing/instance_builder.hpp"
+
+#include <boost/program_options.hpp>
+
+#include <chrono>
+#include <iomanip>
+#include <limits>
+
+/**
+ * Load an instance several times with each reader and print the loading
+ * times.
+ */
+template <typename InstanceBuilder>
+void run(
+        const std::string& instance_path,
+        const std::vector<std::string>& formats,
+        int number_of_repetitions)
+{
+    for (const std::string& format: formats) {
+        double time_min = std::numeric_limits<double>::infinity();
+        double time_total = 0;
+        for (int repetition = 0;
+                repetition < number_of_repetitions;
+                ++repetition) {
+            auto start = std::chrono::steady_clock::now();
+            InstanceBuilder instance_builder;
+            instance_builder.read(instance_path, format);
+            auto instance = instance_builder.build();
+            auto end = std::chrono::steady_clock::now();
+            double time = std::chrono::duration<double>(end - start).count();
+            time_min = (std::min)(time_min, time);
+            time_total += time;
+            if (repetition == 0) {
+                std::cout << "Format: " << format
+                    << "; number of cities: " << instance.number_of_cities()
+                    << std::endl;
+            }
+        }
+        std::cout << std::setw(24) << std::left << format
+            << "min " << time_min << " s"
+            << "; mean " << time_total / number_of_repetitions << " s"
+            << std::endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    namespace po = boost::program_options;
+
+    // Parse program options
+
+    std::string instance_path = "";
+    std::string binary_instance_path = "";
+    std::string problem = "travelling-thief";
+    int number_of_repetitions = 5;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("input,i", po::value<std::string>(&instance_path)->required(), "set input file (required)")
+        ("binary-input", po::value<std::string>(&binary_instance_path), "set the same instance converted to the binary format")
+        ("problem,p", po::value<std::string>(&problem), "set problem (travelling-thief, thief-orienteering, packing-while-travelling, travelling-while-packing)")
+        ("repetitions,r", po::value<int>(&number_of_repetitions), "set number of repetitions")
+        ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+        std::cout << desc << std::endl;;
+        return 1;
+    }
+    try {
+        po::notify(vm);
+    } catch (const po::required_option& e) {
+        std::cout << desc << std::endl;;
+        return 1;
+    }
+
+    // Memory-mapped reader and stream-based reader, and binary reader if the
+    // instance has been converted.
+    std::vector<std::string> formats = {"polyakovskiy2014", "polyakovskiy2014_stream"};
+    std::vector<std::string> binary_formats = {"binary"};
+    auto run_formats = [&](const std::string& path, const std::vector<std::string>& formats)
+    {
+        if (problem == "travelling-thief") {
+            run<travellingthiefsolver::travelling_thief::InstanceBuilder>(
+                    path, formats, number_of_repetitions);
+        } else if (problem == "thief-orienteering") {
+            run<travellingthiefsolver::thief_orienteering::InstanceBuilder>(
+                    path, formats, number_of_repetitions);
+        } else if (problem == "packing-while-travelling") {
+            run<travellingthiefsolver::packing_while_travelling::InstanceBuilder>(
+                    path, formats, number_of_repetitions);
+        } else if (problem == "travelling-while-packing") {
+            run<travellingthiefsolver::travelling_while_packing::InstanceBuilder>(
+                    path, formats, number_of_repetitions);
+        } else {
+            throw std::invalid_argument(
+                    "Unknown problem \"" + problem + "\".");
+        }
+    };
+    run_formats(instance_path, formats);
+    if (!binary_instance_path.empty())
+        run_formats(binary_instance_path, binary_formats);
+
+    return 0;
+}
@@ -100,7 +100,10 @@ void AlgorithmFormatter::update_solution(
         output_.time = parameters_.timer.elapsed_time();
         output_.solution = solution;
         print(s);
-        output_.json["IntermediaryOutputs"].push_back(output_.to_json());
+        intermediary_outputs_.add(
+                output_.json,
+                output_.metrics_to_json(),
+                output_.time);
         parameters_.new_solution_callback(output_, s);
     }
 }
@@ -116,7 +119,10 @@ void AlgorithmFormatter::update_bound(
         output_.time = parameters_.timer.elapsed_time();
         output_.bound = bound;
         print(s);
-        output_.json["IntermediaryOutputs"].push_back(output_.to_json());
+        intermediary_outputs_.add(
+                output_.json,
+                output_.metrics_to_json(),
+                output_.time);
         parameters_.new_solution_callback(output_, s);
     }
 }
@@ -125,6 +131,9 @@ void AlgorithmFormatter::end()
 {
     output_.time = parameters_.timer.elapsed_time();
     output_.json["Output"] = output_.to_json();
+    intermediary_outputs_.write(output_.json);
+    if (profiling::enabled)
+        output_.json["Profile"] = profiling::to_json(profiling_start_);
 
     if (parameters_.verbosity_level == 0)
         return;
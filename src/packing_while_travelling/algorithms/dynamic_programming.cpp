@@ -5,6 +5,95 @@
 
 using namespace travellingthiefsolver::packing_while_travelling;
 
+void travellingthiefsolver::packing_while_travelling::dynamic_programming_internal::update_city_row(
+        const Instance& instance,
+        Weight city_weight,
+        Distance distance_to_end,
+        Weight weight_min,
+        Weight weight_max,
+        const std::vector<double>& beta_prev,
+        std::vector<double>& beta)
+{
+    for (Weight weight = weight_min; weight <= weight_max; ++weight) {
+        if (weight - city_weight < 0
+                || (beta_prev[weight - city_weight]
+                    == -std::numeric_limits<double>::infinity())) {
+            beta[weight] = -std::numeric_limits<double>::infinity();
+        } else {
+            double speed_with
+                = instance.maximum_speed()
+                - (double)weight
+                * (instance.maximum_speed() - instance.minimum_speed())
+                / instance.capacity();
+            double speed_without
+                = instance.maximum_speed()
+                - (double)(weight - city_weight)
+                * (instance.maximum_speed() - instance.minimum_speed())
+                / instance.capacity();
+            Profit cost_with
+                = instance.renting_ratio()
+                * (double)distance_to_end
+                / speed_with;
+            Profit cost_without
+                = instance.renting_ratio()
+                * (double)distance_to_end
+                / speed_without;
+            double value
+                = beta_prev[weight - city_weight]
+                - cost_with
+                + cost_without;
+            beta[weight] = value;
+        }
+    }
+}
+
+void travellingthiefsolver::packing_while_travelling::dynamic_programming_internal::update_item_row(
+        const Instance& instance,
+        const Item& item,
+        Distance distance_to_end,
+        Weight weight_min,
+        Weight weight_max,
+        const std::vector<double>& beta_prev,
+        std::vector<double>& beta)
+{
+    for (Weight weight = weight_min;
+            weight <= weight_max;
+            ++weight) {
+        if (weight - item.weight < 0
+                || (beta_prev[weight - item.weight]
+                    == -std::numeric_limits<double>::infinity())) {
+            beta[weight] = beta_prev[weight];
+        } else {
+            double speed_with
+                = instance.maximum_speed()
+                - (double)weight
+                * (instance.maximum_speed() - instance.minimum_speed())
+                / instance.capacity();
+            double speed_without
+                = instance.maximum_speed()
+                - (double)(weight - item.weight)
+                * (instance.maximum_speed() - instance.minimum_speed())
+                / instance.capacity();
+            Profit cost_with
+                = instance.renting_ratio()
+                * (double)distance_to_end
+                / speed_with;
+            Profit cost_without
+                = instance.renting_ratio()
+                * (double)distance_to_end
+                / speed_without;
+            double value
+                = beta_prev[weight - item.weight]
+                + item.profit
+                - cost_with
+                + cost_without;
+            beta[weight] = std::max(
+                    beta_prev[weight],
+                    value);
+        }
+    }
+}
+
 Output travellingthiefsolver::packing_while_travelling::dynamic_programming(
         const Instance& instance,
         const DynamicProgrammingParameters& parameters)
@@ -28,7 +117,7 @@ Output travellingthiefsolver::packing_while_travelling::dynamic_programming(
     // Initialize table.
     beta[0][0]
         = -instance.renting_ratio()
-        * instance.city(0).distance_to_end
+        * instance.city_distances_to_end()[0]
         / instance.maximum_speed();
 
     // compute the rest of the table
@@ -36,86 +125,38 @@ Output travellingthiefsolver::packing_while_travelling::dynamic_programming(
     std::vector<std::pair<bool, ItemId>> rows(number_of_rows, {false, -1});
     Weight weight_min = 0;
     Weight weight_max = 0;
+    const std::vector<Weight>& city_weights = instance.city_weights();
+    const std::vector<Distance>& city_distances_to_end = instance.city_distances_to_end();
     for (CityId city_id = 0;
             city_id < instance.number_of_cities();
             ++city_id) {
-        const City& city = instance.city(city_id);
-
-        weight_min += city.weight;
-        weight_max = std::min(weight_max + city.weight, instance.capacity());
-        for (Weight weight = weight_min; weight <= weight_max; ++weight) {
-            if (weight - city.weight < 0
-                    || (beta[row - 1][weight - city.weight]
-                        == -std::numeric_limits<double>::infinity())) {
-                beta[row][weight] = -std::numeric_limits<double>::infinity();
-            } else {
-                double speed_with
-                    = instance.maximum_speed()
-                    - (double)weight
-                    * (instance.maximum_speed() - instance.minimum_speed())
-                    / instance.capacity();
-                double speed_without
-                    = instance.maximum_speed()
-                    - (double)(weight - city.weight)
-                    * (instance.maximum_speed() - instance.minimum_speed())
-                    / instance.capacity();
-                Profit cost_with
-                    = instance.renting_ratio()
-                    * (double)city.distance_to_end
-                    / speed_with;
-                Profit cost_without
-                    = instance.renting_ratio()
-                    * (double)city.distance_to_end
-                    / speed_without;
-                double value
-                    = beta[row - 1][weight - city.weight]
-                    - cost_with
-                    + cost_without;
-                beta[row][weight] = value;
-            }
-        }
+        Weight city_weight = city_weights[city_id];
+        Distance distance_to_end = city_distances_to_end[city_id];
+
+        weight_min += city_weight;
+        weight_max = std::min(weight_max + city_weight, instance.capacity());
+        dynamic_programming_internal::update_city_row(
+                instance,
+                city_weight,
+                distance_to_end,
+                weight_min,
+                weight_max,
+                beta[row - 1],
+                beta[row]);
         rows[row] = {true, city_id};
         row++;
 
-        for (ItemId item_id: city.item_ids) {
+        for (ItemId item_id: instance.city_item_ids(city_id)) {
             const Item& item = instance.item(item_id);
             weight_max = std::min(weight_max + item.weight, instance.capacity());
-            for (Weight weight = weight_min;
-                    weight <= weight_max;
-                    ++weight) {
-                if (weight - item.weight < 0
-                        || (beta[row - 1][weight - item.weight]
-                            == -std::numeric_limits<double>::infinity())) {
-                    beta[row][weight] = beta[row - 1][weight];
-                } else {
-                    double speed_with
-                        = instance.maximum_speed()
-                        - (double)weight
-                        * (instance.maximum_speed() - instance.minimum_speed())
-                        / instance.capacity();
-                    double speed_without
-                        = instance.maximum_speed()
-                        - (double)(weight - item.weight)
-                        * (instance.maximum_speed() - instance.minimum_speed())
-                        / instance.capacity();
-                    Profit cost_with
-                        = instance.renting_ratio()
-                        * (double)city.distance_to_end
-                        / speed_with;
-                    Profit cost_without
-                        = instance.renting_ratio()
-                        * (double)city.distance_to_end
-                        / speed_without;
-                    double value
-                        = beta[row - 1][weight - item.weight]
-                        + item.profit
-                        - cost_with
-                        + cost_without;
-                    beta[row][weight] = std::max(
-                            beta[row - 1][weight],
-                            value);
-                }
-            }
+            dynamic_programming_internal::update_item_row(
+                    instance,
+                    item,
+                    distance_to_end,
+                    weight_min,
+                    weight_max,
+                    beta[row - 1],
+                    beta[row]);
             rows[row] = {false, item_id};
             row++;
         }
@@ -139,7 +180,7 @@ Output travellingthiefsolver::packing_while_travelling::dynamic_programming(
         if (rows[row].first) {
             // City.
             CityId city_id = rows[row].second;
-            current_weight -= instance.city(city_id).weight;
+            current_weight -= city_weights[city_id];
         } else {
             // Item.
             ItemId item_id = rows[row].second;
@@ -6,92 +6,54 @@
 
 #include "travellingthiefsolver/packing_while_travelling/algorithms/sequential_value_correction.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 using namespace travellingthiefsolver::packing_while_travelling;
+using namespace travellingthiefsolver::packing_while_travelling::efficient_local_search_internal;
 
 namespace
 {
 
 /**
- * Structure for a solution of the efficient local search algorithm.
+ * Update the prefix sums of the moments of the legs city_id_first to n.
  */
-struct EfficientLocalSearchSolution
-{
-    /** States of each city. */
-    std::vector<CityStateId> city_states;
-
-    /** Profit of the solution. */
-    Profit profit = 0;
-
-    /** Weight of the solution. */
-    Weight weight = 0;
-
-    /** Travel time of the solution. */
-    Time time = 0;
-
-    /** Cumulative weight for each city. */
-    std::vector<Weight> cumulative_weights;
-
-    /** Cumulative profit for each city. */
-    std::vector<Profit> cumulative_profits;
-
-    /** Cumulative time for each city. */
-    std::vector<Time> cumulative_times;
-
-    /** Objective value of the solution. */
-    Profit objective;
-};
-
-EfficientLocalSearchSolution init_solution(
+void update_time_moments(
         const Instance& instance,
-        const std::vector<std::vector<CityState>>& city_states,
-        const std::vector<CityStateId>& solution_city_states)
+        EfficientLocalSearchSolution& solution,
+        CityId city_id_first)
 {
-    EfficientLocalSearchSolution solution;
-    solution.city_states = solution_city_states;
-    CityStateId city_state_id = solution_city_states[0];
-    const CityState& city_state = city_states[0][city_state_id];
-    solution.profit = city_state.total_profit;
-    solution.weight = instance.city(0).weight + city_state.total_weight;
-    solution.cumulative_weights = std::vector<Weight> (instance.number_of_cities(), 0);
-    solution.cumulative_profits = std::vector<Profit>(instance.number_of_cities(), 0);
-    solution.cumulative_times = std::vector<Time>(instance.number_of_cities(), 0);
-    solution.time = 0;
-    for (CityId city_id = 1;
-            city_id < instance.number_of_cities();
-            ++city_id) {
-        CityStateId city_state_id = solution_city_states[city_id];
-        const CityState& city_state = city_states[city_id][city_state_id];
-        solution.time += instance.duration(city_id, solution.weight);
-        solution.weight += instance.city(city_id).weight
-            + city_state.total_weight;
-        solution.profit += city_state.total_profit;
-        solution.cumulative_weights[city_id] = solution.weight;
-        solution.cumulative_times[city_id] = solution.time;
+    CityId number_of_legs = instance.number_of_cities();
+    const std::vector<Distance>& city_distances = instance.city_distances();
+    for (CityId leg_id = city_id_first;
+            leg_id <= number_of_legs;
+            ++leg_id) {
+        Distance distance = city_distances[(leg_id < number_of_legs)? leg_id: 0];
+        double speed = instance.speed(solution.cumulative_weights[leg_id - 1]);
+        Time* moments_prev = &solution.time_moments[(leg_id - 1) * number_of_time_moments];
+        Time* moments = &solution.time_moments[leg_id * number_of_time_moments];
+        Time term = distance / speed;
+        for (Counter m = 0; m < number_of_time_moments; ++m) {
+            moments[m] = moments_prev[m] + term;
+            term /= speed;
+        }
     }
-    solution.time += instance.duration(0, solution.weight);
-    solution.objective = solution.profit
-        - instance.renting_ratio() * solution.time;
-    return solution;
 }
 
-Profit evaluate_move(
+/**
+ * Evaluate a move by walking back from the last city to the modified city.
+ *
+ * The walk stops as soon as the partial travel time proves that the move is
+ * not improving.
+ */
+Profit evaluate_move_walk(
         const Instance& instance,
-        const std::vector<std::vector<CityState>>& city_states,
         const EfficientLocalSearchSolution& solution,
         CityId city_id,
-        CityStateId city_state_id)
+        CityStateId city_state_id,
+        Profit profit_new,
+        Weight weight_diff)
 {
-    Profit profit_new = solution.profit
-        - city_states[city_id][solution.city_states[city_id]].total_profit
-        + city_states[city_id][city_state_id].total_profit;
-    Weight weight_new = solution.weight
-        - city_states[city_id][solution.city_states[city_id]].total_weight
-        + city_states[city_id][city_state_id].total_weight;
-    if (weight_new > instance.capacity())
-        return -std::numeric_limits<Profit>::infinity();
-    Weight weight_diff =
-        - city_states[city_id][solution.city_states[city_id]].total_weight
-        + city_states[city_id][city_state_id].total_weight;
     Time time_cur = 0;
 
     if (city_state_id > solution.city_states[city_id]) {
@@ -109,6 +71,7 @@ Profit evaluate_move(
         }
         time_cur += solution.cumulative_times[city_id];
     } else {
+        const std::vector<Distance>& city_distances_from_start = instance.city_distances_from_start();
         time_cur += instance.duration(0, solution.weight + weight_diff);
         for (CityId city_id_2 = instance.number_of_cities() - 1;
                 city_id_2 > city_id;
@@ -123,8 +86,8 @@ Profit evaluate_move(
                 * (solution.cumulative_times[city_id_2 - 1]
                         + time_cur
                         - unitary_spared_time
-                        * (instance.city(city_id_2 - 1).distance_from_start
-                            - instance.city(city_id).distance_from_start));
+                        * (city_distances_from_start[city_id_2 - 1]
+                            - city_distances_from_start[city_id]));
             if (bound < solution.objective)
                 return -std::numeric_limits<Profit>::infinity();
         }
@@ -134,9 +97,110 @@ Profit evaluate_move(
     return profit_new - instance.renting_ratio() * time_cur;
 }
 
-void apply_move(
+}
+
+EfficientLocalSearchSolution travellingthiefsolver::packing_while_travelling::efficient_local_search_internal::init_solution(
+        const Instance& instance,
+        const CityStateTable& city_states,
+        const std::vector<CityStateId>& solution_city_states)
+{
+    EfficientLocalSearchSolution solution;
+    solution.city_states = solution_city_states;
+    CityStateId city_state_id = solution_city_states[0];
+    CityStateTable::State city_state = city_states.state(0, city_state_id);
+    solution.profit = city_state.total_profit;
+    solution.weight = instance.city_weights()[0] + city_state.total_weight;
+    solution.cumulative_weights = std::vector<Weight> (instance.number_of_cities(), 0);
+    solution.cumulative_profits = std::vector<Profit>(instance.number_of_cities(), 0);
+    solution.cumulative_times = std::vector<Time>(instance.number_of_cities(), 0);
+    solution.cumulative_weights[0] = solution.weight;
+    solution.cumulative_profits[0] = solution.profit;
+    solution.time = 0;
+    const std::vector<Weight>& city_weights = instance.city_weights();
+    for (CityId city_id = 1;
+            city_id < instance.number_of_cities();
+            ++city_id) {
+        CityStateId city_state_id = solution_city_states[city_id];
+        CityStateTable::State city_state = city_states.state(city_id, city_state_id);
+        solution.time += instance.duration(city_id, solution.weight);
+        solution.weight += city_weights[city_id]
+            + city_state.total_weight;
+        solution.profit += city_state.total_profit;
+        solution.cumulative_weights[city_id] = solution.weight;
+        solution.cumulative_profits[city_id] = solution.profit;
+        solution.cumulative_times[city_id] = solution.time;
+    }
+    solution.time += instance.duration(0, solution.weight);
+    solution.objective = solution.profit
+        - instance.renting_ratio() * solution.time;
+    solution.time_moments = std::vector<Time>(
+            (instance.number_of_cities() + 1) * number_of_time_moments, 0);
+    update_time_moments(instance, solution, 1);
+    return solution;
+}
+
+Profit travellingthiefsolver::packing_while_travelling::efficient_local_search_internal::evaluate_move(
+        const Instance& instance,
+        const CityStateTable& city_states,
+        const EfficientLocalSearchSolution& solution,
+        CityId city_id,
+        CityStateId city_state_id)
+{
+    Weight weight_diff =
+        - city_states.total_weight(city_id, solution.city_states[city_id])
+        + city_states.total_weight(city_id, city_state_id);
+    Profit profit_new = solution.profit
+        - city_states.total_profit(city_id, solution.city_states[city_id])
+        + city_states.total_profit(city_id, city_state_id);
+    Weight weight_new = solution.weight + weight_diff;
+    if (weight_new > instance.capacity())
+        return -std::numeric_limits<Profit>::infinity();
+    if (weight_diff == 0)
+        return profit_new - instance.renting_ratio() * solution.time;
+
+    // Bound the travel time of the legs after city_id with the truncated
+    // expansion. Since the weights are non-decreasing along the tour, the
+    // smallest a_j of these legs is the speed of the last leg.
+    double nu = (instance.maximum_speed() - instance.minimum_speed())
+        / instance.capacity();
+    double x = nu * weight_diff;
+    double q = std::abs(x) / instance.speed(solution.weight);
+    if (q < 0.5) {
+        CityId number_of_legs = instance.number_of_cities();
+        const Time* moments_first = &solution.time_moments[city_id * number_of_time_moments];
+        const Time* moments_last = &solution.time_moments[number_of_legs * number_of_time_moments];
+        Time time_end = 0;
+        double x_power = 1;
+        for (Counter m = 0; m < number_of_time_moments; ++m) {
+            time_end += x_power * (moments_last[m] - moments_first[m]);
+            x_power *= x;
+        }
+        Time time_end_0 = moments_last[0] - moments_first[0];
+        Time error = time_end_0 * std::pow(q, number_of_time_moments) / (1 - q)
+            + 1e-9 * solution.time;
+        Time time_end_lb = (x > 0)? time_end - 1e-9 * solution.time: time_end - error;
+        Profit objective_ub = profit_new
+            - instance.renting_ratio()
+            * (solution.cumulative_times[city_id] + time_end_lb);
+        if (objective_ub <= solution.objective)
+            return -std::numeric_limits<Profit>::infinity();
+    }
+
+    // The bound only rejects moves. The value of a move which may improve is
+    // computed exactly since the best-improvement pass ranks moves by it.
+
+    return evaluate_move_walk(
+            instance,
+            solution,
+            city_id,
+            city_state_id,
+            profit_new,
+            weight_diff);
+}
+
+void travellingthiefsolver::packing_while_travelling::efficient_local_search_internal::apply_move(
         const Instance& instance,
-        const std::vector<std::vector<CityState>>& city_states,
+        const CityStateTable& city_states,
         EfficientLocalSearchSolution& solution,
         CityId city_id,
         CityStateId city_state_id)
@@ -145,9 +209,10 @@ void apply_move(
     solution.profit = solution.cumulative_profits[city_id - 1];
     solution.time = solution.cumulative_times[city_id];
 
-    solution.weight += instance.city(city_id).weight
-        + city_states[city_id][city_state_id].total_weight;
-    solution.profit += city_states[city_id][city_state_id].total_profit;
+    const std::vector<Weight>& city_weights = instance.city_weights();
+    solution.weight += city_weights[city_id]
+        + city_states.total_weight(city_id, city_state_id);
+    solution.profit += city_states.total_profit(city_id, city_state_id);
     solution.cumulative_weights[city_id] = solution.weight;
     solution.cumulative_profits[city_id] = solution.profit;
     solution.cumulative_times[city_id] = solution.time;
@@ -157,9 +222,9 @@ void apply_move(
             ++city_id_2) {
         CityStateId city_state_id = solution.city_states[city_id_2];
         solution.time += instance.duration(city_id_2, solution.weight);
-        solution.weight += instance.city(city_id_2).weight
-            + city_states[city_id_2][city_state_id].total_weight;
-        solution.profit += city_states[city_id_2][city_state_id].total_profit;
+        solution.weight += city_weights[city_id_2]
+            + city_states.total_weight(city_id_2, city_state_id);
+        solution.profit += city_states.total_profit(city_id_2, city_state_id);
         solution.cumulative_weights[city_id_2] = solution.weight;
         solution.cumulative_profits[city_id_2] = solution.profit;
         solution.cumulative_times[city_id_2] = solution.time;
@@ -167,11 +232,7 @@ void apply_move(
     solution.time += instance.duration(0, solution.weight);
     solution.objective = solution.profit
         - instance.renting_ratio() * solution.time;
-
-    //std::cout << "solution" << std::endl;
-    //std::cout << "profit " << profit_new << " " << solution.profit << std::endl;
-    //std::cout << "time " << time_cur << " " << solution.time << std::endl;
-    //std::cout << "objective " << objective_new << " " << solution.objective << std::endl;
+    update_time_moments(instance, solution, city_id + 1);
 
     //std::cout << "city_id " << city_id
     //    << " " << solution.city_states[city_id]
@@ -185,6 +246,162 @@ void apply_move(
     solution.city_states[city_id] = city_state_id;
 }
 
+namespace
+{
+
+/**
+ * Apply the first improving move found for each city, scanning the cities
+ * from the last one to the first one.
+ *
+ * Return the number of cities whose state has been modified.
+ */
+Counter first_improvement_pass(
+        const Instance& instance,
+        const CityStateTable& city_states,
+        EfficientLocalSearchSolution& solution)
+{
+    PROFILING_SCOPE("PwtEfficientLocalSearchPass");
+    Counter number_of_improvements = 0;
+    for (CityId city_id = instance.number_of_cities() - 1;
+            city_id > 0;
+            --city_id) {
+        bool city_improved = false;
+
+        for (CityStateId city_state_offset = 0;
+                city_state_offset < city_states.number_of_states(city_id);
+                ++city_state_offset) {
+            CityStateId city_state_id
+                = (solution.city_states[city_id] + city_state_offset)
+                % city_states.number_of_states(city_id);
+            if (city_state_id == solution.city_states[city_id])
+                continue;
+
+            Profit objective_new = evaluate_move(
+                    instance,
+                    city_states,
+                    solution,
+                    city_id,
+                    city_state_id);
+
+            if (solution.objective < objective_new) {
+                // Update current solution.
+                apply_move(
+                        instance,
+                        city_states,
+                        solution,
+                        city_id,
+                        city_state_id);
+
+                if (!city_improved) {
+                    city_improved = true;
+                    number_of_improvements++;
+                }
+            }
+        }
+    }
+    return number_of_improvements;
+}
+
+/**
+ * Structure for an improving move of the best-improvement pass.
+ */
+struct EfficientLocalSearchMove
+{
+    /** City. */
+    CityId city_id = -1;
+
+    /** New state of the city. */
+    CityStateId city_state_id = -1;
+
+    /** Objective of the solution after the move. */
+    Profit objective = -std::numeric_limits<Profit>::infinity();
+};
+
+/**
+ * Evaluate all the moves against the current solution and apply the best
+ * improving move of each city by decreasing gain.
+ *
+ * Moves of different cities interact through the weights carried on the
+ * following legs, so each move is re-evaluated against the updated solution
+ * before being applied.
+ *
+ * Return the number of cities whose state has been modified.
+ */
+Counter best_improvement_pass(
+        const Instance& instance,
+        const CityStateTable& city_states,
+        EfficientLocalSearchSolution& solution,
+        Counter number_of_threads)
+{
+    PROFILING_SCOPE("PwtEfficientLocalSearchPass");
+
+    // Evaluate the moves in parallel. The solution is not modified during this
+    // step and each city is processed by a single thread.
+    std::vector<EfficientLocalSearchMove> city_best_moves(instance.number_of_cities());
+    for_each_city(
+            1,
+            instance.number_of_cities(),
+            number_of_threads,
+            [&instance, &city_states, &solution, &city_best_moves](CityId city_id)
+            {
+                EfficientLocalSearchMove& move = city_best_moves[city_id];
+                for (CityStateId city_state_id = 0;
+                        city_state_id < city_states.number_of_states(city_id);
+                        ++city_state_id) {
+                    if (city_state_id == solution.city_states[city_id])
+                        continue;
+                    Profit objective_new = evaluate_move(
+                            instance,
+                            city_states,
+                            solution,
+                            city_id,
+                            city_state_id);
+                    if (solution.objective < objective_new
+                            && move.objective < objective_new) {
+                        move.city_id = city_id;
+                        move.city_state_id = city_state_id;
+                        move.objective = objective_new;
+                    }
+                }
+            });
+
+    // Sort the improving moves by decreasing gain.
+    std::vector<EfficientLocalSearchMove> moves;
+    for (const EfficientLocalSearchMove& move: city_best_moves)
+        if (move.city_id != -1)
+            moves.push_back(move);
+    std::sort(
+            moves.begin(),
+            moves.end(),
+            [](
+                const EfficientLocalSearchMove& move_1,
+                const EfficientLocalSearchMove& move_2) -> bool
+            {
+                return move_1.objective > move_2.objective;
+            });
+
+    // Apply the moves which are still improving.
+    Counter number_of_improvements = 0;
+    for (const EfficientLocalSearchMove& move: moves) {
+        Profit objective_new = evaluate_move(
+                instance,
+                city_states,
+                solution,
+                move.city_id,
+                move.city_state_id);
+        if (solution.objective < objective_new) {
+            apply_move(
+                    instance,
+                    city_states,
+                    solution,
+                    move.city_id,
+                    move.city_state_id);
+            number_of_improvements++;
+        }
+    }
+    return number_of_improvements;
+}
+
 Solution efficient_local_search_initial_solution(
         const Instance& instance,
         const EfficientLocalSearchParameters& parameters)
@@ -213,12 +430,22 @@ EfficientLocalSearchOutput travellingthiefsolver::packing_while_travelling::effi
     algorithm_formatter.print_header();
 
     // Reduction.
-    if (parameters.reduction_parameters.reduce)
-        return solve_reduced_instance(efficient_local_search, instance, parameters, algorithm_formatter, output);
+    if (parameters.reduction_parameters.reduce) {
+        // The city states of the instance don't match the reduced instance.
+        EfficientLocalSearchParameters reduced_parameters = parameters;
+        reduced_parameters.city_states = nullptr;
+        return solve_reduced_instance(efficient_local_search, instance, reduced_parameters, algorithm_formatter, output);
+    }
 
     Solution initial_solution = efficient_local_search_initial_solution(instance, parameters);
 
-    auto city_states = packing_while_travelling::compute_city_states<Instance>(instance);
+    CityStateTable computed_city_states;
+    if (parameters.city_states == nullptr)
+        computed_city_states = compute_city_state_table<Instance>(instance);
+    const CityStateTable& city_states
+        = (parameters.city_states != nullptr)?
+        *parameters.city_states:
+        computed_city_states;
 
     EfficientLocalSearchSolution solution = init_solution(
             instance,
@@ -232,46 +459,18 @@ EfficientLocalSearchOutput travellingthiefsolver::packing_while_travelling::effi
 
         //std::cout << "number_of_iterations " << output.number_of_iterations << std::endl;
 
-        Counter number_of_improvements = 0;
-        for (CityId city_id = instance.number_of_cities() - 1;
-                city_id > 0;
-                --city_id) {
-            //std::cout << "city_id " << city_id << std::endl;
-            bool city_improved = false;
-
-            for (CityStateId city_state_offset = 0;
-                    city_state_offset < (CityStateId)city_states[city_id].size();
-                    ++city_state_offset) {
-                CityStateId city_state_id
-                    = (solution.city_states[city_id] + city_state_offset)
-                    % (CityStateId)city_states[city_id].size();
-                if (city_state_id == solution.city_states[city_id])
-                    continue;
-
-                Profit objective_new = evaluate_move(
-                        instance,
-                        city_states,
-                        solution,
-                        city_id,
-                        city_state_id);
-
-                if (solution.objective < objective_new) {
-                    // Update current solution.
-                    apply_move(
-                            instance,
-                            city_states,
-                            solution,
-                            city_id,
-                            city_state_id);
-
-                    if (!city_improved) {
-                        city_improved = true;
-                        number_of_improvements++;
-                    }
-                }
-            }
+        Counter number_of_improvements = (!parameters.best_improvement)?
+            first_improvement_pass(
+                    instance,
+                    city_states,
+                    solution):
+            best_improvement_pass(
+                    instance,
+                    city_states,
+                    solution,
+                    parameters.number_of_threads);
 
-        }
+        PROFILING_COUNT("PwtEfficientLocalSearchImprovements", number_of_improvements);
 
         //std::cout << number_of_improvements << std::endl;
         //std::cout << solution_objective << std::endl;
@@ -294,7 +493,7 @@ EfficientLocalSearchOutput travellingthiefsolver::packing_while_travelling::effi
             city_id < instance.number_of_cities();
             ++city_id) {
         CityStateId city_state_id = solution.city_states[city_id];
-        for (ItemId item_id: city_states[city_id][city_state_id].item_ids)
+        for (ItemId item_id: city_states.item_ids(city_id, city_state_id))
             solution_builder.add_item(item_id);
     }
 
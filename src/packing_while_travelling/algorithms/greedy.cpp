@@ -21,24 +21,27 @@ Output travellingthiefsolver::packing_while_travelling::greedy(
     // Compute scores
     std::vector<double> scores(instance.number_of_items(), 0);
     double upsilon = (instance.maximum_speed() - instance.minimum_speed()) / instance.capacity();
+    const std::vector<Weight>& city_weights_from_start = instance.city_weights_from_start();
+    const std::vector<Distance>& city_distances_to_end = instance.city_distances_to_end();
     for (ItemId item_id = 0; item_id < instance.number_of_items(); ++item_id) {
         const Item& item = instance.item(item_id);
-        const City& city = instance.city(item.city_id);
+        Weight weight_from_start = city_weights_from_start[item.city_id];
+        Distance distance_to_end = city_distances_to_end[item.city_id];
         switch (parameters.scoring_function) {
         case 0: {
-            double speed_with = (instance.maximum_speed() - upsilon * (city.weight_from_start + item.weight));
-            double time_with = city.distance_to_end / speed_with;
+            double speed_with = (instance.maximum_speed() - upsilon * (weight_from_start + item.weight));
+            double time_with = distance_to_end / speed_with;
             Profit cost_with = instance.renting_ratio() * time_with;
             scores[item_id] = item.profit - cost_with;
             break;
         } case 1: {
-            scores[item_id] = item.profit / (item.weight * city.distance_to_end);
+            scores[item_id] = item.profit / (item.weight * distance_to_end);
             break;
         } case 2: {
-            double speed_without = (instance.maximum_speed() - upsilon * (city.weight_from_start));
-            double speed_with = (instance.maximum_speed() - upsilon * (city.weight_from_start + item.weight));
-            double time_without = city.distance_to_end / speed_without;
-            double time_with = city.distance_to_end / speed_with;
+            double speed_without = (instance.maximum_speed() - upsilon * (weight_from_start));
+            double speed_with = (instance.maximum_speed() - upsilon * (weight_from_start + item.weight));
+            double time_without = distance_to_end / speed_without;
+            double time_with = distance_to_end / speed_with;
             double cost_without = instance.renting_ratio() * time_without;
             double cost_with = instance.renting_ratio() * time_with;
             scores[item_id] = item.profit - cost_with + cost_without;
@@ -47,8 +50,8 @@ Output travellingthiefsolver::packing_while_travelling::greedy(
         } case 3: {
             double speed_without = (instance.maximum_speed() - upsilon * (instance.total_weight() - item.weight));
             double speed_with = (instance.maximum_speed() - upsilon * (instance.total_weight()));
-            double time_without = city.distance_to_end / speed_without;
-            double time_with = city.distance_to_end / speed_with;
+            double time_without = distance_to_end / speed_without;
+            double time_with = distance_to_end / speed_with;
             double cost_without = instance.renting_ratio() * time_without;
             double cost_with = instance.renting_ratio() * time_with;
             scores[item_id] = item.profit - cost_with + cost_without;
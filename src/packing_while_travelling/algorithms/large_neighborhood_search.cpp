@@ -85,10 +85,9 @@ LargeNeighborhoodSearchOutput travellingthiefsolver::packing_while_travelling::l
             for (CityId city_id = 0;
                     city_id < instance.number_of_cities();
                     ++city_id) {
-                const City& city = instance.city(city_id);
                 double p = d(generator);
                 if (p < 0.9) {
-                    for (ItemId item_id: city.item_ids) {
+                    for (ItemId item_id: instance.city_item_ids(city_id)) {
                         if (solution_cur.contains(item_id)) {
                             fixed_items.add(item_id);
                         } else {
@@ -104,10 +103,9 @@ LargeNeighborhoodSearchOutput travellingthiefsolver::packing_while_travelling::l
             for (CityId city_id = 0;
                     city_id < instance.number_of_cities();
                     ++city_id) {
-                const City& city = instance.city(city_id);
                 if (city_id < city_id_start
                         || city_id >= city_id_start + length) {
-                    for (ItemId item_id: city.item_ids) {
+                    for (ItemId item_id: instance.city_item_ids(city_id)) {
                         if (solution_cur.contains(item_id)) {
                             fixed_items.add(item_id);
                         } else {
@@ -128,10 +126,10 @@ LargeNeighborhoodSearchOutput travellingthiefsolver::packing_while_travelling::l
                 ++city_id) {
             new_instance_builder.set_distance(
                     city_id,
-                    instance.city(city_id).distance);
+                    instance.city_distances()[city_id]);
             new_instance_builder.add_weight(
                     city_id,
-                 instance.city(city_id).weight);
+                 instance.city_weights()[city_id]);
         }
         new_instance_builder.set_minimum_speed(instance.minimum_speed());
         new_instance_builder.set_maximum_speed(instance.maximum_speed());
@@ -8,25 +8,24 @@
 
 using namespace travellingthiefsolver::packing_while_travelling;
 
-namespace
-{
-
-Solution solve(
+Solution travellingthiefsolver::packing_while_travelling::sequential_value_correction_internal::solve(
         const Instance& instance,
         AlgorithmFormatter& algorithm_formatter,
         double alpha)
 {
+    PROFILING_SCOPE("SequentialValueCorrectionKnapsack");
+
     // Build knapsack instance.
     std::vector<ItemId> kp2pwt;
     knapsacksolver::knapsack::InstanceFromFloatProfitsBuilder kp_instance_builder;
+    const std::vector<Distance>& city_distances_to_end = instance.city_distances_to_end();
     for (ItemId item_id = 0;
             item_id < instance.number_of_items();
             ++item_id) {
         const Item& item = instance.item(item_id);
-        const City& city = instance.city(item.city_id);
 
         // Compute the profit of the item in the knapsack instance.
-        Profit profit = item.profit - alpha * item.weight * city.distance_to_end;
+        Profit profit = item.profit - alpha * item.weight * city_distances_to_end[item.city_id];
 
         // Skip items with negative profit.
         if (profit <= 0)
@@ -74,8 +73,6 @@ Solution solve(
     return solution;
 }
 
-}
-
 Output travellingthiefsolver::packing_while_travelling::sequential_value_correction(
         const Instance& instance,
         const SequentialValueCorrectionParameters& parameters)
@@ -92,15 +89,15 @@ Output travellingthiefsolver::packing_while_travelling::sequential_value_correct
     double alpha_min = 0;
 
     double alpha_max = 0;
+    const std::vector<Distance>& city_distances_to_end = instance.city_distances_to_end();
     for (ItemId item_id = 0; item_id < instance.number_of_items(); ++item_id) {
         const Item& item = instance.item(item_id);
-        const City& city = instance.city(item.city_id);
-        double a = item.profit / item.weight / city.distance_to_end;
+        double a = item.profit / item.weight / city_distances_to_end[item.city_id];
         alpha_max = std::max(alpha_max, a);
     }
 
-    Profit obj_min = solve(instance, algorithm_formatter, alpha_min).objective_value();
-    Profit obj_max = solve(instance, algorithm_formatter, alpha_max).objective_value();
+    Profit obj_min = sequential_value_correction_internal::solve(instance, algorithm_formatter, alpha_min).objective_value();
+    Profit obj_max = sequential_value_correction_internal::solve(instance, algorithm_formatter, alpha_max).objective_value();
 
     for (Counter number_of_iterations = 0;
             number_of_iterations < 64;
@@ -110,9 +107,9 @@ Output travellingthiefsolver::packing_while_travelling::sequential_value_correct
             break;
 
         double alpha_1 = 0.6666 * alpha_min + 0.3333 * alpha_max;
-        Profit obj_1 = solve(instance, algorithm_formatter, alpha_1).objective_value();
+        Profit obj_1 = sequential_value_correction_internal::solve(instance, algorithm_formatter, alpha_1).objective_value();
         double alpha_2 = 0.3333 * alpha_min + 0.6666 * alpha_max;
-        Profit obj_2 = solve(instance, algorithm_formatter, alpha_2).objective_value();
+        Profit obj_2 = sequential_value_correction_internal::solve(instance, algorithm_formatter, alpha_2).objective_value();
 
         if (alpha_1 <= alpha_min
                 || alpha_2 >= alpha_max
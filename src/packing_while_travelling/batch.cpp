@@ -0,0 +1,107 @@
+#include "travellingthiefsolver/packing_while_travelling/batch.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+using namespace travellingthiefsolver::packing_while_travelling;
+
+std::vector<nlohmann::json> travellingthiefsolver::packing_while_travelling::read_batch_manifest(
+        const std::string& manifest_path)
+{
+    std::ifstream file(manifest_path);
+    if (!file.good()) {
+        throw std::runtime_error(
+                "Unable to open file \"" + manifest_path + "\".");
+    }
+
+    std::vector<nlohmann::json> jobs;
+    std::string line;
+    int64_t line_number = 0;
+    while (getline(file, line)) {
+        line_number++;
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+        nlohmann::json job;
+        try {
+            job = nlohmann::json::parse(line);
+        } catch (const nlohmann::json::parse_error& e) {
+            throw std::invalid_argument(
+                    "Invalid JSON on line " + std::to_string(line_number)
+                    + " of file \"" + manifest_path + "\": " + e.what());
+        }
+        if (!job.is_object()) {
+            throw std::invalid_argument(
+                    "Line " + std::to_string(line_number)
+                    + " of file \"" + manifest_path + "\" is not a JSON object.");
+        }
+        jobs.push_back(std::move(job));
+    }
+    return jobs;
+}
+
+std::vector<std::string> travellingthiefsolver::packing_while_travelling::batch_job_arguments(
+        const nlohmann::json& job)
+{
+    std::vector<std::string> arguments;
+    for (auto it = job.begin(); it != job.end(); ++it) {
+        const nlohmann::json& value = it.value();
+        if (value.is_boolean()) {
+            if (value.get<bool>())
+                arguments.push_back("--" + it.key());
+        } else if (value.is_string()) {
+            arguments.push_back("--" + it.key());
+            arguments.push_back(value.get<std::string>());
+        } else if (value.is_number()) {
+            arguments.push_back("--" + it.key());
+            arguments.push_back(value.dump());
+        } else {
+            throw std::invalid_argument(
+                    "Invalid value for option \"" + it.key() + "\".");
+        }
+    }
+    return arguments;
+}
+
+void travellingthiefsolver::packing_while_travelling::run_batch(
+        const std::vector<nlohmann::json>& jobs,
+        int64_t number_of_threads,
+        std::ostream& os,
+        const std::function<nlohmann::json(const nlohmann::json&)>& run_job)
+{
+    std::atomic<int64_t> next_job_id(0);
+    std::mutex output_mutex;
+
+    auto worker = [&jobs, &next_job_id, &output_mutex, &os, &run_job]()
+    {
+        for (;;) {
+            int64_t job_id = next_job_id.fetch_add(1);
+            if (job_id >= (int64_t)jobs.size())
+                break;
+            nlohmann::json result;
+            try {
+                result = run_job(jobs[job_id]);
+            } catch (const std::exception& e) {
+                result = nlohmann::json{{"Error", e.what()}};
+            }
+            result["Id"] = job_id;
+            std::string line = result.dump();
+            std::lock_guard<std::mutex> lock(output_mutex);
+            os << line << std::endl;
+        }
+    };
+
+    if (number_of_threads <= 1) {
+        worker();
+        return;
+    }
+    std::vector<std::thread> threads;
+    for (int64_t thread_id = 0;
+            thread_id < number_of_threads;
+            ++thread_id) {
+        threads.push_back(std::thread(worker));
+    }
+    for (std::thread& thread: threads)
+        thread.join();
+}
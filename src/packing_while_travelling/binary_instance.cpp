@@ -0,0 +1,310 @@
+#include "travellingthiefsolver/packing_while_travelling/binary_instance.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+using namespace travellingthiefsolver::packing_while_travelling;
+
+namespace
+{
+
+/** Magic string at the start of the binary instance files. */
+const char binary_instance_magic[8] = {'T', 'T', 'S', 'B', 'I', 'N', 'S', 'T'};
+
+/** Byte order mark, to detect files written on a machine of other endianness. */
+const uint32_t binary_instance_byte_order_mark = 0x01020304;
+
+/** Number of arrays of a binary instance file. */
+const int number_of_arrays = 10;
+
+}
+
+struct travellingthiefsolver::packing_while_travelling::BinaryInstanceFile::Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order_mark;
+    uint32_t problem;
+    uint32_t reserved;
+    int64_t number_of_cities;
+    int64_t number_of_items;
+    int64_t capacity;
+    double minimum_speed;
+    double maximum_speed;
+    double renting_ratio;
+    double time_limit;
+    char edge_weight_type[32];
+
+    /** Offsets of the arrays from the start of the file; 0 if absent. */
+    uint64_t offsets[number_of_arrays];
+
+    /** Number of elements of the arrays. */
+    uint64_t sizes[number_of_arrays];
+};
+
+static_assert(
+        sizeof(BinaryInstanceFile::Header) % 8 == 0,
+        "The arrays following the header must be aligned on 8 bytes.");
+
+void travellingthiefsolver::packing_while_travelling::write_binary_instance(
+        const std::string& instance_path,
+        const BinaryInstanceData& data)
+{
+    CityId number_of_cities = data.number_of_cities;
+    ItemId number_of_items = data.item_city_ids.size();
+
+    // Check the data.
+    if (data.item_weights.size() != (std::size_t)number_of_items
+            || data.item_profits.size() != (std::size_t)number_of_items) {
+        throw std::invalid_argument(
+                "The item arrays must have the same size.");
+    }
+    if (data.coordinates != nullptr
+            && (data.coordinates->xs.size() != (std::size_t)number_of_cities
+                || data.coordinates->ys.size() != (std::size_t)number_of_cities)) {
+        throw std::invalid_argument(
+                "The coordinate arrays must have one element per city.");
+    }
+    if (data.coordinates != nullptr
+            && data.coordinates->edge_weight_type.size() >= 32) {
+        throw std::invalid_argument(
+                "Edge weight type \"" + data.coordinates->edge_weight_type
+                + "\" is too long.");
+    }
+    if (!data.distance_matrix.empty()
+            && data.distance_matrix.size()
+            != (std::size_t)(number_of_cities * number_of_cities)) {
+        throw std::invalid_argument(
+                "The distance matrix must have one element per pair of cities.");
+    }
+    if ((!data.city_distances.empty()
+                && data.city_distances.size() != (std::size_t)number_of_cities)
+            || (!data.city_weights.empty()
+                && data.city_weights.size() != (std::size_t)number_of_cities)) {
+        throw std::invalid_argument(
+                "The city arrays must have one element per city.");
+    }
+
+    // Compute the CSR index of the items of the cities.
+    std::vector<ItemId> city_item_offsets(number_of_cities + 1, 0);
+    for (CityId city_id: data.item_city_ids) {
+        if (city_id < 0 || city_id >= number_of_cities) {
+            throw std::invalid_argument(
+                    "Invalid city " + std::to_string(city_id) + ".");
+        }
+        city_item_offsets[city_id + 1]++;
+    }
+    for (CityId city_id = 0; city_id < number_of_cities; ++city_id)
+        city_item_offsets[city_id + 1] += city_item_offsets[city_id];
+    std::vector<ItemId> city_item_ids(number_of_items);
+    std::vector<ItemId> city_item_pos(
+            city_item_offsets.begin(),
+            city_item_offsets.end() - 1);
+    for (ItemId item_id = 0; item_id < number_of_items; ++item_id)
+        city_item_ids[city_item_pos[data.item_city_ids[item_id]]++] = item_id;
+
+    // Arrays, in the order of their indices in the header.
+    const std::vector<double> empty;
+    const std::vector<double>& xs = (data.coordinates != nullptr)? data.coordinates->xs: empty;
+    const std::vector<double>& ys = (data.coordinates != nullptr)? data.coordinates->ys: empty;
+    const void* arrays[number_of_arrays] = {
+        xs.data(),
+        ys.data(),
+        data.distance_matrix.data(),
+        data.city_distances.data(),
+        data.city_weights.data(),
+        data.item_city_ids.data(),
+        data.item_weights.data(),
+        data.item_profits.data(),
+        city_item_offsets.data(),
+        city_item_ids.data(),
+    };
+    uint64_t sizes[number_of_arrays] = {
+        xs.size(),
+        ys.size(),
+        (data.coordinates != nullptr)? 0: data.distance_matrix.size(),
+        data.city_distances.size(),
+        data.city_weights.size(),
+        data.item_city_ids.size(),
+        data.item_weights.size(),
+        data.item_profits.size(),
+        city_item_offsets.size(),
+        city_item_ids.size(),
+    };
+
+    // Fill the header.
+    BinaryInstanceFile::Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, binary_instance_magic, sizeof(header.magic));
+    header.version = binary_instance_version;
+    header.byte_order_mark = binary_instance_byte_order_mark;
+    header.problem = (uint32_t)data.problem;
+    header.number_of_cities = number_of_cities;
+    header.number_of_items = number_of_items;
+    header.capacity = data.capacity;
+    header.minimum_speed = data.minimum_speed;
+    header.maximum_speed = data.maximum_speed;
+    header.renting_ratio = data.renting_ratio;
+    header.time_limit = data.time_limit;
+    if (data.coordinates != nullptr) {
+        std::memcpy(
+                header.edge_weight_type,
+                data.coordinates->edge_weight_type.data(),
+                data.coordinates->edge_weight_type.size());
+    }
+    // All the elements have 8 bytes, so the arrays stay aligned.
+    uint64_t offset = sizeof(header);
+    for (int array_id = 0; array_id < number_of_arrays; ++array_id) {
+        header.sizes[array_id] = sizes[array_id];
+        if (sizes[array_id] == 0)
+            continue;
+        header.offsets[array_id] = offset;
+        offset += 8 * sizes[array_id];
+    }
+
+    // Write the file.
+    std::ofstream file(instance_path, std::ios::binary);
+    if (!file.good()) {
+        throw std::runtime_error(
+                "Unable to open file \"" + instance_path + "\".");
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (int array_id = 0; array_id < number_of_arrays; ++array_id) {
+        file.write(
+                reinterpret_cast<const char*>(arrays[array_id]),
+                8 * sizes[array_id]);
+    }
+    if (!file.good()) {
+        throw std::runtime_error(
+                "Unable to write file \"" + instance_path + "\".");
+    }
+}
+
+BinaryInstanceFile::BinaryInstanceFile(const std::string& instance_path):
+    mapped_file_(instance_path)
+{
+    if (mapped_file_.size() < sizeof(Header)
+            || std::memcmp(mapped_file_.begin(), binary_instance_magic, 8) != 0) {
+        throw std::invalid_argument(
+                "File \"" + instance_path + "\" is not a binary instance file.");
+    }
+    header_ = reinterpret_cast<const Header*>(mapped_file_.begin());
+    if (header_->byte_order_mark != binary_instance_byte_order_mark) {
+        throw std::invalid_argument(
+                "File \"" + instance_path + "\" has been written on a machine"
+                " with a different byte order.");
+    }
+    if (header_->version == 0 || header_->version > binary_instance_version) {
+        throw std::invalid_argument(
+                "Unsupported version " + std::to_string(header_->version)
+                + " of binary instance file \"" + instance_path + "\".");
+    }
+    offsets_ = header_->offsets;
+
+    // Check the numbers of cities and items before computing the sizes of
+    // the arrays from them. The CSR offsets of the items of the cities and,
+    // if there are items, the item arrays are mandatory, so each of these
+    // numbers is bounded by the number of 8-byte elements of the file.
+    uint64_t file_size = mapped_file_.size();
+    if (header_->number_of_cities < 0
+            || header_->number_of_items < 0
+            || (uint64_t)header_->number_of_cities >= file_size / 8
+            || (uint64_t)header_->number_of_items > file_size / 8) {
+        throw std::invalid_argument(
+                "Corrupted binary instance file \"" + instance_path + "\".");
+    }
+
+    // Check the arrays.
+    uint64_t n = header_->number_of_cities;
+    uint64_t m = header_->number_of_items;
+    // An explicit distance matrix of more than 2^32 rows can't fit in a
+    // file; its expected size is then set to a value no size can match.
+    uint64_t n2 = (n <= std::numeric_limits<uint32_t>::max())?
+        n * n: std::numeric_limits<uint64_t>::max();
+    uint64_t expected_sizes[number_of_arrays] = {n, n, n2, n, n, m, m, m, n + 1, m};
+    for (int array_id = 0; array_id < number_of_arrays; ++array_id) {
+        uint64_t offset = header_->offsets[array_id];
+        uint64_t size = header_->sizes[array_id];
+        if (offset == 0)
+            continue;
+        if (size != expected_sizes[array_id]
+                || offset % 8 != 0
+                || offset < sizeof(Header)
+                || offset > file_size
+                || size > (file_size - offset) / 8) {
+            throw std::invalid_argument(
+                    "Corrupted binary instance file \"" + instance_path + "\".");
+        }
+    }
+    bool items = (m == 0)
+        || (offsets_[5] != 0 && offsets_[6] != 0 && offsets_[7] != 0 && offsets_[9] != 0);
+    if (offsets_[8] == 0 || !items) {
+        throw std::invalid_argument(
+                "Corrupted binary instance file \"" + instance_path + "\".");
+    }
+
+    // Check the items of the cities, so that the readers can index the
+    // arrays without further checks. The m positions list each item at most
+    // once, so every item is listed under the city of its item_city_ids
+    // entry.
+    const ItemId* city_item_offsets = this->city_item_offsets();
+    std::vector<bool> item_listed(m, false);
+    bool ok = (city_item_offsets[0] == 0 && city_item_offsets[n] == (ItemId)m);
+    for (uint64_t city_id = 0; ok && city_id < n; ++city_id) {
+        ok = (city_item_offsets[city_id] <= city_item_offsets[city_id + 1]
+                && city_item_offsets[city_id + 1] <= (ItemId)m);
+        for (ItemId pos = city_item_offsets[city_id];
+                ok && pos < city_item_offsets[city_id + 1];
+                ++pos) {
+            ItemId item_id = city_item_ids()[pos];
+            ok = (item_id >= 0
+                    && item_id < (ItemId)m
+                    && !item_listed[item_id]
+                    && item_city_ids()[item_id] == (CityId)city_id);
+            if (ok)
+                item_listed[item_id] = true;
+        }
+    }
+    if (!ok) {
+        throw std::invalid_argument(
+                "Corrupted binary instance file \"" + instance_path + "\".");
+    }
+}
+
+BinaryInstanceProblem BinaryInstanceFile::problem() const { return (BinaryInstanceProblem)header_->problem; }
+
+CityId BinaryInstanceFile::number_of_cities() const { return header_->number_of_cities; }
+
+ItemId BinaryInstanceFile::number_of_items() const { return header_->number_of_items; }
+
+Weight BinaryInstanceFile::capacity() const { return header_->capacity; }
+
+double BinaryInstanceFile::minimum_speed() const { return header_->minimum_speed; }
+
+double BinaryInstanceFile::maximum_speed() const { return header_->maximum_speed; }
+
+double BinaryInstanceFile::renting_ratio() const { return header_->renting_ratio; }
+
+Time BinaryInstanceFile::time_limit() const { return header_->time_limit; }
+
+std::string BinaryInstanceFile::edge_weight_type() const
+{
+    const char* begin = header_->edge_weight_type;
+    const char* end = begin + sizeof(header_->edge_weight_type);
+    return std::string(begin, std::find(begin, end, '\0'));
+}
+
+std::shared_ptr<const CityCoordinates> BinaryInstanceFile::coordinates() const
+{
+    if (xs() == nullptr || ys() == nullptr)
+        return nullptr;
+    auto coordinates = std::make_shared<CityCoordinates>();
+    coordinates->edge_weight_type = edge_weight_type();
+    coordinates->xs.assign(xs(), xs() + number_of_cities());
+    coordinates->ys.assign(ys(), ys() + number_of_cities());
+    return coordinates;
+}
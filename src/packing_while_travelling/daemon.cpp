@@ -0,0 +1,303 @@
+#include "travellingthiefsolver/packing_while_travelling/daemon.hpp"
+
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace travellingthiefsolver::packing_while_travelling;
+
+#ifndef _WIN32
+
+namespace
+{
+
+/**
+ * Time given to a client to read a response, in milliseconds; the
+ * connection is closed if it doesn't.
+ */
+const int write_timeout = 10000;
+
+/**
+ * Connection of a client.
+ */
+struct Connection
+{
+    /** Bytes of the message being received. */
+    std::string buffer;
+
+    /** 'true' iff the client has closed its side of the connection. */
+    bool closed = false;
+};
+
+/**
+ * Compute the number of bytes still to receive for the message being
+ * received; 0 if it is complete.
+ *
+ * Return -1 if the length of the message is invalid.
+ */
+int64_t compute_number_of_missing_bytes(const std::string& buffer)
+{
+    if (buffer.size() < 4)
+        return 4 - buffer.size();
+    uint32_t length
+        = ((uint32_t)(unsigned char)buffer[0] << 24)
+        | ((uint32_t)(unsigned char)buffer[1] << 16)
+        | ((uint32_t)(unsigned char)buffer[2] << 8)
+        | ((uint32_t)(unsigned char)buffer[3]);
+    if (length > daemon_maximum_message_length)
+        return -1;
+    return (int64_t)4 + length - buffer.size();
+}
+
+/**
+ * Read the available bytes of the message being received on a connection,
+ * without blocking.
+ *
+ * The bytes following the message are left in the socket, so that the
+ * buffer never holds more than one message.
+ *
+ * Return 'false' if an error occurred.
+ */
+bool read_available_bytes(
+        int fd,
+        Connection& connection)
+{
+    char buffer[1 << 16];
+    for (;;) {
+        int64_t size = compute_number_of_missing_bytes(connection.buffer);
+        if (size <= 0)
+            return true;
+        ssize_t n = read(fd, buffer, (std::min)(size, (int64_t)sizeof(buffer)));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return true;
+        if (n < 0)
+            return false;
+        if (n == 0) {
+            connection.closed = true;
+            return true;
+        }
+        connection.buffer.append(buffer, n);
+    }
+}
+
+/**
+ * Write 'size' bytes to a connection.
+ *
+ * Return 'false' if the connection has been closed or if the client hasn't
+ * read them in time.
+ */
+bool write_bytes(
+        int fd,
+        const char* buffer,
+        size_t size)
+{
+    // Don't get killed by SIGPIPE if the client has gone away; on macOS,
+    // this is done with the SO_NOSIGPIPE option of the socket instead.
+    int flags = 0;
+#ifdef MSG_NOSIGNAL
+    flags = MSG_NOSIGNAL;
+#endif
+    while (size > 0) {
+        ssize_t n = send(fd, buffer, size, flags);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // The socket is non-blocking; wait until the client has read
+            // enough of the response.
+            struct pollfd pfd = {fd, POLLOUT, 0};
+            int r = poll(&pfd, 1, write_timeout);
+            if (r < 0 && errno == EINTR)
+                continue;
+            if (r <= 0)
+                return false;
+            continue;
+        }
+        if (n <= 0)
+            return false;
+        buffer += n;
+        size -= n;
+    }
+    return true;
+}
+
+/**
+ * Write a message to a connection.
+ *
+ * Return 'false' if the connection has been closed.
+ */
+bool write_message(
+        int fd,
+        const nlohmann::json& json)
+{
+    std::string message = json.dump();
+    if (message.size() > daemon_maximum_message_length) {
+        message = nlohmann::json{
+            {"Error", "The response is too long."}}.dump();
+    }
+    uint32_t length = message.size();
+    unsigned char header[4] = {
+        (unsigned char)(length >> 24),
+        (unsigned char)(length >> 16),
+        (unsigned char)(length >> 8),
+        (unsigned char)(length)};
+    return write_bytes(fd, reinterpret_cast<const char*>(header), 4)
+        && write_bytes(fd, message.data(), message.size());
+}
+
+}
+
+#endif
+
+void travellingthiefsolver::packing_while_travelling::run_daemon(
+        const std::string& socket_path,
+        const std::function<nlohmann::json(const nlohmann::json&)>& handle_request)
+{
+#ifdef _WIN32
+    (void)socket_path;
+    (void)handle_request;
+    throw std::runtime_error(
+            "The daemon mode is not available on Windows.");
+#else
+    struct sockaddr_un address;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument(
+                "Socket path \"" + socket_path + "\" is too long.");
+    }
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        throw std::runtime_error(
+                "Unable to create socket \"" + socket_path + "\".");
+    }
+    // Remove the socket file left by a previous daemon, but never replace
+    // another kind of file.
+    struct stat status;
+    if (lstat(socket_path.c_str(), &status) == 0) {
+        if (!S_ISSOCK(status.st_mode)) {
+            close(listen_fd);
+            throw std::runtime_error(
+                    "File \"" + socket_path + "\" exists and is not a socket.");
+        }
+        unlink(socket_path.c_str());
+    }
+    if (bind(listen_fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0
+            || listen(listen_fd, 16) < 0) {
+        close(listen_fd);
+        throw std::runtime_error(
+                "Unable to listen on socket \"" + socket_path + "\".");
+    }
+
+    // The first entry is the listening socket, the others are the
+    // connections.
+    std::vector<struct pollfd> fds = {{listen_fd, POLLIN, 0}};
+    std::vector<Connection> connections(1);
+    bool shutdown = false;
+    while (!shutdown) {
+        for (struct pollfd& pfd: fds)
+            pfd.revents = 0;
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        // Process one request of each ready connection, so that a client
+        // sending many requests doesn't delay the others. The sockets are
+        // non-blocking, so a client sending a message slowly, or only part
+        // of it, doesn't delay the others either.
+        for (size_t pos = 1; pos < fds.size() && !shutdown; ++pos) {
+            if (!(fds[pos].revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+            // Close the connection on errors, on invalid lengths, and if the
+            // client has closed it before the end of a message.
+            Connection& connection = connections[pos];
+            bool ok = read_available_bytes(fds[pos].fd, connection);
+            int64_t number_of_missing_bytes = compute_number_of_missing_bytes(connection.buffer);
+            if (!ok
+                    || number_of_missing_bytes < 0
+                    || (number_of_missing_bytes > 0 && connection.closed)) {
+                close(fds[pos].fd);
+                fds[pos].fd = -1;
+                continue;
+            }
+            if (number_of_missing_bytes > 0)
+                continue;
+            std::string message = connection.buffer.substr(4);
+            connection.buffer.clear();
+
+            nlohmann::json response;
+            try {
+                nlohmann::json request = nlohmann::json::parse(message);
+                if (!request.is_object()) {
+                    throw std::invalid_argument(
+                            "The request is not a JSON object.");
+                }
+                if (request.value("command", "") == "shutdown") {
+                    shutdown = true;
+                    response = {{"Shutdown", true}};
+                } else {
+                    response = handle_request(request);
+                }
+            } catch (const std::exception& e) {
+                response = {{"Error", e.what()}};
+            }
+
+            if (!write_message(fds[pos].fd, response)) {
+                close(fds[pos].fd);
+                fds[pos].fd = -1;
+            }
+        }
+
+        // Accept the new connection.
+        if (!shutdown && (fds[0].revents & POLLIN)) {
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd >= 0) {
+#ifdef SO_NOSIGPIPE
+                int one = 1;
+                setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                fds.push_back({fd, POLLIN, 0});
+                connections.push_back(Connection());
+            }
+        }
+
+        // Remove the closed connections.
+        size_t number_of_fds = 1;
+        for (size_t pos = 1; pos < fds.size(); ++pos) {
+            if (fds[pos].fd < 0)
+                continue;
+            if (number_of_fds != pos) {
+                fds[number_of_fds] = fds[pos];
+                connections[number_of_fds] = std::move(connections[pos]);
+            }
+            number_of_fds++;
+        }
+        fds.resize(number_of_fds);
+        connections.resize(number_of_fds);
+    }
+
+    for (size_t pos = 1; pos < fds.size(); ++pos)
+        close(fds[pos].fd);
+    close(listen_fd);
+    unlink(socket_path.c_str());
+#endif
+}
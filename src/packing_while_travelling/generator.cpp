@@ -0,0 +1,324 @@
+#include "travellingthiefsolver/packing_while_travelling/generator.hpp"
+
+#include "travellingthiefsolver/packing_while_travelling/instance_builder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+using namespace travellingthiefsolver::packing_while_travelling;
+
+int64_t GeneratorRandom::integer(
+        int64_t minimum,
+        int64_t maximum)
+{
+    uint64_t range = (uint64_t)(maximum - minimum) + 1;
+    if (range == 0)
+        return (int64_t)generator_();
+    // Reject the first '2^64 mod range' values so that the result is unbiased.
+    uint64_t threshold = (0 - range) % range;
+    for (;;) {
+        uint64_t r = generator_();
+        if (r >= threshold)
+            return minimum + (int64_t)(r % range);
+    }
+}
+
+double GeneratorRandom::real()
+{
+    return (double)(generator_() >> 11) / 9007199254740992.0;
+}
+
+double GeneratorRandom::normal()
+{
+    double sum = 0;
+    for (int i = 0; i < 12; ++i)
+        sum += real();
+    return sum - 6;
+}
+
+Distance travellingthiefsolver::packing_while_travelling::generator_distance(
+        const CityCoordinates& coordinates,
+        CityId city_id_1,
+        CityId city_id_2)
+{
+    double dx = coordinates.xs[city_id_1] - coordinates.xs[city_id_2];
+    double dy = coordinates.ys[city_id_1] - coordinates.ys[city_id_2];
+    return (Distance)std::ceil(std::sqrt(dx * dx + dy * dy));
+}
+
+namespace
+{
+
+/**
+ * Generate the coordinates of the cities.
+ *
+ * The coordinates are integers, so that the distances only depend on the
+ * correctly rounded square root.
+ */
+void generate_coordinates(
+        const GeneratorParameters& parameters,
+        GeneratorRandom& random,
+        CityCoordinates& coordinates)
+{
+    CityId number_of_cities = parameters.number_of_cities;
+    coordinates.edge_weight_type = "CEIL_2D";
+    coordinates.xs.resize(number_of_cities);
+    coordinates.ys.resize(number_of_cities);
+
+    if (parameters.coordinates_distribution == CoordinatesDistribution::Uniform) {
+        for (CityId city_id = 0;
+                city_id < number_of_cities;
+                ++city_id) {
+            coordinates.xs[city_id] = random.integer(0, generator_square_side);
+            coordinates.ys[city_id] = random.integer(0, generator_square_side);
+        }
+
+    } else if (parameters.coordinates_distribution == CoordinatesDistribution::Clustered) {
+        CityId number_of_centers = std::max((CityId)1, number_of_cities / 10);
+        std::vector<int64_t> center_xs(number_of_centers);
+        std::vector<int64_t> center_ys(number_of_centers);
+        for (CityId center_id = 0;
+                center_id < number_of_centers;
+                ++center_id) {
+            center_xs[center_id] = random.integer(0, generator_square_side);
+            center_ys[center_id] = random.integer(0, generator_square_side);
+        }
+        double standard_deviation = generator_square_side / std::sqrt((double)number_of_cities);
+        for (CityId city_id = 0;
+                city_id < number_of_cities;
+                ++city_id) {
+            CityId center_id = random.integer(0, number_of_centers - 1);
+            double x = center_xs[center_id] + standard_deviation * random.normal();
+            double y = center_ys[center_id] + standard_deviation * random.normal();
+            coordinates.xs[city_id] = std::min(
+                    (double)generator_square_side,
+                    std::max(0.0, std::round(x)));
+            coordinates.ys[city_id] = std::min(
+                    (double)generator_square_side,
+                    std::max(0.0, std::round(y)));
+        }
+
+    } else if (parameters.coordinates_distribution == CoordinatesDistribution::TsplibLike) {
+        // Grid with about twice as many nodes as cities.
+        int64_t grid_size = 1;
+        while (grid_size * grid_size < 2 * number_of_cities)
+            grid_size++;
+        int64_t spacing = generator_square_side / grid_size;
+        // Draw distinct nodes with a partial Fisher-Yates shuffle.
+        std::vector<int64_t> nodes(grid_size * grid_size);
+        std::iota(nodes.begin(), nodes.end(), 0);
+        for (CityId city_id = 0;
+                city_id < number_of_cities;
+                ++city_id) {
+            int64_t pos = random.integer(city_id, nodes.size() - 1);
+            std::swap(nodes[city_id], nodes[pos]);
+            coordinates.xs[city_id] = (nodes[city_id] % grid_size) * spacing;
+            coordinates.ys[city_id] = (nodes[city_id] / grid_size) * spacing;
+        }
+    }
+}
+
+/**
+ * Generate the items and the capacity of the knapsack.
+ */
+void generate_items(
+        const GeneratorParameters& parameters,
+        GeneratorRandom& random,
+        GeneratedData& data)
+{
+    ItemId number_of_items = (parameters.number_of_cities - 1)
+        * parameters.number_of_items_per_city;
+    data.item_city_ids.reserve(number_of_items);
+    data.item_weights.reserve(number_of_items);
+    data.item_profits.reserve(number_of_items);
+    Weight total_weight = 0;
+    for (CityId city_id = 1;
+            city_id < parameters.number_of_cities;
+            ++city_id) {
+        for (ItemId pos = 0;
+                pos < parameters.number_of_items_per_city;
+                ++pos) {
+            Weight weight = 0;
+            Profit profit = 0;
+            if (parameters.items_correlation == ItemsCorrelation::Uncorrelated) {
+                weight = random.integer(1, 1000);
+                profit = random.integer(1, 1000);
+            } else if (parameters.items_correlation == ItemsCorrelation::BoundedStronglyCorrelated) {
+                weight = random.integer(1, 1000);
+                profit = weight + 100;
+            } else if (parameters.items_correlation == ItemsCorrelation::UncorrelatedSimilarWeights) {
+                weight = random.integer(1000, 1010);
+                profit = random.integer(1, 1000);
+            }
+            data.item_city_ids.push_back(city_id);
+            data.item_weights.push_back(weight);
+            data.item_profits.push_back(profit);
+            total_weight += weight;
+        }
+    }
+    data.capacity = std::max(
+            (Weight)1,
+            parameters.capacity_category * total_weight / 11);
+}
+
+/**
+ * Compute the reference tour.
+ */
+void compute_tour(GeneratedData& data)
+{
+    const CityCoordinates& coordinates = *data.coordinates;
+    CityId number_of_cities = coordinates.xs.size();
+    int64_t number_of_strips = 1;
+    while (3 * number_of_strips * number_of_strips < number_of_cities)
+        number_of_strips++;
+
+    std::vector<int64_t> strips(number_of_cities);
+    for (CityId city_id = 0;
+            city_id < number_of_cities;
+            ++city_id) {
+        strips[city_id] = (int64_t)coordinates.xs[city_id]
+            * number_of_strips / (generator_square_side + 1);
+    }
+    data.tour.resize(number_of_cities);
+    std::iota(data.tour.begin(), data.tour.end(), 0);
+    std::sort(
+            data.tour.begin(),
+            data.tour.end(),
+            [&coordinates, &strips](
+                CityId city_id_1,
+                CityId city_id_2) -> bool
+            {
+                if (strips[city_id_1] != strips[city_id_2])
+                    return strips[city_id_1] < strips[city_id_2];
+                double y1 = coordinates.ys[city_id_1];
+                double y2 = coordinates.ys[city_id_2];
+                if (y1 != y2)
+                    return (strips[city_id_1] % 2 == 0)? (y1 < y2): (y1 > y2);
+                return city_id_1 < city_id_2;
+            });
+    std::rotate(
+            data.tour.begin(),
+            std::find(data.tour.begin(), data.tour.end(), 0),
+            data.tour.end());
+
+    data.tour_length = 0;
+    for (CityPos city_pos = 0;
+            city_pos < number_of_cities;
+            ++city_pos) {
+        data.tour_length += generator_distance(
+                coordinates,
+                data.tour[city_pos],
+                data.tour[(city_pos + 1) % number_of_cities]);
+    }
+}
+
+/**
+ * Compute the greedy solution of the knapsack problem, which selects the
+ * items by non-increasing profit-to-weight ratio while they fit.
+ */
+void compute_knapsack_solution(GeneratedData& data)
+{
+    ItemId number_of_items = data.item_weights.size();
+    std::vector<ItemId> sorted_item_ids(number_of_items);
+    std::iota(sorted_item_ids.begin(), sorted_item_ids.end(), 0);
+    std::sort(
+            sorted_item_ids.begin(),
+            sorted_item_ids.end(),
+            [&data](
+                ItemId item_id_1,
+                ItemId item_id_2) -> bool
+            {
+                // Profits and weights are small integers, so the products
+                // are exact.
+                double v1 = data.item_profits[item_id_1] * data.item_weights[item_id_2];
+                double v2 = data.item_profits[item_id_2] * data.item_weights[item_id_1];
+                if (v1 != v2)
+                    return v1 > v2;
+                return item_id_1 < item_id_2;
+            });
+
+    data.knapsack_items = std::vector<uint8_t>(number_of_items, 0);
+    data.knapsack_profit = 0;
+    Weight weight = 0;
+    for (ItemId item_id: sorted_item_ids) {
+        if (weight + data.item_weights[item_id] > data.capacity)
+            continue;
+        data.knapsack_items[item_id] = 1;
+        data.knapsack_profit += data.item_profits[item_id];
+        weight += data.item_weights[item_id];
+    }
+}
+
+}
+
+GeneratedData travellingthiefsolver::packing_while_travelling::generate_data(
+        const GeneratorParameters& parameters)
+{
+    if (parameters.number_of_cities < 2) {
+        throw std::invalid_argument(
+                "The number of cities of a generated instance must be at least 2.");
+    }
+    if (parameters.capacity_category < 1
+            || parameters.capacity_category > 10) {
+        throw std::invalid_argument(
+                "The capacity category of a generated instance must be between 1 and 10.");
+    }
+
+    GeneratorRandom random(parameters.seed);
+    GeneratedData data;
+    data.coordinates = std::make_shared<CityCoordinates>();
+    generate_coordinates(parameters, random, *data.coordinates);
+    generate_items(parameters, random, data);
+    compute_tour(data);
+    compute_knapsack_solution(data);
+
+    Time tour_time = (double)data.tour_length / parameters.maximum_speed;
+    data.renting_ratio = (tour_time > 0)? data.knapsack_profit / tour_time: 1.0;
+    data.time_limit = parameters.time_limit_factor * tour_time;
+    return data;
+}
+
+Instance travellingthiefsolver::packing_while_travelling::generate_instance(
+        const GeneratorParameters& parameters)
+{
+    GeneratedData data = generate_data(parameters);
+    CityId number_of_cities = parameters.number_of_cities;
+
+    // The cities of the instance are the cities of the reference tour, in
+    // the order of the tour.
+    std::vector<CityId> city_positions(number_of_cities);
+    for (CityPos city_pos = 0;
+            city_pos < number_of_cities;
+            ++city_pos) {
+        city_positions[data.tour[city_pos]] = city_pos;
+    }
+
+    InstanceBuilder instance_builder;
+    instance_builder.add_cities(number_of_cities);
+    instance_builder.set_capacity(data.capacity);
+    instance_builder.set_minimum_speed(parameters.minimum_speed);
+    instance_builder.set_maximum_speed(parameters.maximum_speed);
+    instance_builder.set_renting_ratio(data.renting_ratio);
+    for (CityPos city_pos = 0;
+            city_pos < number_of_cities;
+            ++city_pos) {
+        CityPos city_pos_prev = (city_pos == 0)? number_of_cities - 1: city_pos - 1;
+        instance_builder.set_distance(
+                city_pos,
+                generator_distance(
+                    *data.coordinates,
+                    data.tour[city_pos_prev],
+                    data.tour[city_pos]));
+    }
+    for (ItemId item_id = 0;
+            item_id < (ItemId)data.item_city_ids.size();
+            ++item_id) {
+        instance_builder.add_item(
+                city_positions[data.item_city_ids[item_id]],
+                data.item_weights[item_id],
+                data.item_profits[item_id]);
+    }
+    return instance_builder.build();
+}
@@ -1,6 +1,7 @@
 #include "travellingthiefsolver/packing_while_travelling/instance.hpp"
 
 #include "travellingthiefsolver/packing_while_travelling/instance_builder.hpp"
+#include "travellingthiefsolver/packing_while_travelling/binary_instance.hpp"
 
 #include "optimizationtools/containers/indexed_set.hpp"
 
@@ -46,7 +47,7 @@ std::ostream& Instance::format(
             os
                 << std::setw(12) << city_id
                 << std::setw(12) << city.distance
-                << std::setw(12) << city.item_ids.size()
+                << std::setw(12) << city_item_ids(city_id).size()
                 << std::endl;
         }
     }
@@ -118,3 +119,28 @@ void Instance::write(
     }
     file << "EOF" << std::endl;
 }
+
+void Instance::write_binary(
+        const std::string& instance_path) const
+{
+    if (instance_path.empty())
+        return;
+    BinaryInstanceData data;
+    data.problem = BinaryInstanceProblem::PackingWhileTravelling;
+    data.number_of_cities = number_of_cities();
+    data.capacity = capacity();
+    data.minimum_speed = speed_min_;
+    data.maximum_speed = speed_max_;
+    data.renting_ratio = renting_ratio_;
+    data.city_distances = city_distances_;
+    data.city_weights = city_weights_;
+    data.item_city_ids.reserve(number_of_items());
+    data.item_weights.reserve(number_of_items());
+    data.item_profits.reserve(number_of_items());
+    for (const Item& item: items_) {
+        data.item_city_ids.push_back(item.city_id);
+        data.item_weights.push_back(item.weight);
+        data.item_profits.push_back(item.profit);
+    }
+    write_binary_instance(instance_path, data);
+}
@@ -1,5 +1,8 @@
 #include "travellingthiefsolver/packing_while_travelling/instance_builder.hpp"
 
+#include "travellingthiefsolver/packing_while_travelling/polyakovskiy2014.hpp"
+#include "travellingthiefsolver/packing_while_travelling/binary_instance.hpp"
+
 #include "optimizationtools//utils//utils.hpp"
 
 #include <fstream>
@@ -8,6 +11,7 @@ using namespace travellingthiefsolver::packing_while_travelling;
 
 void InstanceBuilder::add_cities(CityId number_of_cities)
 {
+    binary_file_ = nullptr;
     instance_.cities_.insert(instance_.cities_.end(), number_of_cities, City());
 }
 
@@ -23,8 +27,7 @@ void InstanceBuilder::add_item(
         Weight weight,
         Profit profit)
 {
-    ItemId item_id = instance_.items_.size();
-    instance_.cities_[city_id].item_ids.push_back(item_id);
+    binary_file_ = nullptr;
 
     Item item;
     item.city_id = city_id;
@@ -45,7 +48,12 @@ void InstanceBuilder::read(
     if (format == ""
             || format == "default"
             || format == "polyakovskiy2014") {
+        if (!read_polyakovskiy2014(instance_path))
+            read_polyakovskiy2014(file);
+    } else if (format == "polyakovskiy2014_stream") {
         read_polyakovskiy2014(file);
+    } else if (format == "binary") {
+        read_binary(instance_path);
     } else {
         throw std::invalid_argument(
                 "Unknown instance format \"" + format + "\".");
@@ -109,6 +117,92 @@ void InstanceBuilder::read_polyakovskiy2014(std::ifstream& file)
     }
 }
 
+bool InstanceBuilder::read_polyakovskiy2014(const std::string& instance_path)
+{
+    packing_while_travelling::Polyakovskiy2014File file;
+    if (!packing_while_travelling::read_polyakovskiy2014(instance_path, file))
+        return false;
+    if (file.number_of_cities < 0) {
+        throw std::invalid_argument(
+                "Missing DIMENSION entry in file \"" + instance_path + "\".");
+    }
+
+    if (!file.tsplib_lines.empty()) {
+        std::vector<std::string> line = optimizationtools::split(file.tsplib_lines.front());
+        throw std::invalid_argument(
+                "ENTRY \""
+                + line[0]
+                + "\" not implemented.");
+    }
+
+    instance_.cities_ = std::vector<City>(file.number_of_cities);
+    set_capacity(file.capacity);
+    set_minimum_speed(file.minimum_speed);
+    set_maximum_speed(file.maximum_speed);
+    set_renting_ratio(file.renting_ratio);
+    for (CityId city_id = 0;
+            city_id < (CityId)file.city_distances.size();
+            ++city_id) {
+        set_distance(city_id, file.city_distances[city_id]);
+    }
+
+    instance_.items_.reserve(file.item_city_ids.size());
+    for (ItemId item_id = 0;
+            item_id < (ItemId)file.item_city_ids.size();
+            ++item_id) {
+        add_item(
+                file.item_city_ids[item_id],
+                file.item_weights[item_id],
+                file.item_profits[item_id]);
+    }
+    return true;
+}
+
+void InstanceBuilder::read_binary(const std::string& instance_path)
+{
+    auto file = std::make_shared<const BinaryInstanceFile>(instance_path);
+    if (file->problem() != BinaryInstanceProblem::PackingWhileTravelling) {
+        throw std::invalid_argument(
+                "File \"" + instance_path + "\" is not a packing while travelling instance.");
+    }
+    if (file->city_distances() == nullptr) {
+        throw std::invalid_argument(
+                "Missing city distances in file \"" + instance_path + "\".");
+    }
+
+    instance_.cities_ = std::vector<City>(file->number_of_cities());
+    set_capacity(file->capacity());
+    set_minimum_speed(file->minimum_speed());
+    set_maximum_speed(file->maximum_speed());
+    set_renting_ratio(file->renting_ratio());
+    const Distance* city_distances = file->city_distances();
+    const Weight* city_weights = file->city_weights();
+    for (CityId city_id = 0;
+            city_id < file->number_of_cities();
+            ++city_id) {
+        set_distance(city_id, city_distances[city_id]);
+        if (city_weights != nullptr)
+            add_weight(city_id, city_weights[city_id]);
+    }
+
+    instance_.items_.reserve(file->number_of_items());
+    const CityId* item_city_ids = file->item_city_ids();
+    const Weight* item_weights = file->item_weights();
+    const Profit* item_profits = file->item_profits();
+    for (ItemId item_id = 0;
+            item_id < file->number_of_items();
+            ++item_id) {
+        add_item(
+                item_city_ids[item_id],
+                item_weights[item_id],
+                item_profits[item_id]);
+    }
+
+    // The items of each city are given by the CSR index of the file, which
+    // the instance views in place.
+    binary_file_ = file;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////// Build /////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
@@ -182,11 +276,62 @@ void InstanceBuilder::compute_total_weight()
     for (CityId city_id = 0;
             city_id < instance_.number_of_cities();
             ++city_id) {
+        instance_.total_weight_ += instance_.city(city_id).weight;
+    }
+    for (ItemId item_id = 0;
+            item_id < instance_.number_of_items();
+            ++item_id) {
+        instance_.total_weight_ += instance_.item(item_id).weight;
+    }
+}
+
+void InstanceBuilder::compute_city_arrays()
+{
+    CityId number_of_cities = instance_.number_of_cities();
+    instance_.city_distances_.resize(number_of_cities);
+    instance_.city_weights_.resize(number_of_cities);
+    instance_.city_distances_from_start_.resize(number_of_cities);
+    instance_.city_distances_to_end_.resize(number_of_cities);
+    instance_.city_weights_from_start_.resize(number_of_cities);
+    for (CityId city_id = 0; city_id < number_of_cities; ++city_id) {
         const City& city = instance_.city(city_id);
-        instance_.total_weight_ += city.weight;
-        for (ItemId item_id: city.item_ids)
-            instance_.total_weight_ += instance_.item(item_id).weight;
+        instance_.city_distances_[city_id] = city.distance;
+        instance_.city_weights_[city_id] = city.weight;
+        instance_.city_distances_from_start_[city_id] = city.distance_from_start;
+        instance_.city_distances_to_end_[city_id] = city.distance_to_end;
+        instance_.city_weights_from_start_[city_id] = city.weight_from_start;
+    }
+
+    // Item index of the cities.
+    if (binary_file_ != nullptr) {
+        instance_.city_item_arrays_owner_ = binary_file_;
+        instance_.city_item_offsets_ = binary_file_->city_item_offsets();
+        instance_.city_item_ids_ = binary_file_->city_item_ids();
+        return;
+    }
+    auto city_item_arrays = std::make_shared<std::vector<ItemId>>(
+            number_of_cities + 1 + instance_.number_of_items(), 0);
+    ItemId* city_item_offsets = city_item_arrays->data();
+    ItemId* city_item_ids = city_item_offsets + number_of_cities + 1;
+    for (ItemId item_id = 0;
+            item_id < instance_.number_of_items();
+            ++item_id) {
+        city_item_offsets[instance_.item(item_id).city_id + 1]++;
+    }
+    for (CityId city_id = 0; city_id < number_of_cities; ++city_id)
+        city_item_offsets[city_id + 1] += city_item_offsets[city_id];
+    std::vector<ItemId> city_item_positions(
+            city_item_offsets,
+            city_item_offsets + number_of_cities);
+    for (ItemId item_id = 0;
+            item_id < instance_.number_of_items();
+            ++item_id) {
+        CityId city_id = instance_.item(item_id).city_id;
+        city_item_ids[city_item_positions[city_id]++] = item_id;
     }
+    instance_.city_item_arrays_owner_ = city_item_arrays;
+    instance_.city_item_offsets_ = city_item_offsets;
+    instance_.city_item_ids_ = city_item_ids;
 }
 
 Instance InstanceBuilder::build()
@@ -195,5 +340,6 @@ Instance InstanceBuilder::build()
     compute_total_weight();
     compute_total_item_profit();
     compute_weight_from_start();
+    compute_city_arrays();
     return std::move(instance_);
 }
@@ -0,0 +1,94 @@
+#include "travellingthiefsolver/packing_while_travelling/intermediary_outputs.hpp"
+
+#include <cmath>
+#include <iomanip>
+#include <stdexcept>
+
+using namespace travellingthiefsolver::packing_while_travelling;
+
+void IntermediaryOutputsParameters::format(
+        std::ostream& os,
+        int width) const
+{
+    os
+        << "Intermediary outputs" << std::endl
+        << std::setw(width) << std::left << "    Policy: " << policy << std::endl;
+    if (policy == IntermediaryOutputsPolicy::Last)
+        os << std::setw(width) << std::left << "    Max. # of entries: " << maximum_number_of_entries << std::endl;
+    if (policy == IntermediaryOutputsPolicy::LogSpaced)
+        os << std::setw(width) << std::left << "    Log base: " << log_base << std::endl;
+    if (policy == IntermediaryOutputsPolicy::Stream)
+        os << std::setw(width) << std::left << "    Path: " << path << std::endl;
+}
+
+void IntermediaryOutputsParameters::check() const
+{
+    if (policy != IntermediaryOutputsPolicy::Stream)
+        return;
+    if (path.empty()) {
+        throw std::invalid_argument(
+                "Missing path of the intermediary outputs with policy \"stream\".");
+    }
+    std::ofstream file(path, std::ios::app);
+    if (!file.good()) {
+        throw std::invalid_argument(
+                "Unable to open file \"" + path + "\".");
+    }
+}
+
+int64_t IntermediaryOutputs::interval(double time) const
+{
+    const double first_interval_end = 1e-3;
+    if (time < first_interval_end || parameters_.log_base <= 1)
+        return 0;
+    return 1 + (int64_t)std::floor(
+            std::log(time / first_interval_end)
+            / std::log(parameters_.log_base));
+}
+
+void IntermediaryOutputs::add(
+        nlohmann::json& json,
+        nlohmann::json&& entry,
+        double time)
+{
+    if (parameters_.policy == IntermediaryOutputsPolicy::All) {
+        json["IntermediaryOutputs"].push_back(std::move(entry));
+    } else if (parameters_.policy == IntermediaryOutputsPolicy::Last) {
+        if (parameters_.maximum_number_of_entries <= 0)
+            return;
+        last_entries_.push_back(std::move(entry));
+        if ((int64_t)last_entries_.size() > parameters_.maximum_number_of_entries)
+            last_entries_.pop_front();
+    } else if (parameters_.policy == IntermediaryOutputsPolicy::LogSpaced) {
+        // The last entry of each interval replaces the previous ones.
+        nlohmann::json& entries = json["IntermediaryOutputs"];
+        int64_t entry_interval = interval(time);
+        if (entry_interval == last_interval_ && !entries.empty()) {
+            entries.back() = std::move(entry);
+        } else {
+            entries.push_back(std::move(entry));
+        }
+        last_interval_ = entry_interval;
+    } else if (parameters_.policy == IntermediaryOutputsPolicy::Stream) {
+        if (file_ == nullptr) {
+            file_ = std::unique_ptr<std::ofstream>(new std::ofstream(parameters_.path));
+            if (!file_->good()) {
+                throw std::runtime_error(
+                        "Unable to open file \"" + parameters_.path + "\".");
+            }
+        }
+        *file_ << entry << '\n';
+    }
+}
+
+void IntermediaryOutputs::write(nlohmann::json& json) const
+{
+    if (parameters_.policy != IntermediaryOutputsPolicy::Last
+            || last_entries_.empty()) {
+        return;
+    }
+    nlohmann::json& entries = json["IntermediaryOutputs"];
+    entries = nlohmann::json::array();
+    for (const nlohmann::json& entry: last_entries_)
+        entries.push_back(entry);
+}
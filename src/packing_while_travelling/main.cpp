@@ -7,6 +7,10 @@
 #include "travellingthiefsolver/packing_while_travelling/algorithms/efficient_local_search.hpp"
 #include "travellingthiefsolver/packing_while_travelling/algorithms/large_neighborhood_search.hpp"
 
+#include "travellingthiefsolver/packing_while_travelling/throttled_file_writer.hpp"
+#include "travellingthiefsolver/packing_while_travelling/batch.hpp"
+#include "travellingthiefsolver/packing_while_travelling/daemon.hpp"
+
 #include <boost/program_options.hpp>
 
 using namespace travellingthiefsolver::packing_while_travelling;
@@ -26,33 +30,56 @@ void read_args(
     if (vm.count("log"))
         parameters.log_path = vm["log"].as<std::string>();
     parameters.log_to_stderr = vm.count("log-to-stderr");
+    if (vm.count("intermediary-outputs-policy"))
+        parameters.intermediary_outputs_parameters.policy = vm["intermediary-outputs-policy"].as<travellingthiefsolver::packing_while_travelling::IntermediaryOutputsPolicy>();
+    if (vm.count("intermediary-outputs-maximum-number-of-entries"))
+        parameters.intermediary_outputs_parameters.maximum_number_of_entries = vm["intermediary-outputs-maximum-number-of-entries"].as<int64_t>();
+    if (vm.count("intermediary-outputs-log-base"))
+        parameters.intermediary_outputs_parameters.log_base = vm["intermediary-outputs-log-base"].as<double>();
+    if (vm.count("intermediary-outputs-path"))
+        parameters.intermediary_outputs_parameters.path = vm["intermediary-outputs-path"].as<std::string>();
+    parameters.intermediary_outputs_parameters.check();
     bool only_write_at_the_end = vm.count("only-write-at-the-end");
     if (!only_write_at_the_end) {
-        std::string certificate_path = vm["certificate"].as<std::string>();
-        std::string json_output_path = vm["output"].as<std::string>();
-        parameters.new_solution_callback = [
-            json_output_path,
-            certificate_path](
-                    const Output& output,
-                    const std::string&)
-        {
-            output.write_json_output(json_output_path);
-            output.solution.write(certificate_path);
-        };
+        // Intermediate outputs are written in a background thread at most
+        // once per output interval.
+        parameters.new_solution_callback
+            = travellingthiefsolver::packing_while_travelling::throttled_new_solution_callback<Output>(
+                    vm["output"].as<std::string>(),
+                    vm["certificate"].as<std::string>(),
+                    vm["output-interval"].as<double>());
     }
 }
 
+/**
+ * Results of the previous runs of the daemon used to warm-start the
+ * algorithms.
+ */
+struct WarmStart
+{
+    /** Initial solution; the one of the options if 'nullptr'. */
+    const Solution* initial_solution = nullptr;
+
+    /** City states of the instance; computed if 'nullptr'. */
+    const CityStateTable* city_states = nullptr;
+};
+
 Output run(
         const Instance& instance,
-        const po::variables_map& vm)
+        const po::variables_map& vm,
+        const WarmStart& warm_start = WarmStart())
 {
     std::mt19937_64 generator(vm["seed"].as<Seed>());
 
     SolutionBuilder solution_builder;
     solution_builder.set_instance(instance);
-    if (vm.count("initial-solution"))
+    if (warm_start.initial_solution == nullptr
+            && !vm["initial-solution"].as<std::string>().empty()) {
         solution_builder.read(vm["initial-solution"].as<std::string>());
-    Solution solution = solution_builder.build();
+    }
+    Solution solution = (warm_start.initial_solution != nullptr)?
+        *warm_start.initial_solution:
+        solution_builder.build();
 
     // Run algorithm.
     std::string algorithm = vm["algorithm"].as<std::string>();
@@ -71,6 +98,16 @@ Output run(
     } else if (algorithm == "efficient-local-search") {
         EfficientLocalSearchParameters parameters;
         read_args(parameters, vm);
+        if (warm_start.initial_solution != nullptr) {
+            // The initial solution and the city states are those of the
+            // instance, not of the reduced instance.
+            parameters.initial_solution = &solution;
+            parameters.city_states = warm_start.city_states;
+            parameters.reduction_parameters.reduce = false;
+        }
+        parameters.best_improvement = vm.count("best-improvement");
+        if (vm.count("number-of-threads"))
+            parameters.number_of_threads = vm["number-of-threads"].as<int>();
         return efficient_local_search(instance, parameters);
     } else if (algorithm == "large-neighborhood-search") {
         LargeNeighborhoodSearchParameters parameters;
@@ -83,6 +120,313 @@ Output run(
     }
 }
 
+/**
+ * Parse the options of a job of a batch or of a request of the daemon.
+ *
+ * Unless the job sets them, the jobs don't print anything and only write
+ * their output files at the end.
+ */
+po::variables_map parse_batch_job(
+        const po::options_description& desc,
+        nlohmann::json job)
+{
+    if (!job.count("verbosity-level"))
+        job["verbosity-level"] = 0;
+    if (!job.count("only-write-at-the-end"))
+        job["only-write-at-the-end"] = true;
+    po::variables_map vm;
+    po::store(po::command_line_parser(batch_job_arguments(job)).options(desc).run(), vm);
+    po::notify(vm);
+    if (!vm.count("input"))
+        throw std::invalid_argument("Missing input.");
+    if (vm.count("batch") || vm.count("daemon"))
+        throw std::invalid_argument("Nested batch or daemon.");
+    return vm;
+}
+
+/**
+ * Run the jobs of a batch manifest.
+ *
+ * The instances are read once and shared between the jobs with the same
+ * input file. When the jobs run in parallel, their outputs have no profile.
+ */
+int run_batch(
+        const po::options_description& desc,
+        const po::variables_map& vm)
+{
+    std::vector<nlohmann::json> jobs = read_batch_manifest(vm["batch"].as<std::string>());
+    BatchCache<Instance> instances(vm["batch-cache-size"].as<Counter>());
+
+    // The profiling measures are totals over the process, so the profile of
+    // a job would include the measures of the jobs running concurrently.
+    bool parallel = (vm["batch-number-of-threads"].as<int>() > 1);
+
+    auto run_job = [&desc, &instances, parallel](const nlohmann::json& job) -> nlohmann::json
+    {
+        po::variables_map job_vm = parse_batch_job(desc, job);
+        std::string instance_path = job_vm["input"].as<std::string>();
+        std::string format = job_vm["format"].as<std::string>();
+        std::shared_ptr<const Instance> instance = instances.get(
+                format + ":" + instance_path,
+                [&instance_path, &format]()
+                {
+                    InstanceBuilder instance_builder;
+                    instance_builder.read(instance_path, format);
+                    return std::make_shared<const Instance>(instance_builder.build());
+                });
+
+        Output output = run(*instance, job_vm);
+        if (parallel)
+            output.json.erase("Profile");
+        output.write_json_output(job_vm["output"].as<std::string>());
+        output.solution.write(job_vm["certificate"].as<std::string>());
+        return output.json;
+    };
+
+    std::string batch_output_path = vm["batch-output"].as<std::string>();
+    std::ofstream file;
+    if (!batch_output_path.empty()) {
+        file.open(batch_output_path);
+        if (!file.good()) {
+            throw std::runtime_error(
+                    "Unable to open file \"" + batch_output_path + "\".");
+        }
+    }
+    travellingthiefsolver::packing_while_travelling::run_batch(
+            jobs,
+            vm["batch-number-of-threads"].as<int>(),
+            (batch_output_path.empty())? std::cout: file,
+            run_job);
+    return 0;
+}
+
+/**
+ * State kept by the daemon for an input file.
+ */
+struct DaemonInstance
+{
+    /** Instance of the input file. */
+    std::shared_ptr<const Instance> instance;
+
+    /** Capacity and item changes the city states have been computed for. */
+    std::string city_states_signature;
+
+    /** City states of the last instance solved. */
+    std::shared_ptr<const CityStateTable> city_states;
+
+    /** Items of the last solution found. */
+    std::vector<ItemId> incumbent_item_ids;
+
+    /** Whether a solution has been found. */
+    bool has_incumbent = false;
+};
+
+/**
+ * Build the instance of a request of the daemon from the instance of its
+ * input file and the changes of the request.
+ *
+ * The changes are given by an object with the optional fields
+ * "renting-ratio", "capacity", "items", a list of objects with the "id" of
+ * an item and its new "weight" and/or "profit", and "new-items", a list of
+ * objects with the "city", the "weight" and the "profit" of new items.
+ */
+Instance apply_changes(
+        const Instance& instance,
+        const nlohmann::json& changes)
+{
+    std::vector<Item> items;
+    for (ItemId item_id = 0;
+            item_id < instance.number_of_items();
+            ++item_id) {
+        items.push_back(instance.item(item_id));
+    }
+    if (changes.count("items")) {
+        for (const nlohmann::json& item_change: changes["items"]) {
+            ItemId item_id = item_change.at("id");
+            if (item_id < 0 || item_id >= instance.number_of_items()) {
+                throw std::invalid_argument(
+                        "Invalid item id " + std::to_string(item_id) + ".");
+            }
+            if (item_change.count("weight"))
+                items[item_id].weight = item_change["weight"];
+            if (item_change.count("profit"))
+                items[item_id].profit = item_change["profit"];
+        }
+    }
+    if (changes.count("new-items")) {
+        for (const nlohmann::json& new_item: changes["new-items"]) {
+            Item item;
+            item.city_id = new_item.at("city");
+            item.weight = new_item.at("weight");
+            item.profit = new_item.at("profit");
+            if (item.city_id < 0 || item.city_id >= instance.number_of_cities()) {
+                throw std::invalid_argument(
+                        "Invalid city id " + std::to_string(item.city_id) + ".");
+            }
+            items.push_back(item);
+        }
+    }
+
+    InstanceBuilder instance_builder;
+    instance_builder.add_cities(instance.number_of_cities());
+    for (CityId city_id = 0;
+            city_id < instance.number_of_cities();
+            ++city_id) {
+        instance_builder.set_distance(city_id, instance.city(city_id).distance);
+        instance_builder.add_weight(city_id, instance.city(city_id).weight);
+    }
+    instance_builder.set_minimum_speed(instance.minimum_speed());
+    instance_builder.set_maximum_speed(instance.maximum_speed());
+    instance_builder.set_renting_ratio(changes.value("renting-ratio", instance.renting_ratio()));
+    instance_builder.set_capacity(changes.value("capacity", instance.capacity()));
+    for (const Item& item: items)
+        instance_builder.add_item(item.city_id, item.weight, item.profit);
+    return instance_builder.build();
+}
+
+/**
+ * Rebuild the last solution found by the daemon on the instance of a
+ * request.
+ *
+ * If the items of the solution don't fit in the knapsack anymore, the items
+ * with the smallest profit to weight ratios are removed. The items which are
+ * not in the instance of the request, such as the new items of the request
+ * the solution has been found for, are removed too.
+ */
+Solution rebuild_incumbent(
+        const Instance& instance,
+        std::vector<ItemId> item_ids)
+{
+    item_ids.erase(
+            std::remove_if(
+                item_ids.begin(),
+                item_ids.end(),
+                [&instance](ItemId item_id) { return item_id >= instance.number_of_items(); }),
+            item_ids.end());
+    std::sort(
+            item_ids.begin(),
+            item_ids.end(),
+            [&instance](ItemId item_id_1, ItemId item_id_2)
+            {
+                const Item& item_1 = instance.item(item_id_1);
+                const Item& item_2 = instance.item(item_id_2);
+                return item_1.profit * item_2.weight > item_2.profit * item_1.weight;
+            });
+    SolutionBuilder solution_builder;
+    solution_builder.set_instance(instance);
+    Weight weight = 0;
+    for (ItemId item_id: item_ids) {
+        if (weight + instance.item(item_id).weight > instance.capacity())
+            continue;
+        solution_builder.add_item(item_id);
+        weight += instance.item(item_id).weight;
+    }
+    return solution_builder.build();
+}
+
+/**
+ * Run the daemon.
+ *
+ * For each input file, the daemon keeps the instance, the city states and
+ * the last solution found. A request may change the renting ratio, the
+ * capacity and the items of the instance with its "changes" field (see
+ * 'apply_changes'). The efficient local search then starts from the last
+ * solution found for the input file.
+ *
+ * The request '{"command": "forget", "input": ...}' drops the state kept for
+ * an input file.
+ */
+int run_daemon(
+        const po::options_description& desc,
+        const po::variables_map& vm)
+{
+    std::map<std::string, DaemonInstance> daemon_instances;
+
+    auto handle_request = [&desc, &daemon_instances](const nlohmann::json& request) -> nlohmann::json
+    {
+        nlohmann::json options = request;
+        std::string command = options.value("command", "solve");
+        nlohmann::json changes = options.value("changes", nlohmann::json::object());
+        options.erase("command");
+        options.erase("changes");
+        if (!changes.is_object())
+            throw std::invalid_argument("The changes are not a JSON object.");
+        po::variables_map request_vm = parse_batch_job(desc, options);
+        std::string instance_path = request_vm["input"].as<std::string>();
+        std::string format = request_vm["format"].as<std::string>();
+        std::string key = format + ":" + instance_path;
+
+        if (command == "forget") {
+            return {{"Forgotten", daemon_instances.erase(key) > 0}};
+        } else if (command != "solve") {
+            throw std::invalid_argument(
+                    "Unknown command \"" + command + "\".");
+        }
+
+        auto it = daemon_instances.find(key);
+        if (it == daemon_instances.end()) {
+            InstanceBuilder instance_builder;
+            instance_builder.read(instance_path, format);
+            DaemonInstance daemon_instance;
+            daemon_instance.instance = std::make_shared<const Instance>(instance_builder.build());
+            it = daemon_instances.insert({key, std::move(daemon_instance)}).first;
+        }
+        DaemonInstance& daemon_instance = it->second;
+        std::shared_ptr<const Instance> instance = (changes.empty())?
+            daemon_instance.instance:
+            std::make_shared<const Instance>(apply_changes(*daemon_instance.instance, changes));
+
+        bool warm = daemon_instance.has_incumbent;
+        WarmStart warm_start;
+        Solution initial_solution = rebuild_incumbent(
+                *instance,
+                daemon_instance.incumbent_item_ids);
+        if (warm)
+            warm_start.initial_solution = &initial_solution;
+
+        // The city states only depend on the capacity and on the items.
+        if (warm && request_vm["algorithm"].as<std::string>() == "efficient-local-search") {
+            std::string city_states_signature = std::to_string(instance->capacity());
+            if (changes.count("items"))
+                city_states_signature += " " + changes["items"].dump();
+            if (changes.count("new-items"))
+                city_states_signature += " " + changes["new-items"].dump();
+            if (daemon_instance.city_states == nullptr
+                    || daemon_instance.city_states_signature != city_states_signature) {
+                daemon_instance.city_states = std::make_shared<const CityStateTable>(
+                        compute_city_state_table<Instance>(*instance));
+                daemon_instance.city_states_signature = city_states_signature;
+            }
+            warm_start.city_states = daemon_instance.city_states.get();
+        }
+
+        Output output = run(*instance, request_vm, warm_start);
+        output.write_json_output(request_vm["output"].as<std::string>());
+        output.solution.write(request_vm["certificate"].as<std::string>());
+
+        // Keep the solution found for the next requests.
+        std::vector<ItemId> item_ids;
+        for (ItemId item_id = 0;
+                item_id < instance->number_of_items();
+                ++item_id) {
+            if (output.solution.contains(item_id))
+                item_ids.push_back(item_id);
+        }
+        daemon_instance.incumbent_item_ids = item_ids;
+        daemon_instance.has_incumbent = true;
+
+        nlohmann::json response = output.json;
+        response["WarmStart"] = warm;
+        response["Certificate"] = {{"ItemIds", item_ids}};
+        return response;
+    };
+
+    travellingthiefsolver::packing_while_travelling::run_daemon(
+            vm["daemon"].as<std::string>(),
+            handle_request);
+    return 0;
+}
+
 int main(int argc, char *argv[])
 {
     // Parse program options
@@ -90,8 +434,8 @@ int main(int argc, char *argv[])
     desc.add_options()
         ("help,h", "produce help message")
         ("algorithm,a", po::value<std::string>()->default_value("large-neighborhood-search"), "set algorithm")
-        ("input,i", po::value<std::string>()->required(), "set input file (required)")
-        ("format,f", po::value<std::string>()->default_value(""), "set input file format (default: standard)")
+        ("input,i", po::value<std::string>(), "set input file (required unless --batch is set)")
+        ("format,f", po::value<std::string>()->default_value(""), "set input file format (default: standard, binary)")
         ("unicost,u", "set unicost")
         ("output,o", po::value<std::string>()->default_value(""), "set JSON output file")
         ("initial-solution,", po::value<std::string>()->default_value(""), "")
@@ -100,8 +444,22 @@ int main(int argc, char *argv[])
         ("time-limit,t", po::value<double>(), "set time limit in seconds")
         ("verbosity-level,v", po::value<int>(), "set verbosity level")
         ("only-write-at-the-end,e", "only write output and certificate files at the end")
+        ("output-interval,", po::value<double>()->default_value(1.0), "set minimum interval in seconds between two writes of the intermediate output and certificate files")
         ("log,l", po::value<std::string>(), "set log file")
         ("log-to-stderr", "write log to stderr")
+        ("intermediary-outputs-policy,", po::value<travellingthiefsolver::packing_while_travelling::IntermediaryOutputsPolicy>(), "set policy of the history of intermediary outputs (all, last, log-spaced, stream, none)")
+        ("intermediary-outputs-maximum-number-of-entries,", po::value<int64_t>(), "set number of intermediary outputs kept with policy 'last'")
+        ("intermediary-outputs-log-base,", po::value<double>(), "set ratio between consecutive time intervals with policy 'log-spaced'")
+        ("intermediary-outputs-path,", po::value<std::string>(), "set JSON-lines file of the intermediary outputs with policy 'stream'")
+
+        ("best-improvement,", "use best-improvement in the efficient local search")
+        ("number-of-threads,", po::value<int>(), "set number of threads")
+
+        ("batch,", po::value<std::string>(), "set JSON-lines manifest of jobs to run instead of a single input")
+        ("batch-output,", po::value<std::string>()->default_value(""), "set JSON-lines output file of the batch (default: standard output)")
+        ("batch-number-of-threads,", po::value<int>()->default_value(1), "set number of jobs of the batch run in parallel")
+        ("batch-cache-size,", po::value<Counter>()->default_value(16), "set number of instances kept in memory between the jobs of the batch")
+        ("daemon,", po::value<std::string>(), "set Unix domain socket to listen on for requests instead of solving a single input")
 
         //("maximum-number-of-iterations,", po::value<int>(), "set the maximum number of iterations")
         ;
@@ -118,6 +476,15 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    if (vm.count("batch"))
+        return run_batch(desc, vm);
+    if (vm.count("daemon"))
+        return run_daemon(desc, vm);
+    if (!vm.count("input")) {
+        std::cout << desc << std::endl;;
+        return 1;
+    }
+
     // Build instance.
     InstanceBuilder instance_builder;
     instance_builder.read(
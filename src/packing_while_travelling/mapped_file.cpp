@@ -0,0 +1,96 @@
+#include "travellingthiefsolver/packing_while_travelling/mapped_file.hpp"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+travellingthiefsolver::packing_while_travelling::MappedFile::MappedFile(const std::string& path)
+{
+#ifdef _WIN32
+    file_ = CreateFileA(
+            path.c_str(),
+            GENERIC_READ,
+            FILE_SHARE_READ,
+            NULL,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+            NULL);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        file_ = nullptr;
+        throw std::runtime_error(
+                "Unable to open file \"" + path + "\".");
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx((HANDLE)file_, &size)) {
+        CloseHandle((HANDLE)file_);
+        throw std::runtime_error(
+                "Unable to read the size of file \"" + path + "\".");
+    }
+    size_ = (std::size_t)size.QuadPart;
+    if (size_ == 0)
+        return;
+    mapping_ = CreateFileMappingA((HANDLE)file_, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping_ != nullptr)
+        data_ = (const char*)MapViewOfFile((HANDLE)mapping_, FILE_MAP_READ, 0, 0, 0);
+    if (data_ == nullptr) {
+        if (mapping_ != nullptr)
+            CloseHandle((HANDLE)mapping_);
+        CloseHandle((HANDLE)file_);
+        throw std::runtime_error(
+                "Unable to map file \"" + path + "\".");
+    }
+#else
+    file_descriptor_ = open(path.c_str(), O_RDONLY);
+    if (file_descriptor_ == -1) {
+        throw std::runtime_error(
+                "Unable to open file \"" + path + "\".");
+    }
+    struct stat file_stat;
+    if (fstat(file_descriptor_, &file_stat) == -1) {
+        close(file_descriptor_);
+        throw std::runtime_error(
+                "Unable to read the size of file \"" + path + "\".");
+    }
+    size_ = (std::size_t)file_stat.st_size;
+    if (size_ == 0)
+        return;
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_descriptor_, 0);
+    if (data == MAP_FAILED) {
+        close(file_descriptor_);
+        throw std::runtime_error(
+                "Unable to map file \"" + path + "\".");
+    }
+    madvise(data, size_, MADV_SEQUENTIAL);
+    data_ = (const char*)data;
+#endif
+}
+
+travellingthiefsolver::packing_while_travelling::MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+    if (data_ != nullptr)
+        UnmapViewOfFile(data_);
+    if (mapping_ != nullptr)
+        CloseHandle((HANDLE)mapping_);
+    if (file_ != nullptr)
+        CloseHandle((HANDLE)file_);
+#else
+    if (data_ != nullptr)
+        munmap((void*)data_, size_);
+    if (file_descriptor_ != -1)
+        close(file_descriptor_);
+#endif
+}
@@ -0,0 +1,303 @@
+#include "travellingthiefsolver/packing_while_travelling/polyakovskiy2014.hpp"
+
+#include "travellingthiefsolver/packing_while_travelling/mapped_file.hpp"
+
+#include "optimizationtools/utils/utils.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace travellingthiefsolver::packing_while_travelling;
+
+namespace
+{
+
+/**
+ * Cursor over the content of a file with line and number readers.
+ */
+class Cursor
+{
+
+public:
+
+    /** Constructor. */
+    Cursor(
+            const char* begin,
+            const char* end):
+        current_(begin),
+        end_(end) { }
+
+    /** Return 'true' iff the whole content has been read. */
+    bool at_end() const { return current_ == end_; }
+
+    /** Read the rest of the current line. */
+    std::string line()
+    {
+        const char* begin = current_;
+        while (current_ != end_ && *current_ != '\n')
+            ++current_;
+        const char* end = current_;
+        if (current_ != end_)
+            ++current_;
+        if (end != begin && *(end - 1) == '\r')
+            --end;
+        return std::string(begin, end);
+    }
+
+    /** Read an integer. */
+    int64_t integer()
+    {
+        skip_whitespaces();
+        const char* begin = current_;
+        bool negative = false;
+        if (current_ != end_ && (*current_ == '-' || *current_ == '+')) {
+            negative = (*current_ == '-');
+            ++current_;
+        }
+        const char* digits_begin = current_;
+        int64_t value = 0;
+        while (current_ != end_ && is_digit(*current_)) {
+            value = 10 * value + (*current_ - '0');
+            ++current_;
+        }
+        if (current_ == digits_begin
+                || (current_ != end_ && !is_whitespace(*current_))) {
+            throw std::invalid_argument(
+                    "Unable to read integer \"" + token(begin) + "\".");
+        }
+        return (negative)? -value: value;
+    }
+
+    /**
+     * Read a floating-point number.
+     *
+     * Numbers with at most 19 significant digits and a small decimal exponent
+     * are computed with a single exact multiplication or division, which is
+     * correctly rounded; the other ones are read with 'strtod'.
+     */
+    double floating_point()
+    {
+        skip_whitespaces();
+        const char* begin = current_;
+        bool negative = false;
+        if (current_ != end_ && (*current_ == '-' || *current_ == '+')) {
+            negative = (*current_ == '-');
+            ++current_;
+        }
+        uint64_t mantissa = 0;
+        int number_of_digits = 0;
+        int exponent = 0;
+        while (current_ != end_ && is_digit(*current_)) {
+            mantissa = 10 * mantissa + (*current_ - '0');
+            ++number_of_digits;
+            ++current_;
+        }
+        if (current_ != end_ && *current_ == '.') {
+            ++current_;
+            while (current_ != end_ && is_digit(*current_)) {
+                mantissa = 10 * mantissa + (*current_ - '0');
+                ++number_of_digits;
+                --exponent;
+                ++current_;
+            }
+        }
+        if (number_of_digits > 0
+                && current_ != end_
+                && (*current_ == 'e' || *current_ == 'E')) {
+            ++current_;
+            bool exponent_negative = false;
+            if (current_ != end_ && (*current_ == '-' || *current_ == '+')) {
+                exponent_negative = (*current_ == '-');
+                ++current_;
+            }
+            int explicit_exponent = 0;
+            while (current_ != end_ && is_digit(*current_) && explicit_exponent < 10000) {
+                explicit_exponent = 10 * explicit_exponent + (*current_ - '0');
+                ++current_;
+            }
+            exponent += (exponent_negative)? -explicit_exponent: explicit_exponent;
+        }
+        if (number_of_digits > 0
+                && number_of_digits <= 19
+                && mantissa <= ((uint64_t)1 << 53)
+                && exponent >= -22
+                && exponent <= 22
+                && (current_ == end_ || is_whitespace(*current_))) {
+            double value = (double)mantissa;
+            if (exponent < 0) {
+                value /= powers_of_ten_[-exponent];
+            } else {
+                value *= powers_of_ten_[exponent];
+            }
+            return (negative)? -value: value;
+        }
+
+        // Slow path.
+        std::string s = token(begin);
+        char* s_end = nullptr;
+        double value = std::strtod(s.c_str(), &s_end);
+        if (s.empty() || s_end != s.c_str() + s.size()) {
+            throw std::invalid_argument(
+                    "Unable to read number \"" + s + "\".");
+        }
+        return value;
+    }
+
+private:
+
+    static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+    static bool is_whitespace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    void skip_whitespaces()
+    {
+        while (current_ != end_ && is_whitespace(*current_))
+            ++current_;
+    }
+
+    /** Get the token starting at 'begin' and move the cursor after it. */
+    std::string token(const char* begin)
+    {
+        current_ = begin;
+        while (current_ != end_ && !is_whitespace(*current_))
+            ++current_;
+        return std::string(begin, current_);
+    }
+
+    /** Powers of ten which are exactly representable. */
+    static constexpr double powers_of_ten_[23] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    /** Current position. */
+    const char* current_;
+
+    /** End of the content. */
+    const char* end_;
+
+};
+
+constexpr double Cursor::powers_of_ten_[23];
+
+}
+
+bool travellingthiefsolver::packing_while_travelling::read_polyakovskiy2014(
+        const std::string& instance_path,
+        Polyakovskiy2014File& file)
+{
+    MappedFile mapped_file(instance_path);
+    Cursor cursor(mapped_file.begin(), mapped_file.end());
+
+    // The sections are read with the sizes given in the specification part, so
+    // these entries must come first.
+    auto check_number_of_cities = [&instance_path, &file]()
+    {
+        if (file.number_of_cities < 0) {
+            throw std::invalid_argument(
+                    "Missing DIMENSION entry in file \"" + instance_path + "\".");
+        }
+    };
+
+    bool has_edge_weight_type = false;
+    while (!cursor.at_end()) {
+        std::string tmp = cursor.line();
+        std::vector<std::string> line = optimizationtools::split(tmp);
+        if (line.size() == 0) {
+        } else if (tmp.rfind("NAME", 0) == 0) {
+        } else if (tmp.rfind("PROBLEM NAME", 0) == 0) {
+        } else if (tmp.rfind("COMMENT", 0) == 0) {
+        } else if (tmp.rfind("TYPE", 0) == 0) {
+        } else if (tmp.rfind("KNAPSACK DATA TYPE", 0) == 0) {
+        } else if (tmp.rfind("DISPLAY_DATA_TYPE", 0) == 0) {
+        } else if (tmp.rfind("DIMENSION", 0) == 0) {
+            file.number_of_cities = std::stol(line.back());
+        } else if (tmp.rfind("NUMBER OF ITEMS", 0) == 0) {
+            file.number_of_items = std::stol(line.back());
+        } else if (tmp.rfind("CAPACITY OF KNAPSACK", 0) == 0) {
+            file.capacity = std::stol(line.back());
+        } else if (tmp.rfind("MAX TIME", 0) == 0) {
+            file.time_limit = std::stod(line.back());
+        } else if (tmp.rfind("MIN SPEED", 0) == 0) {
+            file.minimum_speed = std::stod(line.back());
+        } else if (tmp.rfind("MAX SPEED", 0) == 0) {
+            file.maximum_speed = std::stod(line.back());
+        } else if (tmp.rfind("RENTING RATIO", 0) == 0) {
+            file.renting_ratio = std::stod(line.back());
+        } else if (tmp.rfind("NODE_COORD_SECTION", 0) == 0) {
+            check_number_of_cities();
+            file.xs.reserve(file.number_of_cities);
+            file.ys.reserve(file.number_of_cities);
+            for (CityId city_id = 0;
+                    city_id < file.number_of_cities;
+                    ++city_id) {
+                cursor.integer();
+                file.xs.push_back(cursor.floating_point());
+                file.ys.push_back(cursor.floating_point());
+            }
+        } else if (tmp.rfind("EDGE_WEIGHT_SECTION", 0) == 0) {
+            // With an 'EDGE_WEIGHT_TYPE' entry, the section contains a TSPLIB
+            // distance matrix.
+            if (has_edge_weight_type)
+                return false;
+            check_number_of_cities();
+            file.city_distances.reserve(file.number_of_cities);
+            for (CityId city_id = 0;
+                    city_id < file.number_of_cities;
+                    ++city_id) {
+                cursor.integer();
+                file.city_distances.push_back(cursor.integer());
+            }
+        } else if (tmp.rfind("WEIGHTS SECTION", 0) == 0) {
+            check_number_of_cities();
+            file.city_weights.reserve(file.number_of_cities);
+            for (CityId city_id = 0;
+                    city_id < file.number_of_cities;
+                    ++city_id) {
+                cursor.integer();
+                file.city_weights.push_back(cursor.integer());
+            }
+        } else if (tmp.rfind("ITEMS SECTION", 0) == 0) {
+            if (file.number_of_items < 0) {
+                throw std::invalid_argument(
+                        "Missing NUMBER OF ITEMS entry in file \"" + instance_path + "\".");
+            }
+            file.item_city_ids.reserve(file.number_of_items);
+            file.item_weights.reserve(file.number_of_items);
+            file.item_profits.reserve(file.number_of_items);
+            for (ItemId item_id = 0;
+                    item_id < file.number_of_items;
+                    ++item_id) {
+                cursor.integer();
+                file.item_profits.push_back(cursor.floating_point());
+                file.item_weights.push_back(cursor.integer());
+                CityId city_id = cursor.integer() - 1;
+                if (city_id < 0 || city_id >= file.number_of_cities) {
+                    throw std::invalid_argument(
+                            "Invalid city of item "
+                            + std::to_string(item_id + 1) + ".");
+                }
+                file.item_city_ids.push_back(city_id);
+            }
+        } else if (tmp.rfind("EOF", 0) == 0) {
+            break;
+        } else if (tmp.find("SECTION") != std::string::npos) {
+            return false;
+        } else {
+            if (tmp.rfind("EDGE_WEIGHT_TYPE", 0) == 0) {
+                has_edge_weight_type = true;
+                file.edge_weight_type = line.back();
+            }
+            // 3D coordinates are not supported.
+            if (tmp.rfind("NODE_COORD_TYPE", 0) == 0
+                    && line.back() != "TWOD_COORDS") {
+                return false;
+            }
+            file.tsplib_lines.push_back(tmp);
+        }
+    }
+
+    return true;
+}
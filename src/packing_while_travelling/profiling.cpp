@@ -0,0 +1,135 @@
+#include "travellingthiefsolver/packing_while_travelling/profiling.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+using namespace travellingthiefsolver::packing_while_travelling::profiling;
+
+namespace
+{
+
+/**
+ * Global state of the registry.
+ */
+struct Registry
+{
+    /** Mutex protecting all the attributes. */
+    std::mutex mutex;
+
+    /** Names of the entries. */
+    std::vector<std::string> names;
+
+    /** Slots of the running threads. */
+    std::vector<const ThreadEntries*> thread_entries;
+
+    /** Accumulated times of the threads which have ended. */
+    std::vector<int64_t> ended_threads_times = std::vector<int64_t>(maximum_number_of_entries, 0);
+
+    /** Accumulated counts of the threads which have ended. */
+    std::vector<int64_t> ended_threads_counts = std::vector<int64_t>(maximum_number_of_entries, 0);
+};
+
+Registry& registry()
+{
+    static Registry registry;
+    return registry;
+}
+
+}
+
+int travellingthiefsolver::packing_while_travelling::profiling::register_entry(
+        const char* name)
+{
+    Registry& registry = ::registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (int entry_id = 0;
+            entry_id < (int)registry.names.size();
+            ++entry_id) {
+        if (registry.names[entry_id] == name)
+            return entry_id;
+    }
+    if ((int)registry.names.size() == maximum_number_of_entries)
+        return -1;
+    registry.names.push_back(name);
+    return (int)registry.names.size() - 1;
+}
+
+ThreadEntries::ThreadEntries()
+{
+    for (int entry_id = 0;
+            entry_id < maximum_number_of_entries;
+            ++entry_id) {
+        times[entry_id].store(0, std::memory_order_relaxed);
+        counts[entry_id].store(0, std::memory_order_relaxed);
+    }
+    Registry& registry = ::registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.thread_entries.push_back(this);
+}
+
+ThreadEntries::~ThreadEntries()
+{
+    Registry& registry = ::registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (int entry_id = 0;
+            entry_id < maximum_number_of_entries;
+            ++entry_id) {
+        registry.ended_threads_times[entry_id] += times[entry_id].load(std::memory_order_relaxed);
+        registry.ended_threads_counts[entry_id] += counts[entry_id].load(std::memory_order_relaxed);
+    }
+    registry.thread_entries.erase(std::find(
+                registry.thread_entries.begin(),
+                registry.thread_entries.end(),
+                this));
+}
+
+Snapshot travellingthiefsolver::packing_while_travelling::profiling::snapshot()
+{
+    Registry& registry = ::registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    int number_of_entries = registry.names.size();
+    Snapshot snapshot;
+    snapshot.times = std::vector<int64_t>(
+            registry.ended_threads_times.begin(),
+            registry.ended_threads_times.begin() + number_of_entries);
+    snapshot.counts = std::vector<int64_t>(
+            registry.ended_threads_counts.begin(),
+            registry.ended_threads_counts.begin() + number_of_entries);
+    for (const ThreadEntries* entries: registry.thread_entries) {
+        for (int entry_id = 0; entry_id < number_of_entries; ++entry_id) {
+            snapshot.times[entry_id] += entries->times[entry_id].load(std::memory_order_relaxed);
+            snapshot.counts[entry_id] += entries->counts[entry_id].load(std::memory_order_relaxed);
+        }
+    }
+    return snapshot;
+}
+
+nlohmann::json travellingthiefsolver::packing_while_travelling::profiling::to_json(
+        const Snapshot& start)
+{
+    Snapshot end = snapshot();
+    std::vector<std::string> names;
+    {
+        Registry& registry = ::registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        names = registry.names;
+    }
+    nlohmann::json json = nlohmann::json::object();
+    for (int entry_id = 0;
+            entry_id < (int)end.times.size();
+            ++entry_id) {
+        int64_t time = end.times[entry_id];
+        int64_t count = end.counts[entry_id];
+        if (entry_id < (int)start.times.size()) {
+            time -= start.times[entry_id];
+            count -= start.counts[entry_id];
+        }
+        if (count == 0)
+            continue;
+        nlohmann::json entry = {{"Count", count}};
+        if (time != 0)
+            entry["Time"] = (double)time / 1e9;
+        json[names[entry_id]] = entry;
+    }
+    return json;
+}
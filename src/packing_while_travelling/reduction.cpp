@@ -2,6 +2,7 @@
 
 #include "travellingthiefsolver/packing_while_travelling/instance_builder.hpp"
 #include "travellingthiefsolver/packing_while_travelling/solution_builder.hpp"
+#include "travellingthiefsolver/packing_while_travelling/profiling.hpp"
 
 #include "optimizationtools/containers/indexed_set.hpp"
 
@@ -15,19 +16,20 @@ bool Reduction::reduce_unprofitable_items()
             item_id < instance().number_of_items();
             ++item_id) {
         const Item& item = instance().item(item_id);
-        const City& city = instance().city(item.city_id);
+        Weight weight_from_start = instance().city_weights_from_start()[item.city_id];
+        Distance distance_to_end = instance().city_distances_to_end()[item.city_id];
         double speed_after_without = instance().maximum_speed()
-            - (double)(city.weight_from_start
+            - (double)(weight_from_start
                     * (instance().maximum_speed() - instance().minimum_speed()))
             / instance().capacity();
         double speed_after_with = instance().maximum_speed()
-            - (double)((city.weight_from_start + item.weight)
+            - (double)((weight_from_start + item.weight)
                     * (instance().maximum_speed() - instance().minimum_speed()))
             / instance().capacity();
         Profit cost_without = instance().renting_ratio()
-            * (double)city.distance_to_end / speed_after_without;
+            * (double)distance_to_end / speed_after_without;
         Profit cost_with = instance().renting_ratio()
-            * (double)city.distance_to_end / speed_after_with;
+            * (double)distance_to_end / speed_after_with;
         Profit min_cost = cost_with - cost_without;
         if (item.profit <= min_cost) {
             unprofitable_items.add(item_id);
@@ -52,9 +54,8 @@ bool Reduction::reduce_unprofitable_items()
     for (CityId city_id = 0;
             city_id < instance().number_of_cities();
             ++city_id) {
-        const City& city = instance().city(city_id);
-        new_instance_builder.set_distance(city_id, city.distance);
-        new_instance_builder.add_weight(city_id, city.weight);
+        new_instance_builder.set_distance(city_id, instance().city_distances()[city_id]);
+        new_instance_builder.add_weight(city_id, instance().city_weights()[city_id]);
     }
     new_instance_builder.set_minimum_speed(instance().minimum_speed());
     new_instance_builder.set_maximum_speed(instance().maximum_speed());
@@ -89,7 +90,7 @@ bool Reduction::reduce_compulsory_items()
     if (instance().total_weight() <= instance().capacity()) {
         for (ItemId item_id = 0; item_id < instance().number_of_items(); ++item_id) {
             const Item& item = instance().item(item_id);
-            const City& city = instance().city(item.city_id);
+            Distance distance_to_end = instance().city_distances_to_end()[item.city_id];
             double speed_after_without = instance().maximum_speed()
                 - (double)((instance().total_weight() - item.weight)
                         * (instance().maximum_speed() - instance().minimum_speed()))
@@ -99,9 +100,9 @@ bool Reduction::reduce_compulsory_items()
                         * (instance().maximum_speed() - instance().minimum_speed()))
                 / instance().capacity();
             Profit cost_without = instance().renting_ratio()
-                * (double)city.distance_to_end / speed_after_without;
+                * (double)distance_to_end / speed_after_without;
             Profit cost_with = instance().renting_ratio()
-                * (double)city.distance_to_end / speed_after_with;
+                * (double)distance_to_end / speed_after_with;
             Profit max_cost = cost_with - cost_without;
             if (item.profit >= max_cost) {
                 compulsory_items.add(item_id);
@@ -126,9 +127,8 @@ bool Reduction::reduce_compulsory_items()
     for (CityId city_id = 0;
             city_id < instance().number_of_cities();
             ++city_id) {
-        const City& city = instance().city(city_id);
-        new_instance_builder.set_distance(city_id, city.distance);
-        new_instance_builder.add_weight(city_id, city.weight);
+        new_instance_builder.set_distance(city_id, instance().city_distances()[city_id]);
+        new_instance_builder.add_weight(city_id, instance().city_weights()[city_id]);
     }
     new_instance_builder.set_minimum_speed(instance().minimum_speed());
     new_instance_builder.set_maximum_speed(instance().maximum_speed());
@@ -181,6 +181,8 @@ bool Reduction::reduce_polyakovskiy2017(
     double ups = (instance().maximum_speed() - instance().minimum_speed())
         / instance().capacity();
 
+    const std::vector<Distance>& city_distances = instance().city_distances();
+    const std::vector<Weight>& city_weights = instance().city_weights();
     for (Counter round_number = 0;
             round_number < maximum_number_of_rounds;
             ++round_number) {
@@ -202,13 +204,11 @@ bool Reduction::reduce_polyakovskiy2017(
         for (CityId city_id = 1;
                 city_id < instance().number_of_cities();
                 ++city_id) {
-            const City& city = instance().city(city_id);
-
-            w_max[city_id] = w_max[city_id - 1] + city.weight;
-            w_sum += city.weight;
+            w_max[city_id] = w_max[city_id - 1] + city_weights[city_id];
+            w_sum += city_weights[city_id];
 
             // Loop through the items of the city.
-            for (ItemId item_id: instance().city(city_id).item_ids) {
+            for (ItemId item_id: instance().city_item_ids(city_id)) {
                 const Item& item = instance().item(item_id);
 
                 // Don't consider unprofitable items.
@@ -229,13 +229,13 @@ bool Reduction::reduce_polyakovskiy2017(
             for (CityId city_id_1 = instance().number_of_cities() - 1;
                     city_id_1 >= 0;
                     --city_id_1) {
-                const City& city_1 = instance().city(city_id_1);
+                ItemIdRange city_1_item_ids = instance().city_item_ids(city_id_1);
 
                 // Loop through the items of the city.
                 for (ItemId item_pos_1 = 0;
-                        item_pos_1 < (ItemId)city_1.item_ids.size();
+                        item_pos_1 < city_1_item_ids.size();
                         ++item_pos_1) {
-                    ItemId item_id_1 = city_1.item_ids[item_pos_1];
+                    ItemId item_id_1 = city_1_item_ids[item_pos_1];
                     const Item& item_1 = instance().item(item_id_1);
 
                     if (unprofitable_items.contains(item_id_1)
@@ -250,15 +250,15 @@ bool Reduction::reduce_polyakovskiy2017(
                     for (CityId city_id_2 = city_id_1;
                             city_id_2 < instance().number_of_cities();
                             ++city_id_2) {
-                        const City& city_2 = instance().city(city_id_2);
+                        ItemIdRange city_2_item_ids = instance().city_item_ids(city_id_2);
 
                         ItemId pos_max = (city_id_2 != city_id_1)?
-                            city_2.item_ids.size():
+                            city_2_item_ids.size():
                             item_pos_1;
                         for (ItemId item_pos_2 = 0;
                                 item_pos_2 < pos_max;
                                 ++item_pos_2) {
-                            ItemId item_id_2 = city_2.item_ids[item_pos_2];
+                            ItemId item_id_2 = city_2_item_ids[item_pos_2];
                             const Item& item_2 = instance().item(item_id_2);
 
                             // Only consider non unprofitable items.
@@ -291,8 +291,8 @@ bool Reduction::reduce_polyakovskiy2017(
 
                         // Distance between city j and city j + 1
                         double distance_to_next = (city_id_2 == instance().number_of_cities() - 1)?
-                            instance().city(0).distance:
-                            instance().city(city_id_2 + 1).distance;
+                            city_distances[0]:
+                            city_distances[city_id_2 + 1];
 
                         // Update least/most increamental costs
                         c_min += instance().renting_ratio() * (double)distance_to_next
@@ -326,11 +326,9 @@ bool Reduction::reduce_polyakovskiy2017(
         for (CityId city_id = 1;
                 city_id < instance().number_of_cities();
                 ++city_id) {
-            const City& city = instance().city(city_id);
-
-            w_comp[city_id] = w_comp[city_id - 1] + city.weight;
+            w_comp[city_id] = w_comp[city_id - 1] + city_weights[city_id];
 
-            for (ItemId item_id: city.item_ids) {
+            for (ItemId item_id: instance().city_item_ids(city_id)) {
                 if (!compulsory_items.contains(item_id))
                     continue;
                 w_comp[city_id] += instance().item(item_id).weight;
@@ -341,13 +339,13 @@ bool Reduction::reduce_polyakovskiy2017(
         for (CityId city_id_1 = instance().number_of_cities() - 1;
                 city_id_1 > 0;
                 --city_id_1) {
-            const City& city_1 = instance().city(city_id_1);
+            ItemIdRange city_1_item_ids = instance().city_item_ids(city_id_1);
 
             // Loop through the items of the city.
             for (ItemId item_pos_1 = 0;
-                    item_pos_1 < (ItemId)city_1.item_ids.size();
+                    item_pos_1 < city_1_item_ids.size();
                     ++item_pos_1) {
-                ItemId item_id_1 = city_1.item_ids[item_pos_1];
+                ItemId item_id_1 = city_1_item_ids[item_pos_1];
                 const Item& item_1 = instance().item(item_id_1);
 
                 if (unprofitable_items.contains(item_id_1)
@@ -362,15 +360,15 @@ bool Reduction::reduce_polyakovskiy2017(
                 for (CityId city_id_2 = city_id_1;
                         city_id_2 < instance().number_of_cities();
                         ++city_id_2) {
-                    const City& city_2 = instance().city(city_id_2);
+                    ItemIdRange city_2_item_ids = instance().city_item_ids(city_id_2);
 
                     ItemId pos_max = (city_id_2 != city_id_1)?
-                        city_2.item_ids.size():
+                        city_2_item_ids.size():
                         item_pos_1;
                     for (ItemId item_pos_2 = 0;
                            item_pos_2 < pos_max;
                            ++item_pos_2) {
-                        ItemId item_id_2 = city_2.item_ids[item_pos_2];
+                        ItemId item_id_2 = city_2_item_ids[item_pos_2];
                         const Item& item_2 = instance().item(item_id_2);
 
                         // Only consider non compulsory items
@@ -403,8 +401,8 @@ bool Reduction::reduce_polyakovskiy2017(
 
                     // Distance between city j and city j + 1
                     double distance_to_next = (city_id_2 == instance().number_of_cities() - 1)?
-                        instance().city(0).distance:
-                        instance().city(city_id_2 + 1).distance;
+                        city_distances[0]:
+                        city_distances[city_id_2 + 1];
 
                     c_min += instance().renting_ratio() * (double)distance_to_next
                         / (instance().maximum_speed() - ups * (w_comp[city_id_2] + item_1.weight))
@@ -456,9 +454,8 @@ bool Reduction::reduce_polyakovskiy2017(
     for (CityId city_id = 0;
             city_id < instance().number_of_cities();
             ++city_id) {
-        const City& city = instance().city(city_id);
-        new_instance_builder.set_distance(city_id, city.distance);
-        new_instance_builder.add_weight(city_id, city.weight);
+        new_instance_builder.set_distance(city_id, instance().city_distances()[city_id]);
+        new_instance_builder.add_weight(city_id, instance().city_weights()[city_id]);
     }
     new_instance_builder.set_minimum_speed(instance().minimum_speed());
     new_instance_builder.set_maximum_speed(instance().maximum_speed());
@@ -499,6 +496,8 @@ Reduction::Reduction(
     original_instance_(&instance),
     instance_(instance)
 {
+    PROFILING_SCOPE("Reduction");
+
     // Initialize reduced instance.
     unreduction_operations_ = std::vector<ItemId>(instance.number_of_items());
     for (ItemId item_id = 0;
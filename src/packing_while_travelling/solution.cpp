@@ -73,10 +73,16 @@ void Solution::write(
                 "Unable to open file \"" + certificate_path + "\".");
     }
 
+    write(file);
+}
+
+void Solution::write(
+        std::ostream& os) const
+{
     std::string separator = "[";
     for (ItemId item_id: item_ids_) {
-        file << separator << item_id + 1;
+        os << separator << item_id + 1;
         separator = ",";
     }
-    file << "]" << std::endl;
+    os << "]" << std::endl;
 }
@@ -38,7 +38,7 @@ Solution SolutionBuilder::build()
 {
     const Instance& instance = solution_.instance();
     solution_.item_weight_ += instance.city(0).weight;
-    for (ItemId item_id: instance.city(0).item_ids) {
+    for (ItemId item_id: instance.city_item_ids(0)) {
         if (solution_.items_is_selected_[item_id]) {
             const Item& item = instance.item(item_id);
             solution_.item_weight_ += item.weight;
@@ -49,7 +49,7 @@ Solution SolutionBuilder::build()
     for (CityId city_id = 1; city_id < instance.number_of_cities(); ++city_id) {
         solution_.travel_time_ += instance.duration(city_id, solution_.item_weight_);
         solution_.item_weight_ += instance.city(city_id).weight;
-        for (ItemId item_id: instance.city(city_id).item_ids) {
+        for (ItemId item_id: instance.city_item_ids(city_id)) {
             if (solution_.items_is_selected_[item_id]) {
                 const Item& item = instance.item(item_id);
                 solution_.item_weight_ += item.weight;
@@ -0,0 +1,129 @@
+#include "travellingthiefsolver/packing_while_travelling/throttled_file_writer.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+using namespace travellingthiefsolver::packing_while_travelling;
+
+namespace
+{
+
+/**
+ * Write a file through a temporary file and an atomic rename.
+ *
+ * Return an error message, empty on success.
+ */
+std::string write_file(const ThrottledFileWriter::File& file)
+{
+    std::string tmp_path = file.path + ".tmp";
+    {
+        std::ofstream tmp_file(tmp_path, std::ios::binary);
+        if (!tmp_file.good())
+            return "Unable to open file \"" + tmp_path + "\".";
+        tmp_file.write(file.content.data(), file.content.size());
+        if (!tmp_file.good())
+            return "Unable to write file \"" + tmp_path + "\".";
+    }
+#ifdef _WIN32
+    // 'std::rename' does not replace an existing file on Windows.
+    bool renamed = MoveFileExA(
+            tmp_path.c_str(),
+            file.path.c_str(),
+            MOVEFILE_REPLACE_EXISTING);
+#else
+    bool renamed = (std::rename(tmp_path.c_str(), file.path.c_str()) == 0);
+#endif
+    if (!renamed)
+        return "Unable to rename file \"" + tmp_path + "\".";
+    return "";
+}
+
+}
+
+ThrottledFileWriter::ThrottledFileWriter(double minimum_interval):
+    minimum_interval_(minimum_interval),
+    thread_(&ThrottledFileWriter::run, this) { }
+
+ThrottledFileWriter::~ThrottledFileWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    condition_.notify_all();
+    thread_.join();
+}
+
+void ThrottledFileWriter::submit(FilesBuilder build_files)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_files_builder_ = std::move(build_files);
+        has_pending_files_ = true;
+    }
+    condition_.notify_all();
+}
+
+void ThrottledFileWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    number_of_flushes_++;
+    condition_.notify_all();
+    condition_.wait(lock, [this]() { return !has_pending_files_ && !writing_; });
+    number_of_flushes_--;
+}
+
+void ThrottledFileWriter::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        condition_.wait(lock, [this]() { return has_pending_files_ || stop_; });
+        if (!has_pending_files_)
+            break;
+
+        // Wait for the end of the minimum interval since the last write. The
+        // contents submitted meanwhile replace the pending ones.
+        if (has_written_) {
+            auto next_write_time = last_write_time_
+                + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::duration<double>(minimum_interval_));
+            condition_.wait_until(
+                    lock,
+                    next_write_time,
+                    [this]() { return stop_ || number_of_flushes_ > 0; });
+        }
+
+        FilesBuilder build_files = std::move(pending_files_builder_);
+        pending_files_builder_ = nullptr;
+        has_pending_files_ = false;
+        writing_ = true;
+        has_written_ = true;
+        last_write_time_ = std::chrono::steady_clock::now();
+        lock.unlock();
+
+        // The files are built and written without the lock, so that the
+        // algorithm can submit new contents meanwhile.
+        std::vector<File> files;
+        try {
+            files = build_files();
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+        for (const File& file: files) {
+            std::string error = write_file(file);
+            // Intermediate outputs are best effort; the final outputs are
+            // written synchronously by the caller.
+            if (!error.empty())
+                std::cerr << error << std::endl;
+        }
+
+        lock.lock();
+        writing_ = false;
+        condition_.notify_all();
+    }
+}
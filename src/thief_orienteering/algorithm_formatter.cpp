@@ -88,7 +88,10 @@ void AlgorithmFormatter::update_solution(
         output_.time = parameters_.timer.elapsed_time();
         output_.solution = solution;
         print(s);
-        output_.json["IntermediaryOutputs"].push_back(output_.to_json());
+        intermediary_outputs_.add(
+                output_.json,
+                output_.metrics_to_json(),
+                output_.time);
         parameters_.new_solution_callback(output_, s);
     }
 }
@@ -104,7 +107,10 @@ void AlgorithmFormatter::update_bound(
         output_.time = parameters_.timer.elapsed_time();
         output_.bound = bound;
         print(s);
-        output_.json["IntermediaryOutputs"].push_back(output_.to_json());
+        intermediary_outputs_.add(
+                output_.json,
+                output_.metrics_to_json(),
+                output_.time);
         parameters_.new_solution_callback(output_, s);
     }
 }
@@ -113,6 +119,9 @@ void AlgorithmFormatter::end()
 {
     output_.time = parameters_.timer.elapsed_time();
     output_.json["Output"] = output_.to_json();
+    intermediary_outputs_.write(output_.json);
+    if (packing_while_travelling::profiling::enabled)
+        output_.json["Profile"] = packing_while_travelling::profiling::to_json(profiling_start_);
 
     if (parameters_.verbosity_level == 0)
         return;
@@ -12,3 +12,16 @@ const Output travellingthiefsolver::thief_orienteering::local_search(
             instance,
             parameters);
 }
+
+const MultiStartLocalSearchOutput travellingthiefsolver::thief_orienteering::multi_start_local_search(
+        const Instance& instance,
+        std::mt19937_64& generator,
+        const MultiStartLocalSearchParameters& parameters)
+{
+    return FUNCTION_WITH_DISTANCES(
+            multi_start_local_search,
+            instance.distances(),
+            instance,
+            generator,
+            parameters);
+}
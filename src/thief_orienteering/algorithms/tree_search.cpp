@@ -2,9 +2,9 @@
 
 using namespace travellingthiefsolver::thief_orienteering;
 
-const Output travellingthiefsolver::thief_orienteering::tree_search(
+const TreeSearchOutput travellingthiefsolver::thief_orienteering::tree_search(
         const Instance& instance,
-        const Parameters& parameters)
+        const TreeSearchParameters& parameters)
 {
     return FUNCTION_WITH_DISTANCES(
             tree_search,
@@ -12,3 +12,14 @@ const Output travellingthiefsolver::thief_orienteering::tree_search(
             instance,
             parameters);
 }
+
+const Output travellingthiefsolver::thief_orienteering::iterative_beam_search(
+        const Instance& instance,
+        const IterativeBeamSearchParameters& parameters)
+{
+    return FUNCTION_WITH_DISTANCES(
+            iterative_beam_search,
+            instance.distances(),
+            instance,
+            parameters);
+}
@@ -1,5 +1,8 @@
 #include "travellingthiefsolver/thief_orienteering/instance_builder.hpp"
 
+#include "travellingthiefsolver/packing_while_travelling/polyakovskiy2014.hpp"
+#include "travellingthiefsolver/packing_while_travelling/binary_instance.hpp"
+
 #include "travelingsalesmansolver/distances/distances_builder.hpp"
 
 #include "optimizationtools/utils/utils.hpp"
@@ -44,7 +47,12 @@ void InstanceBuilder::read(
     if (format == ""
             || format == "default"
             || format == "polyakovskiy2014") {
+        if (!read_polyakovskiy2014(instance_path))
+            read_polyakovskiy2014(file);
+    } else if (format == "polyakovskiy2014_stream") {
         read_polyakovskiy2014(file);
+    } else if (format == "binary") {
+        read_binary(instance_path);
     } else {
         throw std::invalid_argument(
                 "Unknown instance format \"" + format + "\".");
@@ -106,6 +114,119 @@ void InstanceBuilder::read_polyakovskiy2014(std::ifstream& file)
                 new travelingsalesmansolver::Distances(distances_builder.build())));
 }
 
+bool InstanceBuilder::read_polyakovskiy2014(const std::string& instance_path)
+{
+    packing_while_travelling::Polyakovskiy2014File file;
+    if (!packing_while_travelling::read_polyakovskiy2014(instance_path, file))
+        return false;
+    if (file.number_of_cities < 0) {
+        throw std::invalid_argument(
+                "Missing DIMENSION entry in file \"" + instance_path + "\".");
+    }
+
+    travelingsalesmansolver::DistancesBuilder distances_builder;
+    add_cities(file.number_of_cities);
+    distances_builder.set_number_of_vertices(file.number_of_cities);
+    // The TSPLIB reader only reads from the stream for sections, so header
+    // lines can be passed with an unopened stream.
+    std::ifstream no_file;
+    for (std::string tmp: file.tsplib_lines) {
+        std::vector<std::string> line = optimizationtools::split(tmp);
+        if (!distances_builder.read_tsplib(no_file, tmp, line)) {
+            throw std::invalid_argument(
+                    "ENTRY \""
+                    + line[0]
+                    + "\" not implemented.");
+        }
+    }
+    for (CityId city_id = 0;
+            city_id < (CityId)file.xs.size();
+            ++city_id) {
+        distances_builder.set_coordinates(
+                city_id,
+                file.xs[city_id],
+                file.ys[city_id]);
+    }
+    if (!file.xs.empty()) {
+        auto coordinates = std::make_shared<packing_while_travelling::CityCoordinates>();
+        coordinates->edge_weight_type = file.edge_weight_type;
+        coordinates->xs = std::move(file.xs);
+        coordinates->ys = std::move(file.ys);
+        set_coordinates(coordinates);
+    }
+
+    set_capacity(file.capacity);
+    set_time_limit(file.time_limit);
+    set_minimum_speed(file.minimum_speed);
+    set_maximum_speed(file.maximum_speed);
+
+    // Reserve the item lists of the cities before adding the items.
+    std::vector<ItemId> number_of_city_items(file.number_of_cities, 0);
+    for (CityId city_id: file.item_city_ids)
+        number_of_city_items[city_id]++;
+    for (CityId city_id = 0;
+            city_id < file.number_of_cities;
+            ++city_id) {
+        instance_.cities_[city_id].item_ids.reserve(number_of_city_items[city_id]);
+    }
+    instance_.items_.reserve(file.item_city_ids.size());
+    for (ItemId item_id = 0;
+            item_id < (ItemId)file.item_city_ids.size();
+            ++item_id) {
+        add_item(
+                file.item_city_ids[item_id],
+                file.item_weights[item_id],
+                file.item_profits[item_id]);
+    }
+
+    set_distances(std::shared_ptr<const travelingsalesmansolver::Distances>(
+                new travelingsalesmansolver::Distances(distances_builder.build())));
+    return true;
+}
+
+void InstanceBuilder::read_binary(const std::string& instance_path)
+{
+    packing_while_travelling::BinaryInstanceFile file(instance_path);
+    if (file.problem() != packing_while_travelling::BinaryInstanceProblem::ThiefOrienteering) {
+        throw std::invalid_argument(
+                "File \"" + instance_path + "\" is not a thief orienteering instance.");
+    }
+
+    travelingsalesmansolver::DistancesBuilder distances_builder;
+    add_cities(file.number_of_cities());
+    packing_while_travelling::set_distances(file, distances_builder);
+    set_coordinates(file.coordinates());
+
+    set_capacity(file.capacity());
+    set_time_limit(file.time_limit());
+    set_minimum_speed(file.minimum_speed());
+    set_maximum_speed(file.maximum_speed());
+
+    // The items of each city are given by the CSR index of the file.
+    const ItemId* city_item_offsets = file.city_item_offsets();
+    for (CityId city_id = 0;
+            city_id < file.number_of_cities();
+            ++city_id) {
+        instance_.cities_[city_id].item_ids.reserve(
+                city_item_offsets[city_id + 1] - city_item_offsets[city_id]);
+    }
+    instance_.items_.reserve(file.number_of_items());
+    const CityId* item_city_ids = file.item_city_ids();
+    const Weight* item_weights = file.item_weights();
+    const Profit* item_profits = file.item_profits();
+    for (ItemId item_id = 0;
+            item_id < file.number_of_items();
+            ++item_id) {
+        add_item(
+                item_city_ids[item_id],
+                item_weights[item_id],
+                item_profits[item_id]);
+    }
+
+    set_distances(std::shared_ptr<const travelingsalesmansolver::Distances>(
+                new travelingsalesmansolver::Distances(distances_builder.build())));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////// Build /////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
@@ -3,6 +3,8 @@
 #include "travellingthiefsolver/thief_orienteering/algorithms/tree_search.hpp"
 #include "travellingthiefsolver/thief_orienteering/algorithms/local_search.hpp"
 
+#include "travellingthiefsolver/packing_while_travelling/throttled_file_writer.hpp"
+
 #include <boost/program_options.hpp>
 
 using namespace travellingthiefsolver::thief_orienteering;
@@ -22,19 +24,24 @@ void read_args(
     if (vm.count("log"))
         parameters.log_path = vm["log"].as<std::string>();
     parameters.log_to_stderr = vm.count("log-to-stderr");
+    if (vm.count("intermediary-outputs-policy"))
+        parameters.intermediary_outputs_parameters.policy = vm["intermediary-outputs-policy"].as<travellingthiefsolver::packing_while_travelling::IntermediaryOutputsPolicy>();
+    if (vm.count("intermediary-outputs-maximum-number-of-entries"))
+        parameters.intermediary_outputs_parameters.maximum_number_of_entries = vm["intermediary-outputs-maximum-number-of-entries"].as<int64_t>();
+    if (vm.count("intermediary-outputs-log-base"))
+        parameters.intermediary_outputs_parameters.log_base = vm["intermediary-outputs-log-base"].as<double>();
+    if (vm.count("intermediary-outputs-path"))
+        parameters.intermediary_outputs_parameters.path = vm["intermediary-outputs-path"].as<std::string>();
+    parameters.intermediary_outputs_parameters.check();
     bool only_write_at_the_end = vm.count("only-write-at-the-end");
     if (!only_write_at_the_end) {
-        std::string certificate_path = vm["certificate"].as<std::string>();
-        std::string json_output_path = vm["output"].as<std::string>();
-        parameters.new_solution_callback = [
-            json_output_path,
-            certificate_path](
-                    const Output& output,
-                    const std::string&)
-        {
-            output.write_json_output(json_output_path);
-            output.solution.write(certificate_path);
-        };
+        // Intermediate outputs are written in a background thread at most
+        // once per output interval.
+        parameters.new_solution_callback
+            = travellingthiefsolver::packing_while_travelling::throttled_new_solution_callback<Output>(
+                    vm["output"].as<std::string>(),
+                    vm["certificate"].as<std::string>(),
+                    vm["output-interval"].as<double>());
     }
 }
 
@@ -60,10 +67,36 @@ Output run(
             parameters.number_of_threads = vm["number-of-threads"].as<int>();
         read_args(parameters, vm);
         return local_search(distances, instance, parameters);
-    } if (algorithm == "tree-search") {
-        Parameters parameters;
+    } else if (algorithm == "multi-start-local-search") {
+        MultiStartLocalSearchParameters parameters;
+        if (vm.count("number-of-threads"))
+            parameters.number_of_threads = vm["number-of-threads"].as<int>();
+        if (vm.count("elite-pool-size"))
+            parameters.elite_pool_size = vm["elite-pool-size"].as<Counter>();
+        if (vm.count("maximum-number-of-iterations"))
+            parameters.maximum_number_of_iterations = vm["maximum-number-of-iterations"].as<Counter>();
+        read_args(parameters, vm);
+        return multi_start_local_search(distances, instance, generator, parameters);
+    } else if (algorithm == "tree-search") {
+        TreeSearchParameters parameters;
+        if (vm.count("maximum-number-of-nodes"))
+            parameters.maximum_number_of_nodes = vm["maximum-number-of-nodes"].as<int>();
+        if (vm.count("maximum-number-of-bytes"))
+            parameters.maximum_number_of_bytes = vm["maximum-number-of-bytes"].as<Counter>();
+        if (vm.count("overflow-policy"))
+            parameters.overflow_policy = vm["overflow-policy"].as<travellingthiefsolver::packing_while_travelling::TreeSearchOverflowPolicy>();
         read_args(parameters, vm);
         return tree_search(distances, instance, parameters);
+    } else if (algorithm == "iterative-beam-search") {
+        IterativeBeamSearchParameters parameters;
+        if (vm.count("minimum-size-of-the-queue"))
+            parameters.minimum_size_of_the_queue = vm["minimum-size-of-the-queue"].as<Counter>();
+        if (vm.count("maximum-size-of-the-queue"))
+            parameters.maximum_size_of_the_queue = vm["maximum-size-of-the-queue"].as<Counter>();
+        if (vm.count("growth-factor"))
+            parameters.growth_factor = vm["growth-factor"].as<double>();
+        read_args(parameters, vm);
+        return iterative_beam_search(distances, instance, parameters);
 
     } else {
         throw std::invalid_argument(
@@ -79,7 +112,7 @@ int main(int argc, char *argv[])
         ("help,h", "produce help message")
         ("algorithm,a", po::value<std::string>()->default_value("large-neighborhood-search"), "set algorithm")
         ("input,i", po::value<std::string>()->required(), "set input file (required)")
-        ("format,f", po::value<std::string>()->default_value(""), "set input file format (default: standard)")
+        ("format,f", po::value<std::string>()->default_value(""), "set input file format (default: standard, binary)")
         ("unicost,u", "set unicost")
         ("output,o", po::value<std::string>()->default_value(""), "set JSON output file")
         ("initial-solution,", po::value<std::string>()->default_value(""), "")
@@ -88,11 +121,23 @@ int main(int argc, char *argv[])
         ("time-limit,t", po::value<double>(), "set time limit in seconds")
         ("verbosity-level,v", po::value<int>(), "set verbosity level")
         ("only-write-at-the-end,e", "only write output and certificate files at the end")
+        ("output-interval,", po::value<double>()->default_value(1.0), "set minimum interval in seconds between two writes of the intermediate output and certificate files")
         ("log,l", po::value<std::string>(), "set log file")
         ("log-to-stderr", "write log to stderr")
+        ("intermediary-outputs-policy,", po::value<travellingthiefsolver::packing_while_travelling::IntermediaryOutputsPolicy>(), "set policy of the history of intermediary outputs (all, last, log-spaced, stream, none)")
+        ("intermediary-outputs-maximum-number-of-entries,", po::value<int64_t>(), "set number of intermediary outputs kept with policy 'last'")
+        ("intermediary-outputs-log-base,", po::value<double>(), "set ratio between consecutive time intervals with policy 'log-spaced'")
+        ("intermediary-outputs-path,", po::value<std::string>(), "set JSON-lines file of the intermediary outputs with policy 'stream'")
 
         ("maximum-number-of-nodes,", po::value<int>(), "set maximum number of nodes")
+        ("maximum-number-of-bytes,", po::value<Counter>(), "set maximum number of bytes used by the tree search")
+        ("overflow-policy,", po::value<travellingthiefsolver::packing_while_travelling::TreeSearchOverflowPolicy>(), "set policy when the budget of the tree search is reached (stop, iterative-beam-search, purge-queue)")
         ("number-of-threads,", po::value<int>(), "set number of threads")
+        ("elite-pool-size,", po::value<Counter>(), "set size of the elite pool of the multi-start local search")
+        ("maximum-number-of-iterations,", po::value<Counter>(), "set maximum number of iterations")
+        ("minimum-size-of-the-queue,", po::value<Counter>(), "set minimum size of the queue")
+        ("maximum-size-of-the-queue,", po::value<Counter>(), "set maximum size of the queue")
+        ("growth-factor,", po::value<double>(), "set growth factor of the size of the queue")
         ;
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -95,18 +95,24 @@ void Solution::write(
                 "Unable to open file \"" + certificate_path + "\".");
     }
 
+    write(file);
+}
+
+void Solution::write(
+        std::ostream& os) const
+{
     std::string separator = "[";
     for (CityId city_id: city_ids_) {
-        file << separator << city_id + 1;
+        os << separator << city_id + 1;
         separator = ",";
     }
-    file << "]" << std::endl;
+    os << "]" << std::endl;
     separator = "[";
     for (ItemId item_id: item_ids_) {
-        file << separator << item_id + 1;
+        os << separator << item_id + 1;
         separator = ",";
     }
-    file << "]" << std::endl;
+    os << "]" << std::endl;
 }
 
 void Solution::write_csv(
@@ -1,10 +1,12 @@
 #include "travellingthiefsolver/travelling_thief/algorithms/tree_search.hpp"
 
+#include "travelingsalesmansolver/algorithms/lkh.hpp"
+
 using namespace travellingthiefsolver::travelling_thief;
 
-const Output travellingthiefsolver::travelling_thief::tree_search(
+const TreeSearchOutput travellingthiefsolver::travelling_thief::tree_search(
         const Instance& instance,
-        const Parameters& parameters)
+        const TreeSearchParameters& parameters)
 {
     return FUNCTION_WITH_DISTANCES(
             tree_search,
@@ -12,3 +14,41 @@ const Output travellingthiefsolver::travelling_thief::tree_search(
             instance,
             parameters);
 }
+
+const Output travellingthiefsolver::travelling_thief::iterative_beam_search(
+        const Instance& instance,
+        const IterativeBeamSearchParameters& parameters)
+{
+    return FUNCTION_WITH_DISTANCES(
+            iterative_beam_search,
+            instance.distances(),
+            instance,
+            parameters);
+}
+
+std::vector<std::vector<CityId>> travellingthiefsolver::travelling_thief::read_lkh_candidate_neighbors(
+        const Instance& instance,
+        const std::string& lkh_candidate_file_content,
+        CityId number_of_candidates)
+{
+    std::vector<travelingsalesmansolver::LkhCandidate> lkh_candidates
+        = travelingsalesmansolver::read_candidates(lkh_candidate_file_content);
+    if ((CityId)lkh_candidates.size() != instance.number_of_cities()) {
+        throw std::invalid_argument(
+                "travellingthiefsolver::travelling_thief::read_lkh_candidate_neighbors; "
+                "the number of cities of the LKH candidates is different from "
+                "the number of cities of the instance.");
+    }
+
+    std::vector<std::vector<CityId>> candidates(instance.number_of_cities());
+    for (CityId city_id = 0;
+            city_id < instance.number_of_cities();
+            ++city_id) {
+        for (const auto& candidate: lkh_candidates[city_id].edges) {
+            if ((CityId)candidates[city_id].size() >= number_of_candidates)
+                break;
+            candidates[city_id].push_back(candidate.vertex_id);
+        }
+    }
+    return candidates;
+}
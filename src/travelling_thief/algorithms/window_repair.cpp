@@ -0,0 +1,14 @@
+#include "travellingthiefsolver/travelling_thief/algorithms/window_repair.hpp"
+
+using namespace travellingthiefsolver::travelling_thief;
+
+const WindowRepairOutput travellingthiefsolver::travelling_thief::window_repair(
+        const Instance& instance,
+        const WindowRepairParameters& parameters)
+{
+    return FUNCTION_WITH_DISTANCES(
+            window_repair,
+            instance.distances(),
+            instance,
+            parameters);
+}
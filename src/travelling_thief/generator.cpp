@@ -0,0 +1,36 @@
+#include "travellingthiefsolver/travelling_thief/generator.hpp"
+
+#include "travellingthiefsolver/travelling_thief/instance_builder.hpp"
+
+#include "travelingsalesmansolver/distances/distances_builder.hpp"
+
+using namespace travellingthiefsolver::travelling_thief;
+
+Instance travellingthiefsolver::travelling_thief::generate_instance(
+        const packing_while_travelling::GeneratorParameters& parameters)
+{
+    packing_while_travelling::GeneratedData data
+        = packing_while_travelling::generate_data(parameters);
+
+    InstanceBuilder instance_builder;
+    instance_builder.add_cities(parameters.number_of_cities);
+    travelingsalesmansolver::DistancesBuilder distances_builder;
+    packing_while_travelling::set_distances(*data.coordinates, distances_builder);
+    instance_builder.set_distances(std::shared_ptr<const travelingsalesmansolver::Distances>(
+                new travelingsalesmansolver::Distances(distances_builder.build())));
+    instance_builder.set_coordinates(data.coordinates);
+
+    instance_builder.set_capacity(data.capacity);
+    instance_builder.set_minimum_speed(parameters.minimum_speed);
+    instance_builder.set_maximum_speed(parameters.maximum_speed);
+    instance_builder.set_renting_ratio(data.renting_ratio);
+    for (ItemId item_id = 0;
+            item_id < (ItemId)data.item_city_ids.size();
+            ++item_id) {
+        instance_builder.add_item(
+                data.item_city_ids[item_id],
+                data.item_weights[item_id],
+                data.item_profits[item_id]);
+    }
+    return instance_builder.build();
+}
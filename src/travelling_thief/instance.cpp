@@ -73,3 +73,33 @@ std::ostream& Instance::format(
 
     return os;
 }
+
+void Instance::write_binary(
+        const std::string& instance_path) const
+{
+    if (instance_path.empty())
+        return;
+    packing_while_travelling::BinaryInstanceData data;
+    data.problem = packing_while_travelling::BinaryInstanceProblem::TravellingThief;
+    data.number_of_cities = number_of_cities();
+    data.capacity = capacity();
+    data.minimum_speed = speed_min_;
+    data.maximum_speed = speed_max_;
+    data.renting_ratio = renting_ratio_;
+    // Without coordinates, the distances are stored as an explicit matrix.
+    data.coordinates = coordinates_;
+    if (coordinates_ == nullptr) {
+        data.distance_matrix = packing_while_travelling::compute_distance_matrix(
+                distances(),
+                number_of_cities());
+    }
+    data.item_city_ids.reserve(number_of_items());
+    data.item_weights.reserve(number_of_items());
+    data.item_profits.reserve(number_of_items());
+    for (const Item& item: items_) {
+        data.item_city_ids.push_back(item.city_id);
+        data.item_weights.push_back(item.weight);
+        data.item_profits.push_back(item.profit);
+    }
+    packing_while_travelling::write_binary_instance(instance_path, data);
+}
@@ -10,7 +10,8 @@ void run(
         const Distances& distances,
         const Instance& instance,
         const std::string& certificate_path,
-        const std::string& output_path)
+        const std::string& output_path,
+        const std::string& output_format)
 {
     Solution solution(
             distances,
@@ -19,11 +20,19 @@ void run(
 
     // Create PWT instance and write it.
     auto pwt_instance = create_pwt_instance(distances, instance, solution);
-    pwt_instance.write(output_path + ".pwt");
+    if (output_format == "binary") {
+        pwt_instance.write_binary(output_path + ".pwt");
+    } else {
+        pwt_instance.write(output_path + ".pwt");
+    }
 
     // Create TWP instance and write it.
     auto twp_instance = create_twp_instance(instance, solution);
-    twp_instance.write(output_path + ".twp");
+    if (output_format == "binary") {
+        twp_instance.write_binary(output_path + ".twp");
+    } else {
+        twp_instance.write(output_path + ".twp");
+    }
 }
 
 int main(int argc, char *argv[])
@@ -35,14 +44,16 @@ int main(int argc, char *argv[])
     std::string instance_path = "";
     std::string format = "default";
     std::string output_path = "";
+    std::string output_format = "default";
     std::string certificate_path = "";
 
     po::options_description desc("Allowed options");
     desc.add_options()
         ("help,h", "produce help message")
         ("input,i", po::value<std::string>(&instance_path)->required(), "set input file (required)")
-        ("format,f", po::value<std::string>(&format), "set input file format (default: standard)")
+        ("format,f", po::value<std::string>(&format), "set input file format (default: standard, binary)")
         ("output,o", po::value<std::string>(&output_path), "set JSON output file")
+        ("output-format", po::value<std::string>(&output_format), "set output file format (default: standard, binary)")
         ("certificate,c", po::value<std::string>(&certificate_path), "set certificate file")
         ;
     po::variables_map vm;
@@ -69,7 +80,8 @@ int main(int argc, char *argv[])
             instance.distances(),
             instance,
             certificate_path,
-            output_path);
+            output_path,
+            output_format);
 
     return 0;
 }
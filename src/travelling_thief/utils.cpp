@@ -16,6 +16,7 @@ travellingthiefsolver::travelling_while_packing::Instance travellingthiefsolver:
 {
     travelling_while_packing::InstanceBuilder twp_instance_builder;
     twp_instance_builder.set_distances(instance.distances_ptr());
+    twp_instance_builder.set_coordinates(instance.coordinates_ptr());
     twp_instance_builder.set_capacity(instance.capacity());
     twp_instance_builder.set_minimum_speed(instance.minimum_speed());
     twp_instance_builder.set_maximum_speed(instance.maximum_speed());
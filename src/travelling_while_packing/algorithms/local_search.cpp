@@ -4,7 +4,7 @@ using namespace travellingthiefsolver::travelling_while_packing;
 
 const Output travellingthiefsolver::travelling_while_packing::local_search(
         const Instance& instance,
-        const Parameters& parameters)
+        const LocalSearchParameters& parameters)
 {
     return FUNCTION_WITH_DISTANCES(
             local_search,
@@ -12,3 +12,16 @@ const Output travellingthiefsolver::travelling_while_packing::local_search(
             instance,
             parameters);
 }
+
+const MultiStartLocalSearchOutput travellingthiefsolver::travelling_while_packing::multi_start_local_search(
+        const Instance& instance,
+        std::mt19937_64& generator,
+        const MultiStartLocalSearchParameters& parameters)
+{
+    return FUNCTION_WITH_DISTANCES(
+            multi_start_local_search,
+            instance.distances(),
+            instance,
+            generator,
+            parameters);
+}
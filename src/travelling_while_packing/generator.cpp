@@ -0,0 +1,40 @@
+#include "travellingthiefsolver/travelling_while_packing/generator.hpp"
+
+#include "travellingthiefsolver/travelling_while_packing/instance_builder.hpp"
+
+#include "travelingsalesmansolver/distances/distances_builder.hpp"
+
+using namespace travellingthiefsolver::travelling_while_packing;
+
+Instance travellingthiefsolver::travelling_while_packing::generate_instance(
+        const packing_while_travelling::GeneratorParameters& parameters)
+{
+    packing_while_travelling::GeneratedData data
+        = packing_while_travelling::generate_data(parameters);
+
+    InstanceBuilder instance_builder;
+    instance_builder.add_cities(parameters.number_of_cities);
+    travelingsalesmansolver::DistancesBuilder distances_builder;
+    packing_while_travelling::set_distances(*data.coordinates, distances_builder);
+    instance_builder.set_distances(std::shared_ptr<const travelingsalesmansolver::Distances>(
+                new travelingsalesmansolver::Distances(distances_builder.build())));
+    instance_builder.set_coordinates(data.coordinates);
+
+    instance_builder.set_capacity(data.capacity);
+    instance_builder.set_minimum_speed(parameters.minimum_speed);
+    instance_builder.set_maximum_speed(parameters.maximum_speed);
+    instance_builder.set_renting_ratio(data.renting_ratio);
+    std::vector<Weight> weights(parameters.number_of_cities, 0);
+    for (packing_while_travelling::ItemId item_id = 0;
+            item_id < (packing_while_travelling::ItemId)data.item_city_ids.size();
+            ++item_id) {
+        if (data.knapsack_items[item_id])
+            weights[data.item_city_ids[item_id]] += data.item_weights[item_id];
+    }
+    for (CityId city_id = 0;
+            city_id < parameters.number_of_cities;
+            ++city_id) {
+        instance_builder.set_weight(city_id, weights[city_id]);
+    }
+    return instance_builder.build();
+}
@@ -67,3 +67,28 @@ void Instance::write(
     distances().write(file);
     file << "EOF" << std::endl;
 }
+
+void Instance::write_binary(
+        const std::string& instance_path) const
+{
+    if (instance_path.empty())
+        return;
+    packing_while_travelling::BinaryInstanceData data;
+    data.problem = packing_while_travelling::BinaryInstanceProblem::TravellingWhilePacking;
+    data.number_of_cities = number_of_cities();
+    data.capacity = capacity();
+    data.minimum_speed = speed_min_;
+    data.maximum_speed = speed_max_;
+    data.renting_ratio = renting_ratio_;
+    // Without coordinates, the distances are stored as an explicit matrix.
+    data.coordinates = coordinates_;
+    if (coordinates_ == nullptr) {
+        data.distance_matrix = packing_while_travelling::compute_distance_matrix(
+                distances(),
+                number_of_cities());
+    }
+    data.city_weights.reserve(number_of_cities());
+    for (const City& city: cities_)
+        data.city_weights.push_back(city.weight);
+    packing_while_travelling::write_binary_instance(instance_path, data);
+}